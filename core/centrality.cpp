@@ -8,98 +8,157 @@
 #include "centrality.h"
 using namespace CDLib;
 
-void do_bfs(const graph& g, id_type i, vector< vector<id_type> >& preds, vector<id_type>& paths, vector<double>& dist, stack<id_type>& s_dist) {
-    preds.clear();
-    dist.clear();
-    paths.clear();
-    while (!s_dist.empty())
-        s_dist.pop();
-    preds.assign(g.get_num_nodes(), vector<id_type > ());
-    dist.assign(g.get_num_nodes(), numeric_limits<double>::infinity());
-    paths.assign(g.get_num_nodes(), 0);
-    dist[i] = 0;
-    paths[i] = 1;
-
-    queue<id_type> q_bfs;
-    q_bfs.push(i);
-    while (!q_bfs.empty()) {
-        id_type curr = q_bfs.front();
-        q_bfs.pop();
-        s_dist.push(curr);
-        for (adjacent_edges_iterator aeit = g.out_edges_begin(curr); aeit != g.out_edges_end(curr); aeit++) {
-            if (dist[aeit->first] == numeric_limits<double>::infinity()) {
-                q_bfs.push(aeit->first);
-                dist[aeit->first] = dist[curr] + 1;
-            }
-            if (dist[aeit->first] == dist[curr] + 1) {
-                paths[aeit->first] += paths[curr];
-                preds[aeit->first].push_back(curr);
-            }
-        }
+//  Triangle listing intersects sorted neighbor lists by merging, and by galloping through
+//  the longer list once it is triangle_gallop_ratio times longer than the shorter.
+const id_type triangle_gallop_ratio = 32;
+
+template <typename G>
+struct brandes_workspace {
+    //  Per-thread buffers of the Brandes kernel, sized once and reused across sources.
+    //  Only the entries of the nodes reached from the last source are reset, and the
+    //  predecessors are not stored: they are recovered from the distances in the
+    //  backward sweep. bc accumulates the dependencies of every source of the thread.
+    vector<double> dist;
+    vector<double> sigma;
+    vector<double> delta;
+    vector<double> bc;
+    vector<id_type> order;
+    bfs_engine<G> engine;
+    dijkstra_engine<G> weighted_engine;
+
+    brandes_workspace(const G& g) : dist(g.get_num_nodes(), numeric_limits<double>::infinity()), sigma(g.get_num_nodes(), 0), delta(g.get_num_nodes(), 0), bc(g.get_num_nodes(), 0), engine(g), weighted_engine(g) {
+        order.reserve(g.get_num_nodes());
+    }
+};
+
+template <typename G>
+void brandes_forward_bfs(const G& g, id_type source, brandes_workspace<G>& ws) {
+    //  The engine gives the levels; path counts follow in level order.
+    ws.engine.run(source);
+    const vector<id_type>& reached = ws.engine.get_order();
+    ws.sigma[source] = 1;
+    for (id_type i = 0; i < reached.size(); i++) {
+        ws.dist[reached[i]] = ws.engine.get_level(reached[i]);
+        ws.order.push_back(reached[i]);
+    }
+    for (id_type i = 0; i < reached.size(); i++) {
+        id_type curr = reached[i];
+        double next_level = ws.dist[curr] + 1;
+        for (auto aeit = g.out_edges_begin(curr); aeit != g.out_edges_end(curr); aeit++)
+            if (ws.dist[aeit->first] == next_level) ws.sigma[aeit->first] += ws.sigma[curr];
     }
 }
 
-void do_djikstra(const graph& g, id_type i, vector< vector<id_type> >& preds, vector<id_type>& paths, vector<double>& dist, stack<id_type>& s_dist) {
-    preds.clear();
-    dist.clear();
-    paths.clear();
-    while (!s_dist.empty())
-        s_dist.pop();
-    preds.assign(g.get_num_nodes(), vector<id_type > ());
-    dist.assign(g.get_num_nodes(), numeric_limits<double>::infinity());
-    paths.assign(g.get_num_nodes(), 0);
-    dist[i] = 0;
-    paths[i] = 1;
-
-    binary_heap p_queue(dist, false);
-    while (!p_queue.empty()) {
-        id_type curr = p_queue.top().first;
-        p_queue.pop();
-        if (dist[curr] == numeric_limits<double>::infinity()) break;
-        for (adjacent_edges_iterator aeit = g.out_edges_begin(curr); aeit != g.out_edges_end(curr); aeit++) {
-            double alt = dist[curr] + aeit->second;
-            if (dist[aeit->first] == numeric_limits<double>::infinity()) {
-                dist[aeit->first] = alt;
-                p_queue.update_key(make_pair(aeit->first, alt));
-            }
-            if (dist[aeit->first] == alt) {
-                preds[aeit->first].push_back(curr);
-                paths[aeit->first] += paths[curr];
-            }
+template <typename G>
+void brandes_forward_dijkstra(const G& g, id_type source, brandes_workspace<G>& ws) {
+    //  The engine settles the nodes by distance and counts the paths on the way.
+    ws.weighted_engine.run(source, ws.sigma);
+    const vector<id_type>& reached = ws.weighted_engine.get_order();
+    for (id_type i = 0; i < reached.size(); i++) {
+        ws.dist[reached[i]] = ws.weighted_engine.get_distance(reached[i]);
+        ws.order.push_back(reached[i]);
+    }
+}
+
+template <typename G>
+void brandes_accumulate(const G& g, id_type source, brandes_workspace<G>& ws) {
+    //  Single source stage of Brandes' algorithm. The successors of a node on shortest
+    //  paths are the neighbors whose distance is its own plus the edge length, so the
+    //  backward sweep walks out-edges instead of stored predecessor lists.
+    if (!g.is_weighted()) brandes_forward_bfs(g, source, ws);
+    else brandes_forward_dijkstra(g, source, ws);
+    for (id_type i = ws.order.size(); i > 0; i--) {
+        id_type curr = ws.order[i - 1];
+        double coeff = 0;
+        for (auto aeit = g.out_edges_begin(curr); aeit != g.out_edges_end(curr); aeit++) {
+            id_type next = aeit->first;
+            double length = (g.is_weighted()) ? aeit->second : 1;
+            if (ws.dist[next] == ws.dist[curr] + length) coeff += (1 + ws.delta[next]) / ws.sigma[next];
         }
+        ws.delta[curr] = ws.sigma[curr] * coeff;
+        if (curr != source) ws.bc[curr] += ws.delta[curr];
     }
+    for (id_type i = 0; i < ws.order.size(); i++) {
+        id_type curr = ws.order[i];
+        ws.dist[curr] = numeric_limits<double>::infinity();
+        ws.sigma[curr] = 0;
+        ws.delta[curr] = 0;
+    }
+    ws.order.clear();
 }
 
-void CDLib::betweeness_centralities(const graph& g, vector<double>& bc) {
+template <typename G>
+void brandes_from_sources(const G& g, const vector<id_type>& sources, vector<double>& bc) {
     bc.clear();
     bc.assign(g.get_num_nodes(), 0);
-    //    Parallel calculation of betweenness centrality.
-    //    Parallelism is automatically controlled to number of available CPU's
-    //    Mutual Exclusion of variable bc is not required as only one addition is performed on that variable.
+    //    Parallel calculation of betweenness centrality over the sources. Every thread
+    //    accumulates into the bc of its own workspace and the workspaces are summed at
+    //    the end. Dynamic scheduling balances sources with very different reach.
 #ifdef ENABLE_MULTITHREADING
-#pragma omp parallel for shared(g,bc)
+#pragma omp parallel shared(g,sources,bc)
 #endif
-    for (id_type i = 0; i < g.get_num_nodes(); i++) {
-        vector< vector<id_type> > preds;
-        vector<double> dist;
-        vector<id_type> paths;
-        stack<id_type> s_dist;
-        if (!g.is_weighted()) do_bfs(g, i, preds, paths, dist, s_dist);
-        else do_djikstra(g, i, preds, paths, dist, s_dist);
-        vector<double> deps(g.get_num_nodes(), 0);
-        while (!s_dist.empty()) {
-            id_type curr = s_dist.top();
-            s_dist.pop();
-            for (id_type j = 0; j < preds[curr].size(); j++)
-                deps[preds[curr][j]] += (((double) paths[preds[curr][j]] / (double) paths[curr])*(1 + deps[curr]));
-            if (curr != i) bc[curr] += deps[curr];
-        }
+    {
+        brandes_workspace<G> ws(g);
+#ifdef ENABLE_MULTITHREADING
+#pragma omp for schedule(dynamic,16)
+#endif
+        for (id_type i = 0; i < sources.size(); i++) brandes_accumulate(g, sources[i], ws);
+#ifdef ENABLE_MULTITHREADING
+#pragma omp critical(betweenness_reduction)
+#endif
+        for (id_type i = 0; i < bc.size(); i++) bc[i] += ws.bc[i];
     }
     if (!g.is_directed())
         for (id_type i = 0; i < bc.size(); i++) bc[i] /= 2;
 }
 
-void CDLib::betweenness_centralities_normalized(const graph& g, vector<double>& bcn) {
+template <typename G>
+void CDLib::betweeness_centralities(const G& g, vector<double>& bc) {
+    vector<id_type> sources(g.get_num_nodes());
+    for (id_type i = 0; i < sources.size(); i++) sources[i] = i;
+    brandes_from_sources(g, sources, bc);
+}
+
+template <typename G>
+void CDLib::betweenness_centralities_sampled(const G& g, vector<double>& bc, id_type num_samples, unsigned long seed) {
+    //    Pivot sampling of Brandes and Pich: the dependencies of num_samples distinct
+    //    sources drawn uniformly are scaled by n/num_samples, an unbiased estimate of the
+    //    exact values. The draw is a partial Fisher-Yates shuffle driven by the seed.
+    if (!num_samples || num_samples >= g.get_num_nodes()) {
+        betweeness_centralities(g, bc);
+        return;
+    }
+    vector<id_type> nodes(g.get_num_nodes());
+    for (id_type i = 0; i < nodes.size(); i++) nodes[i] = i;
+    mt19937 gen(seed);
+    for (id_type i = 0; i < num_samples; i++) {
+        uniform_int_distribution<id_type> pick(i, nodes.size() - 1);
+        swap(nodes[i], nodes[pick(gen)]);
+    }
+    nodes.resize(num_samples);
+    brandes_from_sources(g, nodes, bc);
+    double scale = (double) g.get_num_nodes() / num_samples;
+    for (id_type i = 0; i < bc.size(); i++) bc[i] *= scale;
+}
+
+id_type CDLib::betweenness_sample_size(id_type num_nodes, double epsilon, double delta) {
+    //    A source contributes at most n-2 to the dependency of a node, so Hoeffding's
+    //    bound with a union bound over the n nodes gives ln(2n/delta)/(2 epsilon^2).
+    if (num_nodes <= 2 || epsilon <= 0 || delta <= 0 || delta >= 1)
+        return num_nodes;
+    double samples = ceil(log(2 * (double) num_nodes / delta) / (2 * epsilon * epsilon));
+    return (samples >= num_nodes) ? num_nodes : (id_type) samples;
+}
+
+template <typename G>
+id_type CDLib::betweenness_centralities_approximate(const G& g, vector<double>& bc, double epsilon, double delta, unsigned long seed) {
+    id_type num_samples = betweenness_sample_size(g.get_num_nodes(), epsilon, delta);
+    betweenness_centralities_sampled(g, bc, num_samples, seed);
+    return num_samples;
+}
+
+template <typename G>
+void CDLib::betweenness_centralities_normalized(const G& g, vector<double>& bcn) {
     betweeness_centralities(g, bcn);
     if (g.get_num_nodes() <= 1)
         return;
@@ -108,31 +167,9 @@ void CDLib::betweenness_centralities_normalized(const graph& g, vector<double>&
         bcn[i] /= sum_norm;
 }
 
-double CDLib::edge_clustering_coefficient(const graph&g, id_type from_id, id_type to_id) {
-    if (!g.get_edge_weight(from_id, to_id)) return 0;
-    double denom = min(g.get_node_in_weight(from_id) - 1, g.get_node_out_weight(to_id) - 1);
-    if (denom == 0) return numeric_limits<double>::infinity();
-    if (!g.is_directed()) denom /= 2;
-    set<id_type> from_neighs, to_neighs;
-    for (adjacent_edges_iterator aeit = g.out_edges_begin(to_id); aeit != g.out_edges_end(to_id); aeit++) from_neighs.insert(aeit->first);
-    for (adjacent_edges_iterator aeit = g.in_edges_begin(from_id); aeit != g.in_edges_end(from_id); aeit++) to_neighs.insert(aeit->first);
-    vector<id_type> common_neighbors(g.get_node_out_degree(to_id) + g.get_node_in_degree(from_id), 0);
-    vector<id_type>::iterator common_it = set_intersection(from_neighs.begin(), from_neighs.end(), to_neighs.begin(), to_neighs.end(), common_neighbors.begin());
-    double numer = (double) ((common_it - common_neighbors.begin()) + 1);
-    if (g.is_weighted()) {
-        double in_sum = 0, out_sum = 0;
-        for (vector<id_type>::iterator it = common_neighbors.begin(); it != common_it; it++) {
-            out_sum += g.get_edge_weight(to_id, *it);
-            in_sum += g.get_edge_weight(*it, from_id);
-        }
-        numer = in_sum*out_sum;
-        return numer / denom;
-    }
-    return (double) numer / denom;
-}
-
 /* List the degree of all the nodes in the network in a vector */
-void CDLib::degree_vector(const graph& g, vector<id_type>& sequence) {
+template <typename G>
+void CDLib::degree_vector(const G& g, vector<id_type>& sequence) {
     sequence.clear();
     sequence.assign(g.get_num_nodes(), 0);
     for (id_type i = 0; i < g.get_num_nodes(); i++)
@@ -140,7 +177,8 @@ void CDLib::degree_vector(const graph& g, vector<id_type>& sequence) {
 }
 
 /*This gives the #nodes of degree indicated as the index of sequence variable in an undirected graph*/
-void CDLib::degree_sequence(const graph& g, vector<id_type>& sequence) {
+template <typename G>
+void CDLib::degree_sequence(const G& g, vector<id_type>& sequence) {
     sequence.clear();
     if (g.is_directed()) {
         id_type max_degree = 0;
@@ -153,50 +191,362 @@ void CDLib::degree_sequence(const graph& g, vector<id_type>& sequence) {
     }
 }
 
-void CDLib::degree_centralities_normalized(const graph& g, vector<double>& degrees) {
+template <typename G>
+void CDLib::degree_centralities_normalized(const G& g, vector<double>& degrees) {
     //    Return the normalized out-degree centrality of all the nodes in the given graph.
     degrees.clear();
     for (id_type i = 0; i < g.get_num_nodes(); i++)
         degrees.push_back((double) g.get_node_out_degree(i) / g.get_num_edges());
 }
 
-//Overloaded function for a single node
+struct sorted_adjacency {
+    //  Neighbors of every node sorted by id in one array, with the edge weights alongside.
+    //  A trailing sentinel keeps begin() valid for empty rows.
+    vector<id_type> offsets;
+    vector<id_type> targets;
+    vector<double> weights;
 
-double CDLib::node_clustering_coefficient(const graph&g, id_type node) {
-    if (g.get_node_out_degree(node) == 0)
-        return 0;
-    if (g.get_node_out_degree(node) == 1)
-        return 1;
+    const id_type* begin(id_type id) const {
+        return &targets[0] + offsets[id];
+    }
 
-    double edge_count = 0;
-    node_set neighbours;
-    neighbours.insert(node);
-    for (adjacent_edges_iterator aeit = g.out_edges_begin(node); aeit != g.out_edges_end(node); aeit++)
-        neighbours.insert(aeit->first);
-    for (node_set::iterator nit = neighbours.begin(); nit != neighbours.end(); nit++) {
-        for (adjacent_edges_iterator aeit = g.out_edges_begin(*nit); aeit != g.out_edges_end(*nit); aeit++) {
-            if (neighbours.find(aeit->first) != neighbours.end())
-                edge_count++;
+    id_type size(id_type id) const {
+        return offsets[id + 1] - offsets[id];
+    }
+};
+
+template <typename G>
+void sort_adjacency(const G& g, bool in_edges, sorted_adjacency& adj) {
+    id_type num_nodes = g.get_num_nodes();
+    adj.offsets.assign(num_nodes + 1, 0);
+    for (id_type i = 0; i < num_nodes; i++)
+        adj.offsets[i + 1] = adj.offsets[i] + ((in_edges) ? g.get_node_in_degree(i) : g.get_node_out_degree(i));
+    adj.targets.assign(adj.offsets[num_nodes] + 1, 0);
+    adj.weights.assign(adj.offsets[num_nodes] + 1, 0);
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel shared(g,adj)
+#endif
+    {
+        vector< pair<id_type, double> > row;
+#ifdef ENABLE_MULTITHREADING
+#pragma omp for schedule(dynamic,256)
+#endif
+        for (id_type i = 0; i < num_nodes; i++) {
+            row.clear();
+            if (in_edges)
+                for (auto aeit = g.in_edges_begin(i); aeit != g.in_edges_end(i); aeit++) row.push_back(make_pair(aeit->first, aeit->second));
+            else
+                for (auto aeit = g.out_edges_begin(i); aeit != g.out_edges_end(i); aeit++) row.push_back(make_pair(aeit->first, aeit->second));
+            sort(row.begin(), row.end());
+            for (id_type j = 0; j < row.size(); j++) {
+                adj.targets[adj.offsets[i] + j] = row[j].first;
+                adj.weights[adj.offsets[i] + j] = row[j].second;
+            }
         }
     }
-    //    This below line automatically takes care of directed and undirected graphs.
-    edge_count /= ((g.get_node_out_degree(node) + 1) * g.get_node_out_degree(node));
-    return edge_count;
 }
 
-//Overloaded function for all nodes.
+void oriented_adjacency(const sorted_adjacency& out, const sorted_adjacency& in, bool directed, sorted_adjacency& forward, vector<id_type>& degrees) {
+    //  Undirected view without self loops, each edge kept only at its endpoint of lower
+    //  (degree, id) rank. Every triangle is then found once, from its lowest ranked node,
+    //  and no list is longer than the square root of twice the number of edges.
+    id_type num_nodes = out.offsets.size() - 1;
+    vector<id_type> neighbors;
+    degrees.assign(num_nodes, 0);
+    for (id_type i = 0; i < num_nodes; i++) {
+        neighbors.clear();
+        if (directed)
+            set_union(out.begin(i), out.begin(i) + out.size(i), in.begin(i), in.begin(i) + in.size(i), back_inserter(neighbors));
+        else neighbors.assign(out.begin(i), out.begin(i) + out.size(i));
+        degrees[i] = neighbors.size() - count(neighbors.begin(), neighbors.end(), i);
+    }
+    forward.offsets.assign(num_nodes + 1, 0);
+    forward.targets.clear();
+    for (id_type i = 0; i < num_nodes; i++) {
+        neighbors.clear();
+        if (directed)
+            set_union(out.begin(i), out.begin(i) + out.size(i), in.begin(i), in.begin(i) + in.size(i), back_inserter(neighbors));
+        else neighbors.assign(out.begin(i), out.begin(i) + out.size(i));
+        for (id_type j = 0; j < neighbors.size(); j++) {
+            id_type next = neighbors[j];
+            if (degrees[next] > degrees[i] || (degrees[next] == degrees[i] && next > i)) forward.targets.push_back(next);
+        }
+        forward.offsets[i + 1] = forward.targets.size();
+    }
+    forward.targets.push_back(0);
+}
 
-void CDLib::node_clustering_coefficient(const graph&g, vector<double>& nodes) {
-    nodes.clear();
-    nodes.assign(g.get_num_nodes(), 0);
+template <typename F>
+id_type sorted_intersection(const id_type* left, id_type left_size, const id_type* right, id_type right_size, F& on_match) {
+    //  Merges the two sorted lists, or gallops through the longer one with exponential
+    //  and binary search when it is much longer. on_match receives the positions of
+    //  every common element in both lists; returns the number of them.
+    id_type matches = 0;
+    if (left_size * triangle_gallop_ratio < right_size || right_size * triangle_gallop_ratio < left_size) {
+        bool swapped = left_size > right_size;
+        const id_type* small = (swapped) ? right : left, *large = (swapped) ? left : right;
+        id_type small_size = (swapped) ? right_size : left_size, large_size = (swapped) ? left_size : right_size;
+        id_type low = 0;
+        for (id_type i = 0; i < small_size && low < large_size; i++) {
+            id_type step = 1, high = low;
+            while (high < large_size && large[high] < small[i]) {
+                low = high + 1;
+                high += step;
+                step *= 2;
+            }
+            if (high > large_size) high = large_size;
+            low = lower_bound(large + low, large + high, small[i]) - large;
+            if (low < large_size && large[low] == small[i]) {
+                if (swapped) on_match(low, i);
+                else on_match(i, low);
+                matches++;
+                low++;
+            }
+        }
+        return matches;
+    }
+    id_type i = 0, j = 0;
+    while (i < left_size && j < right_size) {
+        if (left[i] < right[j]) i++;
+        else if (right[j] < left[i]) j++;
+        else {
+            on_match(i, j);
+            matches++;
+            i++;
+            j++;
+        }
+    }
+    return matches;
+}
+
+struct ignore_matches {
+
+    void operator()(id_type, id_type) {
+    }
+};
+
+struct triangle_corners {
+    //  Credits the third corner of every triangle found from an oriented edge.
+    vector<id_type>& triangles;
+    const id_type* corners;
+
+    triangle_corners(vector<id_type>& counts, const id_type* list) : triangles(counts), corners(list) {
+    }
+
+    void operator()(id_type position, id_type) {
 #ifdef ENABLE_MULTITHREADING
-#pragma omp parallel for shared(g,nodes)
+#pragma omp atomic
 #endif
-    for (id_type i = 0; i < g.get_num_nodes(); i++)
-        nodes[i] = node_clustering_coefficient(g, i);
+        triangles[corners[position]]++;
+    }
+};
+
+struct common_weights {
+    //  Sums the weights of the arcs to and from the common neighbors of an edge.
+    const double* out_weights;
+    const double* in_weights;
+    double out_sum;
+    double in_sum;
+
+    common_weights(const double* out_list, const double* in_list) : out_weights(out_list), in_weights(in_list), out_sum(0), in_sum(0) {
+    }
+
+    void operator()(id_type out_position, id_type in_position) {
+        out_sum += out_weights[out_position];
+        in_sum += in_weights[in_position];
+    }
+};
+
+id_type count_triangles(const sorted_adjacency& forward, vector<id_type>& triangles) {
+    //  Triangles through every node of the undirected view; returns their total.
+    id_type num_nodes = forward.offsets.size() - 1, total = 0;
+    triangles.assign(num_nodes, 0);
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel for schedule(dynamic,64) shared(forward,triangles) reduction(+:total)
+#endif
+    for (id_type i = 0; i < num_nodes; i++) {
+        id_type found = 0;
+        for (id_type j = 0; j < forward.size(i); j++) {
+            id_type next = forward.begin(i)[j];
+            triangle_corners corners(triangles, forward.begin(i));
+            id_type common = sorted_intersection(forward.begin(i), forward.size(i), forward.begin(next), forward.size(next), corners);
+#ifdef ENABLE_MULTITHREADING
+#pragma omp atomic
+#endif
+            triangles[next] += common;
+            found += common;
+        }
+#ifdef ENABLE_MULTITHREADING
+#pragma omp atomic
+#endif
+        triangles[i] += found;
+        total += found;
+    }
+    return total;
+}
+
+double closed_neighborhood_coefficient(id_type degree, double arcs) {
+    //  The local clustering of this library: arcs among a node and its out-neighbors over
+    //  (degree + 1) * degree, with 0 for isolated nodes and 1 for a single neighbor.
+    if (degree == 0) return 0;
+    if (degree == 1) return 1;
+    return arcs / ((degree + 1) * degree);
+}
+
+template <typename G>
+double CDLib::clustering_coefficients(const G& g, vector<double>& nodes, double& average) {
+    //    An undirected graph counts its arcs through the triangles: a node with d neighbors
+    //    other than itself, t triangles and l self loops in its closed neighborhood has
+    //    2d + 2t + l of them. A directed graph intersects the sorted out-list of every member
+    //    of the closed neighborhood with the neighborhood itself.
+    id_type num_nodes = g.get_num_nodes();
+    sorted_adjacency out, in, forward;
+    vector<id_type> triangles, degrees;
+    sort_adjacency(g, false, out);
+    if (g.is_directed()) sort_adjacency(g, true, in);
+    oriented_adjacency(out, in, g.is_directed(), forward, degrees);
+    id_type total = count_triangles(forward, triangles);
+    nodes.assign(num_nodes, 0);
+    if (!g.is_directed()) {
+        vector<char> has_loop(num_nodes, 0);
+        for (id_type i = 0; i < num_nodes; i++) has_loop[i] = binary_search(out.begin(i), out.begin(i) + out.size(i), i);
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel for schedule(dynamic,256) shared(g,nodes)
+#endif
+        for (id_type i = 0; i < num_nodes; i++) {
+            double loops = has_loop[i];
+            for (id_type j = 0; j < out.size(i); j++)
+                if (out.begin(i)[j] != i) loops += has_loop[out.begin(i)[j]];
+            nodes[i] = closed_neighborhood_coefficient(g.get_node_out_degree(i), 2.0 * degrees[i] + 2.0 * triangles[i] + loops);
+        }
+    } else {
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel shared(g,nodes)
+#endif
+        {
+            vector<id_type> closed;
+            ignore_matches ignore;
+#ifdef ENABLE_MULTITHREADING
+#pragma omp for schedule(dynamic,256)
+#endif
+            for (id_type i = 0; i < num_nodes; i++) {
+                closed.assign(out.begin(i), out.begin(i) + out.size(i));
+                closed.insert(lower_bound(closed.begin(), closed.end(), i), i);
+                closed.erase(unique(closed.begin(), closed.end()), closed.end());
+                double arcs = 0;
+                for (id_type j = 0; j < closed.size(); j++)
+                    arcs += sorted_intersection(out.begin(closed[j]), out.size(closed[j]), &closed[0], closed.size(), ignore);
+                nodes[i] = closed_neighborhood_coefficient(g.get_node_out_degree(i), arcs);
+            }
+        }
+    }
+    average = (num_nodes) ? accumulate(nodes.begin(), nodes.end(), 0.0) / num_nodes : 0;
+    double triples = 0;
+    for (id_type i = 0; i < num_nodes; i++) triples += (double) degrees[i] * (degrees[i] - 1) / 2;
+    return (triples > 0) ? 3 * total / triples : 0;
+}
+
+template <typename G>
+id_type CDLib::triangle_counts(const G& g, vector<id_type>& triangles) {
+    sorted_adjacency out, in, forward;
+    vector<id_type> degrees;
+    sort_adjacency(g, false, out);
+    if (g.is_directed()) sort_adjacency(g, true, in);
+    oriented_adjacency(out, in, g.is_directed(), forward, degrees);
+    return count_triangles(forward, triangles);
+}
+
+template <typename G>
+double CDLib::transitivity(const G& g) {
+    vector<double> nodes;
+    double average;
+    return clustering_coefficients(g, nodes, average);
+}
+
+template <typename G>
+double edge_clustering_from_lists(const G& g, id_type from_id, id_type to_id, const id_type* out_list, const double* out_weights, id_type out_size, const id_type* in_list, const double* in_weights, id_type in_size) {
+    //  Radicchi's edge clustering: the common neighbors of the edge, out-neighbors of to_id
+    //  that are also in-neighbors of from_id, plus one over the smaller degree less one.
+    double denom = min(g.get_node_in_weight(from_id) - 1, g.get_node_out_weight(to_id) - 1);
+    if (denom == 0) return numeric_limits<double>::infinity();
+    if (!g.is_directed()) denom /= 2;
+    common_weights sums(out_weights, in_weights);
+    double numer = (double) (sorted_intersection(out_list, out_size, in_list, in_size, sums) + 1);
+    if (g.is_weighted()) numer = sums.in_sum * sums.out_sum;
+    return numer / denom;
 }
 
-void CDLib::node_clustering_coefficient_normalized(const graph& g, vector<double>& nodes) {
+template <typename G>
+double CDLib::edge_clustering_coefficient(const G& g, id_type from_id, id_type to_id) {
+    if (!g.get_edge_weight(from_id, to_id)) return 0;
+    vector< pair<id_type, double> > out_row, in_row;
+    for (auto aeit = g.out_edges_begin(to_id); aeit != g.out_edges_end(to_id); aeit++) out_row.push_back(make_pair(aeit->first, aeit->second));
+    for (auto aeit = g.in_edges_begin(from_id); aeit != g.in_edges_end(from_id); aeit++) in_row.push_back(make_pair(aeit->first, aeit->second));
+    sort(out_row.begin(), out_row.end());
+    sort(in_row.begin(), in_row.end());
+    vector<id_type> out_list(out_row.size() + 1), in_list(in_row.size() + 1);
+    vector<double> out_weights(out_row.size() + 1), in_weights(in_row.size() + 1);
+    for (id_type i = 0; i < out_row.size(); i++) {
+        out_list[i] = out_row[i].first;
+        out_weights[i] = out_row[i].second;
+    }
+    for (id_type i = 0; i < in_row.size(); i++) {
+        in_list[i] = in_row[i].first;
+        in_weights[i] = in_row[i].second;
+    }
+    return edge_clustering_from_lists(g, from_id, to_id, &out_list[0], &out_weights[0], out_row.size(), &in_list[0], &in_weights[0], in_row.size());
+}
+
+template <typename G>
+void CDLib::edge_clustering_coefficients(const G& g, vector<double>& coefficients) {
+    id_type num_nodes = g.get_num_nodes();
+    sorted_adjacency out, in;
+    sort_adjacency(g, false, out);
+    sort_adjacency(g, true, in);
+    vector<id_type> first(num_nodes + 1, 0);
+    for (id_type i = 0; i < num_nodes; i++) first[i + 1] = first[i] + g.get_node_out_degree(i);
+    coefficients.assign(first[num_nodes], 0);
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel for schedule(dynamic,256) shared(g,coefficients,out,in,first)
+#endif
+    for (id_type i = 0; i < num_nodes; i++) {
+        id_type k = first[i];
+        for (auto aeit = g.out_edges_begin(i); aeit != g.out_edges_end(i); aeit++, k++) {
+            if (!aeit->second) continue;
+            id_type j = aeit->first;
+            coefficients[k] = edge_clustering_from_lists(g, i, j, out.begin(j), &out.weights[0] + out.offsets[j], out.size(j), in.begin(i), &in.weights[0] + in.offsets[i], in.size(i));
+        }
+    }
+}
+
+//Overloaded function for a single node
+
+template <typename G>
+double CDLib::node_clustering_coefficient(const G& g, id_type node) {
+    vector<id_type> neighbours(1, node);
+    for (auto aeit = g.out_edges_begin(node); aeit != g.out_edges_end(node); aeit++)
+        neighbours.push_back(aeit->first);
+    sort(neighbours.begin(), neighbours.end());
+    neighbours.erase(unique(neighbours.begin(), neighbours.end()), neighbours.end());
+    double edge_count = 0;
+    for (id_type i = 0; i < neighbours.size(); i++)
+        for (auto aeit = g.out_edges_begin(neighbours[i]); aeit != g.out_edges_end(neighbours[i]); aeit++)
+            if (binary_search(neighbours.begin(), neighbours.end(), aeit->first))
+                edge_count++;
+    //    This automatically takes care of directed and undirected graphs.
+    return closed_neighborhood_coefficient(g.get_node_out_degree(node), edge_count);
+}
+
+//Overloaded function for all nodes.
+
+template <typename G>
+void CDLib::node_clustering_coefficient(const G& g, vector<double>& nodes) {
+    double average;
+    clustering_coefficients(g, nodes, average);
+}
+
+template <typename G>
+void CDLib::node_clustering_coefficient_normalized(const G& g, vector<double>& nodes) {
     node_clustering_coefficient(g, nodes);
     if (g.get_num_nodes() <= 1)
         return;
@@ -205,25 +555,38 @@ void CDLib::node_clustering_coefficient_normalized(const graph& g, vector<double
         nodes[i] /= sum_norm;
 }
 
-double CDLib::average_clustering_coefficient(const graph& g) {
-    if (g.get_num_nodes() < 1)
-        return 0;
-    double avg_cc = 0;
+template <typename G>
+double CDLib::average_clustering_coefficient(const G& g) {
     vector<double> nodes;
-    node_clustering_coefficient(g, nodes);
-    for (id_type i = 0; i < nodes.size(); i++)
-        avg_cc += nodes[i];
-    avg_cc /= g.get_num_nodes();
-    return avg_cc;
+    double average;
+    clustering_coefficients(g, nodes, average);
+    return average;
 }
 
-double CDLib::closeness_centrality_original(const graph& g, id_type node) {
-    if ((node <= g.get_num_nodes()) && (node >= 0)) {
+template <typename G>
+void distances_from_node(const G& g, id_type node, vector<double>& distances) {
+    //  Breadth first on unweighted graphs and the Dijkstra engine, with the queue it picks
+    //  for the weights, otherwise. Negative weights leave distances empty.
+    distances.assign(g.get_num_nodes(), numeric_limits<double>::infinity());
+    if (!g.is_weighted()) {
+        bfs_engine<G> engine(g);
+        engine.run(node);
+        const vector<id_type>& reached = engine.get_order();
+        for (id_type i = 0; i < reached.size(); i++) distances[reached[i]] = engine.get_level(reached[i]);
+    } else if (!has_negative_edge_weights(g)) {
+        dijkstra_engine<G> engine(g);
+        engine.run(node);
+        distances = engine.get_distances();
+    } else distances.clear();
+}
+
+template <typename G>
+double CDLib::closeness_centrality_original(const G& g, id_type node) {
+    if (node >= g.get_num_nodes()) {
         return -1; // Reporting node out of range error.
     }
     vector<double> distances;
-    vector< vector<id_type> > preds;
-    single_source_shortest_paths_djikstra(g, node, distances, preds);
+    distances_from_node(g, node, distances);
     double sum = 0;
     for (id_type i = 0; i < distances.size(); i++)
         sum += distances[i];
@@ -231,28 +594,25 @@ double CDLib::closeness_centrality_original(const graph& g, id_type node) {
     return sum;
 }
 
-void closeness_centralities_original(const graph& g, vector<double>& closeness) {
+template <typename G>
+void CDLib::closeness_centralities_original(const G& g, vector<double>& closeness) {
     closeness.clear();
     closeness.assign(g.get_num_nodes(), 0);
-    vector< vector<double> > distance_matrix;
-    all_pairs_shortest_paths(g, distance_matrix);
-    for (id_type i = 0; i < g.get_num_nodes(); i++) {
-        double sum = 0;
-        for (id_type j = 0; j < distance_matrix[i].size(); j++)
-            sum += distance_matrix[i][j];
-        closeness[i] = g.get_num_nodes() / sum;
-    }
+    distance_sum_reducer distance_sum;
+    all_pairs_shortest_paths_reduce(g, distance_sum);
+    for (id_type i = 0; i < g.get_num_nodes(); i++)
+        closeness[i] = g.get_num_nodes() / distance_sum.get_sums()[i];
 }
 
-double CDLib::closeness_centrality(const graph& g, id_type node) {
+template <typename G>
+double CDLib::closeness_centrality(const G& g, id_type node) {
     //    This approach is explained in the book: Networks, An Introduction by Newman.
     //    It takes the Harmonic Mean of the Geodesic Distance.
-    if ((node <= g.get_num_nodes()) && (node >= 0)) {
+    if (node >= g.get_num_nodes()) {
         return -1; // Reporting node out of range error.
     }
     vector<double> distances;
-    vector< vector<id_type> > preds;
-    single_source_shortest_paths_djikstra(g, node, distances, preds);
+    distances_from_node(g, node, distances);
     double sum = 0;
     for (id_type i = 0; i < distances.size(); i++)
         if (node != i)
@@ -261,23 +621,20 @@ double CDLib::closeness_centrality(const graph& g, id_type node) {
     return sum;
 }
 
-void CDLib::closeness_centralities(const graph& g, vector<double>& closeness) {
+template <typename G>
+void CDLib::closeness_centralities(const G& g, vector<double>& closeness) {
     //    This approach is explained in the book: Networks, An Introduction by Newman.
     //    It takes the Harmonic Mean of the Geodesic Distance.
     closeness.clear();
     closeness.assign(g.get_num_nodes(), 0);
-    vector< vector<double> > distance_matrix;
-    all_pairs_shortest_paths(g, distance_matrix);
-    for (id_type i = 0; i < g.get_num_nodes(); i++) {
-        double sum = 0;
-        for (id_type j = 0; j < distance_matrix[i].size(); j++)
-            if (i != j)
-                sum += 1 / distance_matrix[i][j];
-        closeness[i] = sum / (g.get_num_nodes() - 1);
-    }
+    harmonic_sum_reducer harmonic;
+    all_pairs_shortest_paths_reduce(g, harmonic);
+    for (id_type i = 0; i < g.get_num_nodes(); i++)
+        closeness[i] = harmonic.get_sums()[i] / (g.get_num_nodes() - 1);
 }
 
-void CDLib::closeness_centralities_normalized(const graph& g, vector<double>& closeness) {
+template <typename G>
+void CDLib::closeness_centralities_normalized(const G& g, vector<double>& closeness) {
     closeness_centralities(g, closeness);
     if (g.get_num_nodes() <= 1)
         return;
@@ -290,7 +647,8 @@ double sum_of_squares(double x, double y) {
     return (x + (y * y));
 }
 
-void CDLib::eigenvector_centralities(const graph& g, vector<double>& eigenvector) {
+template <typename G>
+void CDLib::eigenvector_centralities(const G& g, vector<double>& eigenvector) {
     eigenvector.clear();
     if (g.get_num_nodes() <= 0)
         return;
@@ -314,7 +672,7 @@ void CDLib::eigenvector_centralities(const graph& g, vector<double>& eigenvector
 #pragma omp parallel for shared(g,outvector,invector)
 #endif
         for (id_type i = 0; i < g.get_num_nodes(); i++) {
-            for (adjacent_edges_iterator aeit = g.out_edges_begin(i); aeit != g.out_edges_end(i); aeit++) {
+            for (auto aeit = g.out_edges_begin(i); aeit != g.out_edges_end(i); aeit++) {
                 outvector[i] += aeit->second * invector[aeit->first];
             }
         }
@@ -333,7 +691,8 @@ void CDLib::eigenvector_centralities(const graph& g, vector<double>& eigenvector
     eigenvector.assign(invector.begin(), invector.end());
 }
 
-void CDLib::eigenvector_centralities_normalized(const graph& g, vector<double>& eigenvector) {
+template <typename G>
+void CDLib::eigenvector_centralities_normalized(const G& g, vector<double>& eigenvector) {
     eigenvector_centralities(g, eigenvector);
     if (g.get_num_nodes() <= 1)
         return;
@@ -360,7 +719,8 @@ void CDLib::efficiency_centralities(const graph& g, vector<double>& centralities
     }
 }
 
-pair<string, double> CDLib::get_max_degree_node(const graph & g) {
+template <typename G>
+pair<string, double> CDLib::get_max_degree_node(const G& g) {
     pair<string, double> max("", 0);
     for (id_type i = 0; i < g.get_num_nodes(); i++) {
         if (max.second < g.get_node_out_degree(i)) {
@@ -371,7 +731,8 @@ pair<string, double> CDLib::get_max_degree_node(const graph & g) {
     return max;
 }
 
-pair<string, double> CDLib::get_max_degree_node(const graph & g, const node_set_string& elements) {
+template <typename G>
+pair<string, double> CDLib::get_max_degree_node(const G& g, const node_set_string& elements) {
     pair<string, double> max("", 0);
     for (auto it = elements.begin(); it != elements.end(); it++) {
         id_type node = g.get_node_id(*it);
@@ -385,10 +746,21 @@ pair<string, double> CDLib::get_max_degree_node(const graph & g, const node_set_
     return max;
 }
 
-pair<string, double> CDLib::get_max_betweenness_node(const graph & g) {
+template <typename G>
+pair<string, double> CDLib::get_max_betweenness_node(const G& g) {
+    return get_max_betweenness_node(g, 0, 0);
+}
+
+template <typename G>
+pair<string, double> CDLib::get_max_betweenness_node(const G& g, const node_set_string& elements) {
+    return get_max_betweenness_node(g, elements, 0, 0);
+}
+
+template <typename G>
+pair<string, double> CDLib::get_max_betweenness_node(const G& g, id_type num_samples, unsigned long seed) {
     pair<string, double> max("", 0);
     vector<double> bc;
-    betweeness_centralities(g, bc);
+    betweenness_centralities_sampled(g, bc, num_samples, seed);
     for (id_type i = 0; i < g.get_num_nodes(); i++) {
         if (max.second < bc[i]) {
             max.first = g.get_node_label(i);
@@ -398,10 +770,11 @@ pair<string, double> CDLib::get_max_betweenness_node(const graph & g) {
     return max;
 }
 
-pair<string, double> CDLib::get_max_betweenness_node(const graph & g, const node_set_string& elements) {
+template <typename G>
+pair<string, double> CDLib::get_max_betweenness_node(const G& g, const node_set_string& elements, id_type num_samples, unsigned long seed) {
     pair<string, double> max("", 0);
     vector<double> bc;
-    betweeness_centralities(g, bc);
+    betweenness_centralities_sampled(g, bc, num_samples, seed);
     for (auto it = elements.begin(); it != elements.end(); it++) {
         id_type node = g.get_node_id(*it);
         if (node < g.get_num_nodes()) {
@@ -414,7 +787,7 @@ pair<string, double> CDLib::get_max_betweenness_node(const graph & g, const node
     return max;
 }
 
-pair<string, double> CDLib::get_max_efficiency_centrality_node(const graph & g) {
+pair<string, double> CDLib::get_max_efficiency_centrality_node(const graph& g) {
     pair<string, double> max("", 0);
     vector<double> eff_cent;
     efficiency_centralities(g, eff_cent);
@@ -428,7 +801,7 @@ pair<string, double> CDLib::get_max_efficiency_centrality_node(const graph & g)
     return max;
 }
 
-pair<string, double> CDLib::get_max_efficiency_centrality_node(const graph & g, const node_set_string& elements) {
+pair<string, double> CDLib::get_max_efficiency_centrality_node(const graph& g, const node_set_string& elements) {
     pair<string, double> max("", 0);
     double global_efficiency = efficiency_sw_global(g);
     for (auto it = elements.begin(); it != elements.end(); it++) {
@@ -446,3 +819,35 @@ pair<string, double> CDLib::get_max_efficiency_centrality_node(const graph & g,
     return max;
 }
 
+#define CENTRALITY_INSTANTIATE(G) \
+    template void CDLib::betweeness_centralities<G>(const G&, vector<double>&); \
+    template void CDLib::betweenness_centralities_sampled<G>(const G&, vector<double>&, id_type, unsigned long); \
+    template id_type CDLib::betweenness_centralities_approximate<G>(const G&, vector<double>&, double, double, unsigned long); \
+    template void CDLib::betweenness_centralities_normalized<G>(const G&, vector<double>&); \
+    template double CDLib::edge_clustering_coefficient<G>(const G&, id_type, id_type); \
+    template void CDLib::degree_centralities_normalized<G>(const G&, vector<double>&); \
+    template void CDLib::degree_vector<G>(const G&, vector<id_type>&); \
+    template void CDLib::degree_sequence<G>(const G&, vector<id_type>&); \
+    template double CDLib::node_clustering_coefficient<G>(const G&, id_type); \
+    template void CDLib::node_clustering_coefficient<G>(const G&, vector<double>&); \
+    template void CDLib::node_clustering_coefficient_normalized<G>(const G&, vector<double>&); \
+    template double CDLib::average_clustering_coefficient<G>(const G&); \
+    template double CDLib::clustering_coefficients<G>(const G&, vector<double>&, double&); \
+    template double CDLib::transitivity<G>(const G&); \
+    template id_type CDLib::triangle_counts<G>(const G&, vector<id_type>&); \
+    template void CDLib::edge_clustering_coefficients<G>(const G&, vector<double>&); \
+    template double CDLib::closeness_centrality_original<G>(const G&, id_type); \
+    template void CDLib::closeness_centralities_original<G>(const G&, vector<double>&); \
+    template double CDLib::closeness_centrality<G>(const G&, id_type); \
+    template void CDLib::closeness_centralities<G>(const G&, vector<double>&); \
+    template void CDLib::closeness_centralities_normalized<G>(const G&, vector<double>&); \
+    template void CDLib::eigenvector_centralities<G>(const G&, vector<double>&); \
+    template void CDLib::eigenvector_centralities_normalized<G>(const G&, vector<double>&); \
+    template pair<string, double> CDLib::get_max_degree_node<G>(const G&); \
+    template pair<string, double> CDLib::get_max_degree_node<G>(const G&, const node_set_string&); \
+    template pair<string, double> CDLib::get_max_betweenness_node<G>(const G&); \
+    template pair<string, double> CDLib::get_max_betweenness_node<G>(const G&, const node_set_string&); \
+    template pair<string, double> CDLib::get_max_betweenness_node<G>(const G&, id_type, unsigned long); \
+    template pair<string, double> CDLib::get_max_betweenness_node<G>(const G&, const node_set_string&, id_type, unsigned long);
+
+CDLIB_FOR_EACH_GRAPH_BACKEND(CENTRALITY_INSTANTIATE)
@@ -14,40 +14,62 @@
 
 using namespace std;
 namespace CDLib {
-    void betweeness_centralities(const graph& g, vector<double>& bc);
-    void betweenness_centralities_normalized(const graph& g, vector<double>& bcn);
-    double edge_clustering_coefficient(const graph&g, id_type from_id, id_type to_id);
+    //    Routines taking a const G& are templated over the graph backend and are
+    //    instantiated in centrality.cpp for each CDLIB_FOR_EACH_GRAPH_BACKEND entry.
+    //    The efficiency centralities isolate nodes on a copy of the graph and so remain
+    //    specific to graph.
+    template <typename G> void betweeness_centralities(const G& g, vector<double>& bc);
+    template <typename G> void betweenness_centralities_normalized(const G& g, vector<double>& bcn);
+    //    Approximate betweenness from a seeded sample of source nodes. A num_samples of 0, or
+    //    at least the number of nodes, gives the exact values. The approximate variant picks
+    //    the sample size so that, with probability at least 1 - delta, every estimate is
+    //    within epsilon * n * (n - 2) of the exact value, and returns the size it used.
+    template <typename G> void betweenness_centralities_sampled(const G& g, vector<double>& bc, id_type num_samples, unsigned long seed);
+    template <typename G> id_type betweenness_centralities_approximate(const G& g, vector<double>& bc, double epsilon, double delta, unsigned long seed);
+    id_type betweenness_sample_size(id_type num_nodes, double epsilon, double delta);
+    template <typename G> double edge_clustering_coefficient(const G& g, id_type from_id, id_type to_id);
 
-    template <typename T>
-    void degree_centralities(const graph& g, vector<T>& degrees) {
+    template <typename G, typename T>
+    void degree_centralities(const G& g, vector<T>& degrees) {
         //    Return the out-degree centrality of all the nodes in the given graph.
         degrees.clear();
         for (id_type i = 0; i < g.get_num_nodes(); i++)
             degrees.push_back((T) g.get_node_out_degree(i));
     }
-    void degree_centralities_normalized(const graph& g, vector<double>& degrees);
-    void degree_vector(const graph& g, vector<id_type>& sequence); // List the degree of all the nodes in the network in a vector
-    void degree_sequence(const graph& g, vector<id_type>& sequence);
+    template <typename G> void degree_centralities_normalized(const G& g, vector<double>& degrees);
+    template <typename G> void degree_vector(const G& g, vector<id_type>& sequence); // List the degree of all the nodes in the network in a vector
+    template <typename G> void degree_sequence(const G& g, vector<id_type>& sequence);
     /*This gives the #nodes of degree indicated as the index of sequence variable in an undirected graph*/
     //    Overoaded Node Clustering Coefficient for single and all nodes.
-    double node_clustering_coefficient(const graph&g, id_type node);
-    void node_clustering_coefficient(const graph&g, vector<double>& nodes);
-    void node_clustering_coefficient_normalized(const graph& g, vector<double>& nodes);
-    double average_clustering_coefficient(const graph& g);
-    double closeness_centrality_original(const graph& g, id_type node);
-    void closeness_centralities_original(const graph& g, vector<double>& closeness);
-    double closeness_centrality(const graph& g, id_type node);
-    void closeness_centralities(const graph& g, vector<double>& closeness);
-    void closeness_centralities_normalized(const graph& g, vector<double>& closeness);
-    void eigenvector_centralities(const graph& g, vector<double>& eigenvector);
-    void eigenvector_centralities_normalized(const graph& g, vector<double>& eigenvector);
+    template <typename G> double node_clustering_coefficient(const G& g, id_type node);
+    template <typename G> void node_clustering_coefficient(const G& g, vector<double>& nodes);
+    template <typename G> void node_clustering_coefficient_normalized(const G& g, vector<double>& nodes);
+    template <typename G> double average_clustering_coefficient(const G& g);
+    //    Clustering from one triangle listing over sorted, degree ordered adjacency: fills the
+    //    coefficient of every node and their average and returns the global transitivity,
+    //    3 * triangles / connected triples of the graph taken as undirected without self loops.
+    template <typename G> double clustering_coefficients(const G& g, vector<double>& nodes, double& average);
+    template <typename G> double transitivity(const G& g);
+    //    Triangles through every node of the graph taken as undirected; returns their total.
+    template <typename G> id_type triangle_counts(const G& g, vector<id_type>& triangles);
+    //    edge_clustering_coefficient of every arc, in the order of the out_edges iterators.
+    template <typename G> void edge_clustering_coefficients(const G& g, vector<double>& coefficients);
+    template <typename G> double closeness_centrality_original(const G& g, id_type node);
+    template <typename G> void closeness_centralities_original(const G& g, vector<double>& closeness);
+    template <typename G> double closeness_centrality(const G& g, id_type node);
+    template <typename G> void closeness_centralities(const G& g, vector<double>& closeness);
+    template <typename G> void closeness_centralities_normalized(const G& g, vector<double>& closeness);
+    template <typename G> void eigenvector_centralities(const G& g, vector<double>& eigenvector);
+    template <typename G> void eigenvector_centralities_normalized(const G& g, vector<double>& eigenvector);
     double efficiency_centrality(const graph& g, id_type node);
     void efficiency_centralities(const graph& g, vector<double>& centralities);
     // Below functions return <node label, value> pair
-    pair<string, double> get_max_degree_node(const graph & g);
-    pair<string, double> get_max_degree_node(const graph & g, const node_set_string& elements);
-    pair<string, double> get_max_betweenness_node(const graph & g);
-    pair<string, double> get_max_betweenness_node(const graph & g, const node_set_string& elements);
+    template <typename G> pair<string, double> get_max_degree_node(const G& g);
+    template <typename G> pair<string, double> get_max_degree_node(const G& g, const node_set_string& elements);
+    template <typename G> pair<string, double> get_max_betweenness_node(const G& g);
+    template <typename G> pair<string, double> get_max_betweenness_node(const G& g, const node_set_string& elements);
+    template <typename G> pair<string, double> get_max_betweenness_node(const G& g, id_type num_samples, unsigned long seed);
+    template <typename G> pair<string, double> get_max_betweenness_node(const G& g, const node_set_string& elements, id_type num_samples, unsigned long seed);
     pair<string, double> get_max_efficiency_centrality_node(const graph & g);
     pair<string, double> get_max_efficiency_centrality_node(const graph & g, const node_set_string& elements);
 };
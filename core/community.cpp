@@ -43,10 +43,11 @@ using namespace CDLib;
  * Output: 
  */
 
-double get_neighs_in_set(id_type v, const graph& g, node_set& B, node_set& X) {
+template <typename G>
+double get_neighs_in_set(id_type v, const G& g, node_set& B, node_set& X) {
     X.clear();
     double retval = 0;
-    for (adjacent_edges_iterator aeit = g.out_edges_begin(v); aeit != g.out_edges_end(v); aeit++) {
+    for (auto aeit = g.out_edges_begin(v); aeit != g.out_edges_end(v); aeit++) {
         if (B.find(aeit->first) != B.end()) {
             X.insert(aeit->first);
             retval += 1;
@@ -55,10 +56,11 @@ double get_neighs_in_set(id_type v, const graph& g, node_set& B, node_set& X) {
     return retval;
 }
 
-double get_neighs_not_in_sets(id_type v, const graph& g, node_set& C, node_set& U, node_set& X) {
+template <typename G>
+double get_neighs_not_in_sets(id_type v, const G& g, node_set& C, node_set& U, node_set& X) {
     X.clear();
     double retval = 0;
-    for (adjacent_edges_iterator aeit = g.out_edges_begin(v); aeit != g.out_edges_end(v); aeit++) {
+    for (auto aeit = g.out_edges_begin(v); aeit != g.out_edges_end(v); aeit++) {
         if (C.find(aeit->first) == C.end() && U.find(aeit->first) == U.end()) {
             X.insert(aeit->first);
             retval += 1;
@@ -67,24 +69,27 @@ double get_neighs_not_in_sets(id_type v, const graph& g, node_set& C, node_set&
     return retval;
 }
 
-bool membership(id_type vk, id_type v, const graph& g, node_set& U) {
-    for (adjacent_edges_iterator aeit = g.out_edges_begin(vk); aeit != g.out_edges_end(vk); aeit++)
+template <typename G>
+bool membership(id_type vk, id_type v, const G& g, node_set& U) {
+    for (auto aeit = g.out_edges_begin(vk); aeit != g.out_edges_end(vk); aeit++)
         if ((aeit->first) != v && U.find(aeit->first) != U.end())
             return 1;
     return 0;
 }
 
-double no_BI_edges(id_type v, const graph& g, node_set& C, node_set& B) {
+template <typename G>
+double no_BI_edges(id_type v, const G& g, node_set& C, node_set& B) {
     double count = 0;
-    for (adjacent_edges_iterator aeit = g.out_edges_begin(v); aeit != g.out_edges_end(v); aeit++)
+    for (auto aeit = g.out_edges_begin(v); aeit != g.out_edges_end(v); aeit++)
         if (C.find(aeit->first) != C.end() && B.find(aeit->first) == B.end())
             count += 1;
     return count;
 }
 
-double no_BY_edges(id_type v, const graph& g, node_set& Y) {
+template <typename G>
+double no_BY_edges(id_type v, const G& g, node_set& Y) {
     double count = 0;
-    for (adjacent_edges_iterator aeit = g.out_edges_begin(v); aeit != g.out_edges_end(v); aeit++)
+    for (auto aeit = g.out_edges_begin(v); aeit != g.out_edges_end(v); aeit++)
         if (Y.find(aeit->first) != Y.end())
             count += 1;
     return count;
@@ -94,11 +99,12 @@ double no_BY_edges(id_type v, const graph& g, node_set& Y) {
 
 //-----------------------------------------------------------------------------------------------------------------------------------------
 
-bool CDLib::local_community_clauset(const graph& g, id_type src, size_t k, node_set& output) {
+template <typename G>
+bool CDLib::local_community_clauset(const G& g, id_type src, size_t k, node_set& output) {
     vector< pair<id_type, double> > output2;
     node_set C, U, B;
     C.insert(src);
-    for (adjacent_edges_iterator aeit = g.out_edges_begin(src); aeit != g.out_edges_end(src); aeit++)
+    for (auto aeit = g.out_edges_begin(src); aeit != g.out_edges_end(src); aeit++)
         U.insert(aeit->first);
     B.insert(src);
 
@@ -225,11 +231,12 @@ bool CDLib::local_community_clauset(const graph& g, id_type src, size_t k, node_
 
 //-----------------------------------------------------------------------------------------------------------------------------------------
 
-bool CDLib::local_community_clauset_modified(const graph& g, id_type src, size_t k, node_set& output) {
+template <typename G>
+bool CDLib::local_community_clauset_modified(const G& g, id_type src, size_t k, node_set& output) {
     vector< pair<id_type, double> > output2;
     node_set C, U;
     C.insert(src);
-    for (adjacent_edges_iterator aeit = g.out_edges_begin(src); aeit != g.out_edges_end(src); aeit++)
+    for (auto aeit = g.out_edges_begin(src); aeit != g.out_edges_end(src); aeit++)
         U.insert(aeit->first);
 
     double Z = 0;
@@ -329,7 +336,8 @@ bool degpr_comp(const pair<id_type, id_type>& lhs, const pair<id_type, id_type>&
     return lhs.first < rhs.first;
 }
 
-void sort_acc_degrees(vector<id_type>& N, const graph& g) {
+template <typename G>
+void sort_acc_degrees(vector<id_type>& N, const G& g) {
     //deg_comp this_object_compares_degrees(&g);
     //sort(N.begin(),N.end(),degpr_comp);
     vector<pair<id_type, id_type> > degpr(g.get_num_nodes(), make_pair(0, 0));
@@ -341,7 +349,8 @@ void sort_acc_degrees(vector<id_type>& N, const graph& g) {
 
 }
 
-void bubble_sort_acc_degrees(vector<id_type>& N, const graph& g) {
+template <typename G>
+void bubble_sort_acc_degrees(vector<id_type>& N, const G& g) {
     id_type temp;
     for (size_t i = 0; i < (N.size() - 1); i++)
         for (size_t j = N.size() - 1; j > i; j--)
@@ -362,7 +371,8 @@ bool found_in_vector(id_type v, const vector<id_type>& S, size_t& index) {
     return 0;
 }
 
-double get_no_neighs_in_vector(id_type v, const graph& g, const vector<id_type>& subgraph) {
+template <typename G>
+double get_no_neighs_in_vector(id_type v, const G& g, const vector<id_type>& subgraph) {
     //create an unordered set copy of the subgraph vector for time complexity issues
     //    node_set S;
     //    for(size_t i=0; i<subgraph.size(); i++)
@@ -391,7 +401,8 @@ void delete_from_vector_at_position(id_type v, vector<id_type>& N, size_t i) {
 
 }
 
-void bfs_visitor_in_subgraph(const graph& g, const vector<id_type>& subgraph, id_type source, node_set& visited) {
+template <typename G>
+void bfs_visitor_in_subgraph(const G& g, const vector<id_type>& subgraph, id_type source, node_set& visited) {
     //create an unordered set copy of the subgraph vector for time complexity issues
     node_set S;
     for (size_t i = 0; i < subgraph.size(); i++)
@@ -408,7 +419,7 @@ void bfs_visitor_in_subgraph(const graph& g, const vector<id_type>& subgraph, id
             //visit node
             visited.insert(current);
             //expand node
-            for (adjacent_edges_iterator aeit = g.out_edges_begin(current); aeit != g.out_edges_end(current); aeit++) {
+            for (auto aeit = g.out_edges_begin(current); aeit != g.out_edges_end(current); aeit++) {
                 if (visited.find(aeit->first) == visited.end() && S.find(aeit->first) != S.end()) {
                     //push neighbors to be visited
                     q_bfs.push(aeit->first); //insert only those neighbors which have not been "visited" yet
@@ -418,12 +429,14 @@ void bfs_visitor_in_subgraph(const graph& g, const vector<id_type>& subgraph, id
     }
 }
 
-size_t get_component_around_node_in_subgraph(const graph& g, const vector<id_type>& S, id_type source, node_set& visited) {
+template <typename G>
+size_t get_component_around_node_in_subgraph(const G& g, const vector<id_type>& S, id_type source, node_set& visited) {
     bfs_visitor_in_subgraph(g, S, source, visited);
     return visited.size();
 }
 
-bool connected_on_removal_at_position(const graph& g, const vector<id_type>& S, id_type u, size_t i) {
+template <typename G>
+bool connected_on_removal_at_position(const G& g, const vector<id_type>& S, id_type u, size_t i) {
     //Note: S has been passed by value to avoid reflection of changes to the original subgraph S after deletion in this function
     //removing node u at position i in subgraph vector S in graph G
     vector<id_type> Sc(S.size(), 0);
@@ -437,13 +450,14 @@ bool connected_on_removal_at_position(const graph& g, const vector<id_type>& S,
 
 //-----------------------------------------------------------------------------------------------------------------------------------------
 
-bool CDLib::LWP_2006(const graph& g, id_type src, node_set& output) {
+template <typename G>
+bool CDLib::LWP_2006(const G& g, id_type src, node_set& output) {
     output.clear();
     vector<id_type> S, N, Q, deleteQ;
     size_t index;
     //initialization
     S.push_back(src);
-    for (adjacent_edges_iterator aeit = g.out_edges_begin(src); aeit != g.out_edges_end(src); aeit++)
+    for (auto aeit = g.out_edges_begin(src); aeit != g.out_edges_end(src); aeit++)
         N.push_back(aeit->first);
 
     double I = 0, E = g.get_node_out_degree(src), M = 0;
@@ -521,7 +535,7 @@ bool CDLib::LWP_2006(const graph& g, id_type src, node_set& output) {
 
         //ADD VERTICES TO N
         for (size_t i = 0; i < Q.size(); i++)
-            for (adjacent_edges_iterator aeit = g.out_edges_begin(Q[i]); aeit != g.out_edges_end(Q[i]); aeit++)
+            for (auto aeit = g.out_edges_begin(Q[i]); aeit != g.out_edges_end(Q[i]); aeit++)
                 if (found_in_vector(aeit->first, S, index) == 0 && found_in_vector(aeit->first, N, index) == 0)
                     N.push_back(aeit->first);
 
@@ -554,9 +568,10 @@ bool CDLib::LWP_2006(const graph& g, id_type src, node_set& output) {
 }
 //-----------------------------------------------------------------------------------------------------------------------------------------
 
-double get_no_neighs_in_set(id_type v, const graph& g, node_set& C) {
+template <typename G>
+double get_no_neighs_in_set(id_type v, const G& g, node_set& C) {
     double retval = 0;
-    for (adjacent_edges_iterator aeit = g.out_edges_begin(v); aeit != g.out_edges_end(v); aeit++)
+    for (auto aeit = g.out_edges_begin(v); aeit != g.out_edges_end(v); aeit++)
         if (C.find(aeit->first) != C.end())
             retval += aeit->second;
     return retval;
@@ -585,7 +600,8 @@ void delete_from_deque(id_type u, deque<id_type>& Q) {
 
 //-----------------------------------------------------------------------------------------------------------------------------------------
 
-void CDLib::VD_2011(const graph& g, id_type src, node_set& output) {
+template <typename G>
+void CDLib::VD_2011(const G& g, id_type src, node_set& output) {
     deque<id_type> Q;
     node_set C;
     node_set visited;
@@ -595,7 +611,7 @@ void CDLib::VD_2011(const graph& g, id_type src, node_set& output) {
     size_t iter_count = 0, N_at_start;
 
     //Initialize C with the source vertex and its neighbors AND update I, E and N
-    for (adjacent_edges_iterator aeit = g.out_edges_begin(u); aeit != g.out_edges_end(u); aeit++) {
+    for (auto aeit = g.out_edges_begin(u); aeit != g.out_edges_end(u); aeit++) {
         x = get_no_neighs_in_set(aeit->first, g, C);
         y = g.get_node_out_degree(aeit->first) - x;
         C.insert(aeit->first);
@@ -609,7 +625,7 @@ void CDLib::VD_2011(const graph& g, id_type src, node_set& output) {
     visited.insert(u); //the source vertex has now been visited
 
     //push all neighbors of src in Q for visiting them
-    for (adjacent_edges_iterator aeit = g.out_edges_begin(u); aeit != g.out_edges_end(u); aeit++) {
+    for (auto aeit = g.out_edges_begin(u); aeit != g.out_edges_end(u); aeit++) {
         Q.push_back(aeit->first);
     }
 
@@ -634,7 +650,7 @@ void CDLib::VD_2011(const graph& g, id_type src, node_set& output) {
             visited.insert(u); //visit the node
 
             //push the required neighbors of u in Q and try agglomerating them into C
-            for (adjacent_edges_iterator aeit = g.out_edges_begin(u); aeit != g.out_edges_end(u); aeit++) {
+            for (auto aeit = g.out_edges_begin(u); aeit != g.out_edges_end(u); aeit++) {
                 id_type w = aeit->first;
                 if (visited.find(w) == visited.end() && not_found_in_deque(w, Q)) //Doubt
                     Q.push_back(w);
@@ -714,7 +730,7 @@ void CDLib::VD_2011(const graph& g, id_type src, node_set& output) {
     //const double max_threshold = 0.1;
     node_set C, B;
     C.insert(src);
-    for(adjacent_edges_iterator aeit = g.out_edges_begin(src); aeit != g.out_edges_end(src); aeit++)
+    for(auto aeit = g.out_edges_begin(src); aeit != g.out_edges_end(src); aeit++)
         B.insert(aeit->first);
     
     //map<double,id_type> omegas;
@@ -747,7 +763,7 @@ void CDLib::VD_2011(const graph& g, id_type src, node_set& output) {
         x = get_no_neighs_in_set(node_aggl, g, C);
         y = g.get_node_out_degree(node_aggl) - x;
         
-        for(adjacent_edges_iterator aeit = g.out_edges_begin(node_aggl); aeit != g.out_edges_end(node_aggl); aeit++)
+        for(auto aeit = g.out_edges_begin(node_aggl); aeit != g.out_edges_end(node_aggl); aeit++)
             if(C.find(aeit->first) != C.end())
             {
                 z = aeit->first;
@@ -801,7 +817,7 @@ void CDLib::VD_2011(const graph& g, id_type src, node_set& output) {
         //cout<<"\nnew flag: "<<flag;
         
         //Update omegas
-        for(adjacent_edges_iterator aeit = g.out_edges_begin(node_aggl); aeit != g.out_edges_end(node_aggl); aeit++)
+        for(auto aeit = g.out_edges_begin(node_aggl); aeit != g.out_edges_end(node_aggl); aeit++)
         {
             u = aeit->first;
             if(B.find(u) == B.end() && C.find(u) == C.end())
@@ -830,11 +846,12 @@ void CDLib::VD_2011(const graph& g, id_type src, node_set& output) {
 }
  */
 
-bool CDLib::Bagrow_2007(const graph& g, id_type src, node_set& output) {
+template <typename G>
+bool CDLib::Bagrow_2007(const G& g, id_type src, node_set& output) {
     //const double max_threshold = 0.1;
     node_set C, B, temp;
     C.insert(src);
-    for (adjacent_edges_iterator aeit = g.out_edges_begin(src); aeit != g.out_edges_end(src); aeit++)
+    for (auto aeit = g.out_edges_begin(src); aeit != g.out_edges_end(src); aeit++)
         B.insert(aeit->first);
 
     //map<double,id_type> omegas;
@@ -866,7 +883,7 @@ bool CDLib::Bagrow_2007(const graph& g, id_type src, node_set& output) {
         x = get_no_neighs_in_set(node_aggl, g, C);
         y = g.get_node_out_degree(node_aggl) - x;
 
-        for (adjacent_edges_iterator aeit = g.out_edges_begin(node_aggl); aeit != g.out_edges_end(node_aggl); aeit++)
+        for (auto aeit = g.out_edges_begin(node_aggl); aeit != g.out_edges_end(node_aggl); aeit++)
             if (C.find(aeit->first) != C.end()) {
                 z = aeit->first;
                 xi = get_no_neighs_in_set(z, g, C);
@@ -916,7 +933,7 @@ bool CDLib::Bagrow_2007(const graph& g, id_type src, node_set& output) {
         //cout<<"\nnew flag: "<<flag;
 
         //Update omegas and B
-        for (adjacent_edges_iterator aeit = g.out_edges_begin(node_aggl); aeit != g.out_edges_end(node_aggl); aeit++) {
+        for (auto aeit = g.out_edges_begin(node_aggl); aeit != g.out_edges_end(node_aggl); aeit++) {
             u = aeit->first;
             if (B.find(u) == B.end() && C.find(u) == C.end()) {
                 omega_val = 1 - 2 / g.get_node_out_degree(u);
@@ -978,7 +995,8 @@ bool CDLib::Bagrow_2007(const graph& g, id_type src, node_set& output) {
 
 //-----------------------------------------------------------------------------------------------------------------------------------------
 
-void bfs_visitor_in_subgraph_set(const graph& g, node_set& C, id_type source, node_set& visited) {
+template <typename G>
+void bfs_visitor_in_subgraph_set(const G& g, node_set& C, id_type source, node_set& visited) {
     //create an unordered set copy of the subgraph vector for time complexity issues
     //node_set S;
     //for(size_t i=0; i<subgraph.size(); i++)
@@ -995,7 +1013,7 @@ void bfs_visitor_in_subgraph_set(const graph& g, node_set& C, id_type source, no
             //visit node
             visited.insert(current);
             //expand node
-            for (adjacent_edges_iterator aeit = g.out_edges_begin(current); aeit != g.out_edges_end(current); aeit++) {
+            for (auto aeit = g.out_edges_begin(current); aeit != g.out_edges_end(current); aeit++) {
                 if (visited.find(aeit->first) == visited.end() && C.find(aeit->first) != C.end()) {
                     //push neighbors to be visited
                     q_bfs.push(aeit->first); //insert only those neighbors which have not been "visited" yet
@@ -1005,12 +1023,14 @@ void bfs_visitor_in_subgraph_set(const graph& g, node_set& C, id_type source, no
     }
 }
 
-size_t get_component_around_node(const graph& g, node_set& C, id_type source, node_set& visited) {
+template <typename G>
+size_t get_component_around_node(const G& g, node_set& C, id_type source, node_set& visited) {
     bfs_visitor_in_subgraph_set(g, C, source, visited);
     return visited.size();
 }
 
-bool connected_on_removal(const graph& g, node_set C, id_type u) {
+template <typename G>
+bool connected_on_removal(const G& g, node_set C, id_type u) {
     //Note: C has been passed by value to avoid reflection of changes to the original subgraph C after deletion in this function
     //deleting
     C.erase(u);
@@ -1020,12 +1040,13 @@ bool connected_on_removal(const graph& g, node_set C, id_type u) {
 }
 //-----------------------------------------------------------------------------------------------------------------------------------------
 
-bool CDLib::My_Algorithm(const graph& g, id_type src, node_set& output) {
+template <typename G>
+bool CDLib::My_Algorithm(const G& g, id_type src, node_set& output) {
     node_set C, U;
     vector<id_type> U_vector;
     C.insert(src);
     //C_vector.push_back(src);
-    for (adjacent_edges_iterator aeit = g.out_edges_begin(src); aeit != g.out_edges_end(src); aeit++)
+    for (auto aeit = g.out_edges_begin(src); aeit != g.out_edges_end(src); aeit++)
         U.insert(aeit->first);
     //for(node_set::iterator iter=U.begin(); iter!=U.end();iter++)
     //    U_vector.push_back(*iter);
@@ -1070,7 +1091,7 @@ bool CDLib::My_Algorithm(const graph& g, id_type src, node_set& output) {
 
 
                     nu_new = nu - 1;
-                    for (adjacent_edges_iterator aeit = g.out_edges_begin(vj); aeit != g.out_edges_end(vj); aeit++) {
+                    for (auto aeit = g.out_edges_begin(vj); aeit != g.out_edges_end(vj); aeit++) {
                         v = aeit->first;
                         if (C.find(v) == C.end() && U.find(v) == U.end())
                             nu_new = nu_new + 1;
@@ -1078,7 +1099,7 @@ bool CDLib::My_Algorithm(const graph& g, id_type src, node_set& output) {
 
                     if (y > 0)
                         nb_new = nb + 1;
-                    for (adjacent_edges_iterator aeit = g.out_edges_begin(vj); aeit != g.out_edges_end(vj); aeit++) {
+                    for (auto aeit = g.out_edges_begin(vj); aeit != g.out_edges_end(vj); aeit++) {
                         v = aeit->first;
                         if (C.find(v) != C.end() && get_no_neighs_in_set(v, g, U) == 1)
                             nb_new = nb_new - 1;
@@ -1096,7 +1117,7 @@ bool CDLib::My_Algorithm(const graph& g, id_type src, node_set& output) {
                         C.insert(vj);
                         //iter++;
                         U.erase(vj);
-                        for (adjacent_edges_iterator aeit = g.out_edges_begin(vj); aeit != g.out_edges_end(vj); aeit++) //REQUIRED!!!!
+                        for (auto aeit = g.out_edges_begin(vj); aeit != g.out_edges_end(vj); aeit++) //REQUIRED!!!!
                         {
                             v = aeit->first;
                             if (C.find(v) == C.end() && U.find(v) == U.end())
@@ -1144,7 +1165,7 @@ bool CDLib::My_Algorithm(const graph& g, id_type src, node_set& output) {
 
                 nu_new = nu + 1;
 
-                for (adjacent_edges_iterator aeit = g.out_edges_begin(ui); aeit != g.out_edges_end(ui); aeit++) {
+                for (auto aeit = g.out_edges_begin(ui); aeit != g.out_edges_end(ui); aeit++) {
                     v = aeit->first;
                     if (C.find(v) == C.end() && get_no_neighs_in_set(v, g, C) == 1)
                         nu_new = nu_new - 1;
@@ -1153,7 +1174,7 @@ bool CDLib::My_Algorithm(const graph& g, id_type src, node_set& output) {
                 if (y > 0)
                     nb_new = nb - 1;
 
-                for (adjacent_edges_iterator aeit = g.out_edges_begin(ui); aeit != g.out_edges_end(ui); aeit++) {
+                for (auto aeit = g.out_edges_begin(ui); aeit != g.out_edges_end(ui); aeit++) {
                     v = aeit->first;
                     if (C.find(v) != C.end() && get_no_neighs_in_set(v, g, U) == 0)
                         nb_new = nb_new + 1;
@@ -1170,7 +1191,7 @@ bool CDLib::My_Algorithm(const graph& g, id_type src, node_set& output) {
                     iter++;
                     C.erase(ui);
                     U.insert(ui);
-                    for (adjacent_edges_iterator aeit = g.out_edges_begin(ui); aeit != g.out_edges_end(ui); aeit++) {
+                    for (auto aeit = g.out_edges_begin(ui); aeit != g.out_edges_end(ui); aeit++) {
                         v = aeit->first;
                         if (U.find(v) != U.end() && get_no_neighs_in_set(v, g, C) == 0)
                             U.erase(v);
@@ -1220,11 +1241,12 @@ bool CDLib::My_Algorithm(const graph& g, id_type src, node_set& output) {
 
 //-----------------------------------------------------------------------------------------------------------------------------------------
 
-bool CDLib::CZR(const graph& g, id_type src, node_set& output) {
+template <typename G>
+bool CDLib::CZR(const G& g, id_type src, node_set& output) {
     //DISCOVERY PHASE
     node_set C, U;
     C.insert(src);
-    for (adjacent_edges_iterator aeit = g.out_edges_begin(src); aeit != g.out_edges_end(src); aeit++)
+    for (auto aeit = g.out_edges_begin(src); aeit != g.out_edges_end(src); aeit++)
         U.insert(aeit->first);
 
     double I = 0, E = g.get_node_out_degree(src), n = 1, nb = 1, L_in = 0, L_ex = E / nb, L = 0;
@@ -1254,7 +1276,7 @@ bool CDLib::CZR(const graph& g, id_type src, node_set& output) {
 
             if (y > 0)
                 nb_new = nb + 1;
-            for (adjacent_edges_iterator aeit = g.out_edges_begin(ni); aeit != g.out_edges_end(ni); aeit++) {
+            for (auto aeit = g.out_edges_begin(ni); aeit != g.out_edges_end(ni); aeit++) {
                 v = aeit->first;
                 //if(C.find(v)!=C.end() && get_no_neighs_in_set(v,g,U)==1)
                 if (C.find(v) != C.end() && (g.get_node_out_degree(v) - get_no_neighs_in_set(v, g, C)) == 1)
@@ -1292,7 +1314,7 @@ bool CDLib::CZR(const graph& g, id_type src, node_set& output) {
 
             if (y > 0)
                 nb_new = nb + 1;
-            for (adjacent_edges_iterator aeit = g.out_edges_begin(v_aggl); aeit != g.out_edges_end(v_aggl); aeit++) {
+            for (auto aeit = g.out_edges_begin(v_aggl); aeit != g.out_edges_end(v_aggl); aeit++) {
                 v = aeit->first;
                 //if(C.find(v)!=C.end() && get_no_neighs_in_set(v,g,U)==1)
                 if (C.find(v) != C.end() && (g.get_node_out_degree(v) - get_no_neighs_in_set(v, g, C)) == 1)
@@ -1308,7 +1330,7 @@ bool CDLib::CZR(const graph& g, id_type src, node_set& output) {
                 //cout<<"node agglomerated";
                 C.insert(v_aggl);
                 U.erase(v_aggl);
-                for (adjacent_edges_iterator aeit = g.out_edges_begin(v_aggl); aeit != g.out_edges_end(v_aggl); aeit++) {
+                for (auto aeit = g.out_edges_begin(v_aggl); aeit != g.out_edges_end(v_aggl); aeit++) {
                     v = aeit->first;
                     if (C.find(v) == C.end() && U.find(v) == U.end())
                         U.insert(v);
@@ -1342,7 +1364,7 @@ bool CDLib::CZR(const graph& g, id_type src, node_set& output) {
         if (y > 0)
             nb_new = nb - 1;
 
-        for (adjacent_edges_iterator aeit = g.out_edges_begin(ni); aeit != g.out_edges_end(ni); aeit++) {
+        for (auto aeit = g.out_edges_begin(ni); aeit != g.out_edges_end(ni); aeit++) {
             v = aeit->first;
             //if (C.find(v) != C.end() && get_no_neighs_in_set(v, g, U) == 0)
             if (C.find(v) != C.end() && (g.get_node_out_degree(v) - get_no_neighs_in_set(v, g, C)) == 0)
@@ -1358,7 +1380,7 @@ bool CDLib::CZR(const graph& g, id_type src, node_set& output) {
             //cout<<endl<<"node "<<g.get_node_label(ni)<<" deleted";
             C.erase(ni);
             U.insert(ni);
-            for (adjacent_edges_iterator aeit = g.out_edges_begin(ni); aeit != g.out_edges_end(ni); aeit++) {
+            for (auto aeit = g.out_edges_begin(ni); aeit != g.out_edges_end(ni); aeit++) {
                 v = aeit->first;
                 //if (U.find(v) != U.end() && get_no_neighs_in_set(v, g, C) == 0) //DEPENDENT ON U----CAUTION!!!!
                 if (C.find(v) == C.end() && get_no_neighs_in_set(v, g, C) == 0)
@@ -1392,11 +1414,12 @@ bool CDLib::CZR(const graph& g, id_type src, node_set& output) {
 
 //-----------------------------------------------------------------------------------------------------------------------------------------
 
-bool CDLib::CZR_Beta(const graph& g, id_type src, node_set& output) {
+template <typename G>
+bool CDLib::CZR_Beta(const G& g, id_type src, node_set& output) {
     //DISCOVERY PHASE
     node_set C, U;
     C.insert(src);
-    for (adjacent_edges_iterator aeit = g.out_edges_begin(src); aeit != g.out_edges_end(src); aeit++)
+    for (auto aeit = g.out_edges_begin(src); aeit != g.out_edges_end(src); aeit++)
         U.insert(aeit->first);
 
     double I = 0, E = g.get_node_out_degree(src), n = 1, nb = 1, L_in = 0, L_ex = E / nb, L = 0;
@@ -1426,7 +1449,7 @@ bool CDLib::CZR_Beta(const graph& g, id_type src, node_set& output) {
 
             if (y > 0)
                 nb_new = nb + 1;
-            for (adjacent_edges_iterator aeit = g.out_edges_begin(ni); aeit != g.out_edges_end(ni); aeit++) {
+            for (auto aeit = g.out_edges_begin(ni); aeit != g.out_edges_end(ni); aeit++) {
                 v = aeit->first;
                 //if(C.find(v)!=C.end() && get_no_neighs_in_set(v,g,U)==1)
                 if (C.find(v) != C.end() && (g.get_node_out_degree(v) - get_no_neighs_in_set(v, g, C)) == 1)
@@ -1464,7 +1487,7 @@ bool CDLib::CZR_Beta(const graph& g, id_type src, node_set& output) {
 
             if (y > 0)
                 nb_new = nb + 1;
-            for (adjacent_edges_iterator aeit = g.out_edges_begin(v_aggl); aeit != g.out_edges_end(v_aggl); aeit++) {
+            for (auto aeit = g.out_edges_begin(v_aggl); aeit != g.out_edges_end(v_aggl); aeit++) {
                 v = aeit->first;
                 //if(C.find(v)!=C.end() && get_no_neighs_in_set(v,g,U)==1)
                 if (C.find(v) != C.end() && (g.get_node_out_degree(v) - get_no_neighs_in_set(v, g, C)) == 1)
@@ -1480,7 +1503,7 @@ bool CDLib::CZR_Beta(const graph& g, id_type src, node_set& output) {
                 //cout<<"node agglomerated";
                 C.insert(v_aggl);
                 U.erase(v_aggl);
-                for (adjacent_edges_iterator aeit = g.out_edges_begin(v_aggl); aeit != g.out_edges_end(v_aggl); aeit++) {
+                for (auto aeit = g.out_edges_begin(v_aggl); aeit != g.out_edges_end(v_aggl); aeit++) {
                     v = aeit->first;
                     if (C.find(v) == C.end() && U.find(v) == U.end())
                         U.insert(v);
@@ -1493,7 +1516,7 @@ bool CDLib::CZR_Beta(const graph& g, id_type src, node_set& output) {
                 U.erase(v_aggl); //(DONE INTENTIONALLY----CAUTION!!!!)
                 //update E, nb, L_ex, L
                 E = E - x;
-                for (adjacent_edges_iterator aeit = g.out_edges_begin(v_aggl); aeit != g.out_edges_end(v_aggl); aeit++) {
+                for (auto aeit = g.out_edges_begin(v_aggl); aeit != g.out_edges_end(v_aggl); aeit++) {
                     v = aeit->first;
                     //if(C.find(v)!=C.end() && get_no_neighs_in_set(v,g,U)==1)
                     if (C.find(v) != C.end() && (g.get_node_out_degree(v) - get_no_neighs_in_set(v, g, C)) == 1)
@@ -1524,7 +1547,7 @@ bool CDLib::CZR_Beta(const graph& g, id_type src, node_set& output) {
         if (y > 0)
             nb_new = nb - 1;
 
-        for (adjacent_edges_iterator aeit = g.out_edges_begin(ni); aeit != g.out_edges_end(ni); aeit++) {
+        for (auto aeit = g.out_edges_begin(ni); aeit != g.out_edges_end(ni); aeit++) {
             v = aeit->first;
             //if (C.find(v) != C.end() && get_no_neighs_in_set(v, g, U) == 0)
             if (C.find(v) != C.end() && (g.get_node_out_degree(v) - get_no_neighs_in_set(v, g, C)) == 0)
@@ -1540,7 +1563,7 @@ bool CDLib::CZR_Beta(const graph& g, id_type src, node_set& output) {
             //cout<<endl<<"node "<<g.get_node_label(ni)<<" deleted";
             C.erase(ni);
             U.insert(ni);
-            for (adjacent_edges_iterator aeit = g.out_edges_begin(ni); aeit != g.out_edges_end(ni); aeit++) {
+            for (auto aeit = g.out_edges_begin(ni); aeit != g.out_edges_end(ni); aeit++) {
                 v = aeit->first;
                 //if (U.find(v) != U.end() && get_no_neighs_in_set(v, g, C) == 0) //DEPENDENT ON U----CAUTION!!!!
                 if (C.find(v) == C.end() && get_no_neighs_in_set(v, g, C) == 0)
@@ -1583,12 +1606,17 @@ struct edge_radicchi {
 };
 
 void CDLib::girvan_newman_2002(const graph& g, dendrogram& dendro) {
+    girvan_newman_2002(g, dendro, 0, 0);
+}
+
+void CDLib::girvan_newman_2002(const graph& g, dendrogram& dendro, id_type num_samples, unsigned long seed) {
     if (is_connected_weakly(g)) {
         graph gc(g);
         id_type component_counter = 1;
-        while (gc.get_num_edges()) {
+        for (unsigned long iteration = 0; gc.get_num_edges(); iteration++) {
+            //  A fresh seed every round, or the same sources would be sampled each time.
             vector<double> bc;
-            betweeness_centralities(gc, bc);
+            betweenness_centralities_sampled(gc, bc, num_samples, seed + iteration);
             double max_edge_bet = 0;
             id_type from_id = 0, to_id = 0;
             for (id_type i = 0; i < gc.get_num_nodes(); i++) {
@@ -1621,10 +1649,12 @@ void CDLib::radicchi_et_al_2004(const graph& g, dendrogram& dendro) {
     if (get_weakly_connected_components(g, components) == 1) {
         graph gc(g);
         vector<edge_radicchi> ec(g.get_num_edges(), edge_radicchi());
+        vector<double> coefficients;
+        edge_clustering_coefficients(gc, coefficients);
         id_type count = 0;
         for (id_type i = 0; i < gc.get_num_nodes(); i++)
-            for (adjacent_edges_iterator aeit = gc.out_edges_begin(i); aeit != gc.out_edges_end(i); aeit++)
-                ec[count++] = edge_radicchi(i, aeit->first, edge_clustering_coefficient(gc, i, aeit->first));
+            for (adjacent_edges_iterator aeit = gc.out_edges_begin(i); aeit != gc.out_edges_end(i); aeit++, count++)
+                ec[count] = edge_radicchi(i, aeit->first, coefficients[count]);
         sort(ec.begin(), ec.end(), ec_comp);
         for (id_type i = 0; i < ec.size(); i++) {
             gc.remove_edge(ec[i].from_id, ec[i].to_id);
@@ -1635,27 +1665,19 @@ void CDLib::radicchi_et_al_2004(const graph& g, dendrogram& dendro) {
     }
 }
 
-id_type CDLib::label_propagation_run(const graph&g, vector<id_type>& communities, id_type max_iters, lp_raghavan_2007* algoman) {
-    id_type num_iters = 0;
-    for (num_iters = 0; num_iters < max_iters; num_iters++)
-        if (algoman->do_iteration(g, num_iters)) break;
-    algoman->finalize(g, num_iters, communities);
-    return num_iters;
-}
-
 bool lp_raghavan_2007::is_node_lplabel_fixed(id_type node_id) const {
-    if (node_id > ids.size()) return false;
+    if (node_id > lplabels.size()) return false;
     else return (nodes_with_fixed_lplabels.find(node_id) != nodes_with_fixed_lplabels.end());
 }
 
 bool lp_raghavan_2007::fix_node_lplabel(id_type node_id) {
-    if (node_id > ids.size()) return false;
+    if (node_id > lplabels.size()) return false;
     nodes_with_fixed_lplabels.insert(node_id);
     return true;
 }
 
 bool lp_raghavan_2007::free_node_lplabel(id_type node_id) {
-    if (node_id > ids.size()) return false;
+    if (node_id > lplabels.size()) return false;
     nodes_with_fixed_lplabels.erase(node_id);
     return true;
 }
@@ -1677,82 +1699,35 @@ void lp_raghavan_2007::post_node_assign(const graph& g, id_type current, id_type
 void lp_raghavan_2007::post_iteration(const graph& g, id_type num_iters) {
 }
 
-lp_raghavan_2007::lp_raghavan_2007(const graph& g, bool synchronous_val) {
-    synchronous = synchronous_val;
-    ids.assign(g.get_num_nodes(), 0);
-    positions.assign(g.get_num_nodes(), 0);
-    lplabels.assign(g.get_num_nodes(), 0);
-    if (synchronous)lpnextlabels.assign(g.get_num_nodes(), 0);
-    for (id_type i = 0; i < g.get_num_nodes(); i++) {
-        ids[i] = i;
-        positions[i] = i;
-        lplabels[i] = i;
-        if (synchronous)lpnextlabels[i] = i;
-    }
+lp_raghavan_2007::lp_raghavan_2007(const graph& g, bool synchronous_val) : lp_engine<lp_virtual_policy>(g, synchronous_val, lp_virtual_policy(this)) {
 }
 
-void lp_raghavan_2007::finalize(const graph& g, id_type num_iters, vector<id_type>& communities) {
-    communities.assign(g.get_num_nodes(), 0);
-    copy(lplabels.begin(), lplabels.end(), communities.begin());
+bool lp_raghavan_2007::do_iteration(const graph& g, id_type num_iters) {
+    return lp_engine<lp_virtual_policy>::do_iteration(g, num_iters);
 }
 
-bool lf_comp(const pair<id_type, double>& lhs, const pair<id_type, double>& rhs) {
-    return lhs.second < rhs.second;
+void lp_raghavan_2007::finalize(const graph& g, id_type num_iters, vector<id_type>& communities) {
+    lp_engine<lp_virtual_policy>::finalize(g, num_iters, communities);
 }
 
-void lp_raghavan_2007::get_max_lplabels(const graph& g, id_type current_node, max_lplabel_container& max_labels) {
-    lplabel_fitness_container lplabel_fitness_values;
-    for (adjacent_edges_iterator aeit = g.in_edges_begin(current_node); aeit != g.in_edges_end(current_node); aeit++) {
-        double fitness_value = get_node_score(g, aeit->first) * get_label_fitness_for_edge(g, current_node, aeit->first, aeit->second);
-        pair < lplabel_fitness_container::iterator, bool> ret = lplabel_fitness_values.insert(make_pair(lplabels[aeit->first], fitness_value));
-        if (!ret.second) ret.first->second += fitness_value;
-    }
-    lplabel_fitness_container::iterator mit = max_element(lplabel_fitness_values.begin(), lplabel_fitness_values.end(), lf_comp);
-    double max_val = mit->second;
-    while (mit != lplabel_fitness_values.end() && mit->second == max_val) {
-        max_labels.push_back(mit->first);
-        lplabel_fitness_values.erase(mit->first);
-        mit = max_element(lplabel_fitness_values.begin(), lplabel_fitness_values.end(), lf_comp);
-    }
+bool lp_virtual_policy::local_fitness() const {
+    return algoman->has_local_fitness();
 }
 
-bool lp_raghavan_2007::check_lplabels(const graph& g) {
-    for (id_type i = 0; i < g.get_num_nodes(); i++) {
-        vector<id_type> max_labels;
-        get_max_lplabels(g, i, max_labels);
-        if (find(max_labels.begin(), max_labels.end(), lplabels[i]) == max_labels.end())
-            return false;
-    }
-    return true;
+double lp_virtual_policy::node_score(const graph& g, id_type node_id) const {
+    return algoman->get_node_score(g, node_id);
 }
 
-id_type lp_raghavan_2007::new_label_break_ties_randomly(const graph& g, id_type current_node, max_lplabel_container& max_labels) {
-    get_max_lplabels(g, current_node, max_labels);
-    if (max_labels.empty()) return lplabels[current_node];
-    CDLib::RandomGenerator<id_type> rnd_gen(0, max_labels.size() - 1);
-    return max_labels[rnd_gen.next()];
+double lp_virtual_policy::edge_fitness(const graph& g, id_type from_id, id_type to_id, double edge_weight) const {
+    return algoman->get_label_fitness_for_edge(g, from_id, to_id, edge_weight);
 }
 
-bool lp_raghavan_2007::do_iteration(const graph& g, id_type num_iters) {
-    for (vector<id_type>::iterator it = ids.begin(); it != ids.end(); it++) {
-        reorder(g, num_iters);
-        max_lplabel_container max_labels;
-        id_type new_label = new_label_break_ties_randomly(g, *it, max_labels);
-        post_node_assign(g, *it, new_label, num_iters, max_labels);
-        if (synchronous) lpnextlabels[*it] = new_label;
-        else lplabels[*it] = new_label;
-    }
-    if (synchronous)
-        for (id_type i = 0; i < g.get_num_nodes(); i++)
-            lplabels[i] = lpnextlabels[i];
-    post_iteration(g, num_iters);
-    return check_lplabels(g);
+void lp_virtual_policy::post_assign(const graph& g, const vector<id_type>& labels, id_type current, id_type new_label, id_type num_iters, max_lplabel_container& max_labels) {
+    algoman->post_node_assign(g, current, new_label, num_iters, max_labels);
 }
 
-void lp_raghavan_2007::reorder(const graph& g, id_type num_iters) {
-    random_shuffle(ids.begin(), ids.end());
-    for (vector<id_type>::iterator it = ids.begin(); it != ids.end(); it++)
-        positions[*it] = it - ids.begin();
+void lp_virtual_policy::post_iteration(const graph& g, id_type num_iters) {
+    algoman->post_iteration(g, num_iters);
 }
 
 void lp_offensive_lpa::post_node_assign(const graph& g, id_type current, id_type new_label, id_type num_iters, max_lplabel_container& max_labels) {
@@ -1806,32 +1781,68 @@ lp_defensive_lpa::lp_defensive_lpa(const graph& g, bool synchronous_val, double
 }
 
 id_type CDLib::label_propagation_raghavan_2007(const graph& g, vector<id_type>& labels, id_type max_iters, bool synchronous) {
-    lp_raghavan_2007 algoman(g, synchronous);
+    lp_engine<lp_raghavan_policy> algoman(g, synchronous, lp_raghavan_policy());
     return label_propagation_run(g, labels, max_iters, &algoman);
 }
 
 id_type CDLib::label_propagation_leung_2009(const graph& g, vector<id_type>& labels, id_type max_iters, bool synchronous, double hop_att) {
-    lp_leung_2009 algoman(g, synchronous, hop_att);
+    lp_engine<lp_leung_policy> algoman(g, synchronous, lp_leung_policy(g, hop_att));
     return label_propagation_run(g, labels, max_iters, &algoman);
 }
 
 id_type CDLib::label_propagation_dyn_hop_2010(const graph& g, vector<id_type>& labels, id_type max_iters, bool synchronous, double hop_att_max) {
-    lp_dyn_hop_att algoman(g, synchronous, hop_att_max);
+    lp_engine<lp_dyn_hop_policy> algoman(g, synchronous, lp_dyn_hop_policy(g, hop_att_max));
     return label_propagation_run(g, labels, max_iters, &algoman);
 }
 
 id_type CDLib::label_propagation_olpa_2010(const graph& g, vector<id_type>& labels, id_type max_iters, bool synchronous, double hop_att_max) {
-    lp_offensive_lpa algoman(g, synchronous, hop_att_max);
+    lp_engine<lp_offensive_policy> algoman(g, synchronous, lp_offensive_policy(g, hop_att_max));
     return label_propagation_run(g, labels, max_iters, &algoman);
 }
 
 id_type CDLib::label_propagation_dlpa_2010(const graph& g, vector<id_type>& labels, id_type max_iters, bool synchronous, double hop_att_max) {
-    lp_defensive_lpa algoman(g, synchronous, hop_att_max);
+    lp_engine<lp_defensive_policy> algoman(g, synchronous, lp_defensive_policy(g, hop_att_max));
     return label_propagation_run(g, labels, max_iters, &algoman);
 }
 
 id_type CDLib::label_propagation_track_changes_2012(const graph& g, vector<id_type>& labels, id_type max_iters, bool synchronous) {
-    lp_track_changes algoman(g, synchronous);
+    lp_engine<lp_track_changes_policy> algoman(g, synchronous, lp_track_changes_policy(g));
+    return label_propagation_run(g, labels, max_iters, &algoman);
+}
+
+id_type CDLib::label_propagation_raghavan_2007(const graph& g, vector<id_type>& labels, id_type max_iters, bool synchronous, unsigned long seed) {
+    lp_engine<lp_raghavan_policy> algoman(g, synchronous, lp_raghavan_policy());
+    algoman.set_parallel(seed);
+    return label_propagation_run(g, labels, max_iters, &algoman);
+}
+
+id_type CDLib::label_propagation_leung_2009(const graph& g, vector<id_type>& labels, id_type max_iters, bool synchronous, double hop_att, unsigned long seed) {
+    lp_engine<lp_leung_policy> algoman(g, synchronous, lp_leung_policy(g, hop_att));
+    algoman.set_parallel(seed);
+    return label_propagation_run(g, labels, max_iters, &algoman);
+}
+
+id_type CDLib::label_propagation_dyn_hop_2010(const graph& g, vector<id_type>& labels, id_type max_iters, bool synchronous, double hop_att_max, unsigned long seed) {
+    lp_engine<lp_dyn_hop_policy> algoman(g, synchronous, lp_dyn_hop_policy(g, hop_att_max));
+    algoman.set_parallel(seed);
+    return label_propagation_run(g, labels, max_iters, &algoman);
+}
+
+id_type CDLib::label_propagation_olpa_2010(const graph& g, vector<id_type>& labels, id_type max_iters, bool synchronous, double hop_att_max, unsigned long seed) {
+    lp_engine<lp_offensive_policy> algoman(g, synchronous, lp_offensive_policy(g, hop_att_max));
+    algoman.set_parallel(seed);
+    return label_propagation_run(g, labels, max_iters, &algoman);
+}
+
+id_type CDLib::label_propagation_dlpa_2010(const graph& g, vector<id_type>& labels, id_type max_iters, bool synchronous, double hop_att_max, unsigned long seed) {
+    lp_engine<lp_defensive_policy> algoman(g, synchronous, lp_defensive_policy(g, hop_att_max));
+    algoman.set_parallel(seed);
+    return label_propagation_run(g, labels, max_iters, &algoman);
+}
+
+id_type CDLib::label_propagation_track_changes_2012(const graph& g, vector<id_type>& labels, id_type max_iters, bool synchronous, unsigned long seed) {
+    lp_engine<lp_track_changes_policy> algoman(g, synchronous, lp_track_changes_policy(g));
+    algoman.set_parallel(seed);
     return label_propagation_run(g, labels, max_iters, &algoman);
 }
 
@@ -1981,6 +1992,166 @@ void CDLib::new_evolutionary_label_propagation_edgelists(const string& snapshot_
     }
 }
 
+lp_snapshot_stream::lp_snapshot_stream(bool directed, bool weighted, double alpha, id_type window_size_val) :
+g(directed, weighted),
+engine(g, false, lp_history_policy(g, alpha)),
+window_size((window_size_val) ? window_size_val : 1),
+num_changed(0) {
+}
+
+const graph& lp_snapshot_stream::get_graph() const {
+    return g;
+}
+
+const vector<id_type>& lp_snapshot_stream::get_lplabels() const {
+    return engine.get_lplabels();
+}
+
+id_type lp_snapshot_stream::get_num_touched() const {
+    return touched.size();
+}
+
+id_type lp_snapshot_stream::get_num_changed() const {
+    return num_changed;
+}
+
+void lp_snapshot_stream::set_parallel(unsigned long seed) {
+    engine.set_parallel(seed);
+}
+
+void lp_snapshot_stream::touch(id_type node) {
+    if (node >= seen.size()) seen.resize(g.get_num_nodes(), 0);
+    if (seen[node]) return;
+    seen[node] = 1;
+    touched.push_back(node);
+}
+
+bool lp_snapshot_stream::insert_edge(const string& from_label, const string& to_label, wt_t weight) {
+    g.add_node(from_label);
+    g.add_node(to_label);
+    id_type from_id = g.get_node_id(from_label), to_id = g.get_node_id(to_label);
+    bool changed = (g.get_edge_weight(from_id, to_id)) ? g.set_edge_weight(from_id, to_id, weight) : g.add_edge(from_id, to_id, weight);
+    if (!changed) return false;
+    touch(from_id);
+    touch(to_id);
+    return true;
+}
+
+bool lp_snapshot_stream::remove_edge(const string& from_label, const string& to_label) {
+    id_type from_id = g.get_node_id(from_label), to_id = g.get_node_id(to_label);
+    if (from_id >= g.get_num_nodes() || to_id >= g.get_num_nodes() || !g.remove_edge(from_id, to_id)) return false;
+    touch(from_id);
+    touch(to_id);
+    return true;
+}
+
+bool lp_snapshot_stream::read_delta(const string& filepath) {
+    ifstream ifs(filepath.c_str());
+    if (!ifs.is_open()) return false;
+    string line;
+    while (getline(ifs, line)) {
+        istringstream iss(line);
+        string op, from_label, to_label;
+        wt_t weight = 1;
+        if (!(iss >> op >> from_label >> to_label) || op[0] == '#' || op[0] == '%') continue;
+        if (op == "+") {
+            iss >> weight;
+            insert_edge(from_label, to_label, weight);
+        } else if (op == "-") remove_edge(from_label, to_label);
+    }
+    return true;
+}
+
+void lp_snapshot_stream::record_snapshot(vector<id_type>& restabilized) {
+    //  Pushes the nodes whose label differs from before the snapshot into the window and
+    //  drops the oldest snapshot once the window is full, updating the stability of the
+    //  nodes in both. restabilized receives those whose stability actually changed.
+    lp_history_policy& policy = engine.get_policy();
+    const vector<id_type>& labels = engine.get_lplabels();
+    window.push_back(vector<id_type > ());
+    for (id_type i = 0; i < touched.size(); i++)
+        if (labels_before[i] != labels[touched[i]]) window.back().push_back(touched[i]);
+    num_changed = window.back().size();
+    window_changes.resize(g.get_num_nodes(), 0);
+    policy.stability.resize(g.get_num_nodes(), 1);
+    for (id_type i = 0; i < window.back().size(); i++) window_changes[window.back()[i]]++;
+    vector<id_type> updated(window.back());
+    if (window.size() > window_size) {
+        for (id_type i = 0; i < window.front().size(); i++) window_changes[window.front()[i]]--;
+        updated.insert(updated.end(), window.front().begin(), window.front().end());
+        window.pop_front();
+    }
+    restabilized.clear();
+    for (id_type i = 0; i < updated.size(); i++) {
+        double stability = 1 - (double) window_changes[updated[i]] / (double) window_size;
+        if (stability != policy.stability[updated[i]]) restabilized.push_back(updated[i]);
+        policy.stability[updated[i]] = stability;
+    }
+}
+
+id_type lp_snapshot_stream::propagate(id_type max_iters) {
+    //  touched then gathers the nodes of every sweep with their labels before the snapshot,
+    //  the only ones whose labels may have changed.
+    seen.resize(g.get_num_nodes(), 0);
+    engine.get_policy().stability.resize(g.get_num_nodes(), 1);
+    engine.resume(g, touched);
+    for (id_type i = 0; i < touched.size(); i++) seen[touched[i]] = 0;
+    touched.clear();
+    labels_before.clear();
+    const vector<id_type>& labels = engine.get_lplabels();
+    id_type num_iters = 0;
+    for (num_iters = 0; num_iters < max_iters; num_iters++) {
+        const vector<id_type>& frontier = engine.get_frontier();
+        for (id_type i = 0; i < frontier.size(); i++) {
+            if (!seen[frontier[i]]) {
+                seen[frontier[i]] = 1;
+                touched.push_back(frontier[i]);
+                labels_before.push_back(labels[frontier[i]]);
+            }
+        }
+        if (engine.do_iteration(g, num_iters)) break;
+    }
+    vector<id_type> restabilized;
+    record_snapshot(restabilized);
+    for (id_type i = 0; i < touched.size(); i++) seen[touched[i]] = 0;
+    touched.clear();
+    //  The stability of a node weighs the edges to its out-neighbors, which start the next
+    //  snapshot touched so that they see the new weights.
+    for (id_type i = 0; i < restabilized.size(); i++)
+        for (adjacent_edges_iterator aeit = g.out_edges_begin(restabilized[i]); aeit != g.out_edges_end(restabilized[i]); aeit++)
+            touch(aeit->first);
+    return num_iters;
+}
+
+double CDLib::evolutionary_label_propagation_deltas(const string& delta_list_filepath, bool directed, bool weighted, double alpha, id_type window_size, vector<id_type>& labels, lp_stream_output& output) {
+    if (!window_size) return 0;
+    ifstream ifs(delta_list_filepath.c_str());
+    timer_rt op_timer;
+    if (!ifs.is_open()) return 0;
+    lp_snapshot_stream stream(directed, weighted, alpha, window_size);
+    string filepath;
+    for (id_type snapshot = 0; ifs >> filepath; snapshot++) {
+        if (!snapshot) {
+            graph first(directed, weighted);
+            if (!read_edgelist(first, filepath)) return op_timer.total_time();
+            for (id_type i = 0; i < first.get_num_nodes(); i++)
+                for (adjacent_edges_iterator aeit = first.out_edges_begin(i); aeit != first.out_edges_end(i); aeit++)
+                    stream.insert_edge(first.get_node_label(i), first.get_node_label(aeit->first), aeit->second);
+        } else if (!stream.read_delta(filepath)) continue;
+        output.num_touched.push_back(stream.get_num_touched());
+        op_timer.start_clock();
+        output.lp_iters.push_back(stream.propagate(10000));
+        op_timer.stop_clock();
+        output.lp_times.push_back(op_timer.run_time());
+        output.num_changed.push_back(stream.get_num_changed());
+    }
+    labels.assign(stream.get_lplabels().begin(), stream.get_lplabels().end());
+    return op_timer.total_time();
+}
+
+//  Local moving stops after a round that improves the objective by less than this.
+const double bgll_min_improvement = 1e-6;
+
 id_type bgll_find_best_community_for_node(const graph& curr_graph, const vector<id_type>& labels, const bgll_objective& book, id_type vertex) {
     double max_node_gain = -numeric_limits<double>::infinity();
     id_type node_max_gain_comm_index = labels[vertex];
@@ -1996,65 +2167,265 @@ id_type bgll_find_best_community_for_node(const graph& curr_graph, const vector<
     return node_max_gain_comm_index;
 }
 
-id_type bgll_vertex_mover_single_pass(const graph& curr_graph, vector<id_type>& labels, bgll_objective& book) {
-    id_type num_nodes_moved = 0;
-    for (id_type i = 0; i < curr_graph.get_num_nodes(); i++) {
-        book.detach_node(curr_graph, labels, i); //Detach node from its community
-        id_type new_node_community = bgll_find_best_community_for_node(curr_graph, labels, book, i);
-        if (new_node_community != labels[i]) {
-            num_nodes_moved++;
-            //Insert node into new community
-            book.attach_node(curr_graph, labels, i, new_node_community);
-            labels[i] = new_node_community;
+void bgll_next_active(const graph& curr_graph, const vector<id_type>& moved, vector<char>& queued, vector<id_type>& active) {
+    //  The vertices to examine in the next round: those that moved and their neighbors.
+    active.clear();
+    for (id_type i = 0; i < moved.size(); i++) {
+        if (!queued[moved[i]]) {
+            queued[moved[i]] = 1;
+            active.push_back(moved[i]);
         }
+        for (adjacent_edges_iterator aeit = curr_graph.out_edges_begin(moved[i]); aeit != curr_graph.out_edges_end(moved[i]); aeit++) {
+            if (!queued[aeit->first]) {
+                queued[aeit->first] = 1;
+                active.push_back(aeit->first);
+            }
+        }
+        if (curr_graph.is_directed())
+            for (adjacent_edges_iterator aeit = curr_graph.in_edges_begin(moved[i]); aeit != curr_graph.in_edges_end(moved[i]); aeit++) {
+                if (!queued[aeit->first]) {
+                    queued[aeit->first] = 1;
+                    active.push_back(aeit->first);
+                }
+            }
     }
-    return num_nodes_moved;
+    for (id_type i = 0; i < active.size(); i++) queued[active[i]] = 0;
+}
+
+double bgll_sequential_vertex_mover(const graph& g, vector<id_type>& labels, bgll_objective& book) {
+    //  Passes over the active vertices, all of them at first, with one vertex moved at a
+    //  time. The moves of a pass are logged so that a pass which lowers the objective is
+    //  undone move by move, newest first.
+    vector<id_type> active(g.get_num_nodes()), moved;
+    vector<id_type> old_comms;
+    vector<char> queued(g.get_num_nodes(), 0);
+    for (id_type i = 0; i < active.size(); i++) active[i] = i;
+    double curr_objval = book.objval(g, labels);
+    while (!active.empty()) {
+        moved.clear();
+        old_comms.clear();
+        for (id_type j = 0; j < active.size(); j++) {
+            id_type i = active[j];
+            book.detach_node(g, labels, i); //Detach node from its community
+            id_type new_node_community = bgll_find_best_community_for_node(g, labels, book, i);
+            //Insert node into new community, or back into its own
+            book.attach_node(g, labels, i, new_node_community);
+            if (new_node_community != labels[i]) {
+                moved.push_back(i);
+                old_comms.push_back(labels[i]);
+                labels[i] = new_node_community;
+            }
+        }
+        if (moved.empty()) break;
+        double next_objval = book.objval(g, labels);
+        if (next_objval < curr_objval) {
+            for (id_type j = moved.size(); j-- > 0;) {
+                book.detach_node(g, labels, moved[j]);
+                book.attach_node(g, labels, moved[j], old_comms[j]);
+                labels[moved[j]] = old_comms[j];
+            }
+            break;
+        }
+        bool converged = (next_objval - curr_objval < bgll_min_improvement);
+        curr_objval = next_objval;
+        if (converged) break;
+        bgll_next_active(g, moved, queued, active);
+    }
+    return curr_objval;
 }
 
-double CDLib::bgll_vertex_mover_optimizer(const graph& g, vector<id_type>& labels, bgll_objective& book) {
-    double start_obj_val = book.objval(g, labels), curr_objval = -numeric_limits<double>::infinity();
-    id_type num_nodes_moved = 0;
-    do {
-        vector<id_type> temp_comms(labels);
-        num_nodes_moved += bgll_vertex_mover_single_pass(g, temp_comms, book);
-        curr_objval = book.objval(g, temp_comms);
-        //Rollback communities and exit if modularity decreases
-        if (curr_objval < start_obj_val) return start_obj_val;
-        //Commit changes, book should have already been updated
-        copy(temp_comms.begin(), temp_comms.end(), labels.begin());
-    } while (num_nodes_moved && curr_objval < start_obj_val);
-    return curr_objval;
+struct bgll_scratch {
+    //  Weights from one vertex to its neighboring communities. marks holds the vertex that
+    //  touched an entry of link and is put back to absent for the entries in linked once
+    //  that vertex is done, so a thread reusing the scratch in a later round, even for the
+    //  same vertex, never reads a weight it did not add itself.
+    vector<double> link;
+    vector<id_type> marks;
+    vector<id_type> linked;
+    id_type absent;
+
+    bgll_scratch(id_type num_comms) : link(num_comms, 0), marks(num_comms, num_comms), absent(num_comms) {
+    }
+};
+
+void bgll_best_moves(const graph& curr_graph, const csr_arrays& adj, const vector<id_type>& active, const vector<id_type>& labels, const vector<id_type>& sizes, const bgll_objective& book, vector<bgll_scratch>& scratch, vector<id_type>& next) {
+    //  Every active vertex picks the best of its own community and those of its neighbors,
+    //  all read as they were at the end of the last round, so the vertices are independent.
+    //  Two singletons that would join each other only move to the smaller id, which keeps
+    //  them from swapping forever.
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel for schedule(dynamic,256) shared(curr_graph,adj,active,labels,sizes,book,scratch,next)
+#endif
+    for (id_type j = 0; j < active.size(); j++) {
+#ifdef ENABLE_MULTITHREADING
+        bgll_scratch& ws = scratch[omp_get_thread_num()];
+#else
+        bgll_scratch& ws = scratch[0];
+#endif
+        id_type i = active[j], src = labels[i], best = src;
+        ws.linked.clear();
+        for (id_type k = adj.out_offsets[i]; k < adj.out_offsets[i + 1]; k++) {
+            id_type comm = labels[adj.out_neighbors[k]];
+            if (adj.out_neighbors[k] == i) continue;
+            if (ws.marks[comm] != i) {
+                ws.marks[comm] = i;
+                ws.link[comm] = 0;
+                ws.linked.push_back(comm);
+            }
+            ws.link[comm] += (adj.out_weights) ? adj.out_weights[k] : 1;
+        }
+        double best_gain = book.move_gain(curr_graph, i, src, src, (ws.marks[src] == i) ? ws.link[src] : 0);
+        for (id_type l = 0; l < ws.linked.size(); l++) {
+            id_type comm = ws.linked[l];
+            if (comm == src) continue;
+            double gain = book.move_gain(curr_graph, i, src, comm, ws.link[comm]);
+            if (gain > best_gain || (gain == best_gain && best != src && comm < best)) {
+                best_gain = gain;
+                best = comm;
+            }
+        }
+        if (best > src && sizes[src] == 1 && sizes[best] == 1) best = src;
+        next[i] = best;
+        for (id_type l = 0; l < ws.linked.size(); l++) ws.marks[ws.linked[l]] = ws.absent;
+    }
 }
 
-void bgll_recover_communities(vector<id_type>& labels, vector< vector<id_type> >& hier_comms) {
-    vector<node_set> last_comms;
-    convert_labels_to_communities(hier_comms[hier_comms.size() - 1], last_comms);
-    reindex_communities(labels);
-    hier_comms.push_back(vector<id_type > (hier_comms[hier_comms.size() - 1].size(), 0));
+void bgll_apply_moves(const graph& curr_graph, bgll_objective& book, const vector<id_type>& moved, const vector<id_type>& from, const vector<id_type>& to, vector<id_type>& sizes) {
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel for shared(curr_graph,book,moved,from,to,sizes)
+#endif
+    for (id_type j = 0; j < moved.size(); j++) {
+        id_type i = moved[j];
+        book.move_node(curr_graph, from, to, i);
+#ifdef ENABLE_MULTITHREADING
+#pragma omp atomic
+#endif
+        sizes[from[i]]--;
+#ifdef ENABLE_MULTITHREADING
+#pragma omp atomic
+#endif
+        sizes[to[i]]++;
+    }
+}
+
+double bgll_parallel_vertex_mover(const graph& g, vector<id_type>& labels, bgll_objective& book) {
+    //  Synchronous rounds of bgll_best_moves over the active vertices, all of them at first
+    //  and then those next to a move of the last round, until a round moves nothing or
+    //  gains less than bgll_min_improvement; a round that lowers the objective is undone.
+    //  labels and next agree outside of a round, so a round costs the volume of its active
+    //  vertices rather than the size of the graph.
+    CSR adj(g);
+    vector<id_type> sizes(g.get_num_nodes(), 0), next(labels), active(g.get_num_nodes()), moved;
+    vector<char> queued(g.get_num_nodes(), 0);
     for (id_type i = 0; i < labels.size(); i++) {
-        for (node_set::iterator nit = last_comms[i].begin(); nit != last_comms[i].end(); nit++) {
-            hier_comms[hier_comms.size() - 1][*nit] = labels[i];
+        sizes[labels[i]]++;
+        active[i] = i;
+    }
+#ifdef ENABLE_MULTITHREADING
+    vector<bgll_scratch> scratch(omp_get_max_threads(), bgll_scratch(g.get_num_nodes()));
+#else
+    vector<bgll_scratch> scratch(1, bgll_scratch(g.get_num_nodes()));
+#endif
+    double curr_objval = book.objval(g, labels);
+    while (!active.empty()) {
+        bgll_best_moves(g, adj.arrays(), active, labels, sizes, book, scratch, next);
+        moved.clear();
+        for (id_type j = 0; j < active.size(); j++)
+            if (next[active[j]] != labels[active[j]]) moved.push_back(active[j]);
+        if (moved.empty()) break;
+        bgll_apply_moves(g, book, moved, labels, next, sizes);
+        double next_objval = book.objval(g, next);
+        if (next_objval < curr_objval) {
+            bgll_apply_moves(g, book, moved, next, labels, sizes);
+            for (id_type j = 0; j < moved.size(); j++) next[moved[j]] = labels[moved[j]];
+            break;
         }
+        for (id_type j = 0; j < moved.size(); j++) labels[moved[j]] = next[moved[j]];
+        bool converged = (next_objval - curr_objval < bgll_min_improvement);
+        curr_objval = next_objval;
+        if (converged) break;
+        bgll_next_active(g, moved, queued, active);
     }
+    return curr_objval;
+}
+
+double CDLib::bgll_vertex_mover_optimizer(const graph& g, vector<id_type>& labels, bgll_objective& book) {
+    if (book.parallel_moves()) return bgll_parallel_vertex_mover(g, labels, book);
+    return bgll_sequential_vertex_mover(g, labels, book);
+}
+
+void bgll_recover_communities(vector<id_type>& labels, vector< vector<id_type> >& hier_comms) {
+    //  Node i of the current graph is the i-th community of the last level in order of
+    //  first appearance, which is also how the labels are reindexed.
+    vector<id_type> last_comms;
+    reindex_communities(hier_comms[hier_comms.size() - 1], last_comms);
+    reindex_communities(labels);
+    hier_comms.push_back(vector<id_type > (last_comms.size(), 0));
+    vector<id_type>& next_comms = hier_comms[hier_comms.size() - 1];
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel for shared(labels,last_comms,next_comms)
+#endif
+    for (id_type i = 0; i < last_comms.size(); i++)
+        next_comms[i] = labels[last_comms[i]];
 }
 
 void bgll_collapse_nodes(graph& orig_graph, vector<id_type>& labels) {
-    vector<unordered_map<id_type, double> > edges;
-    for (id_type i = 0; i < labels.size(); i++)
-        while (edges.size() <= labels[i]) edges.push_back(unordered_map<id_type, double>());
-    for (id_type i = 0; i < orig_graph.get_num_nodes(); i++) {
-        id_type node_comm = labels[i];
-        for (adjacent_edges_iterator aeit = orig_graph.out_edges_begin(i); aeit != orig_graph.out_edges_end(i); aeit++) {
-            id_type neigh_comm = labels[aeit->first];
-            pair < unordered_map<id_type, double>::iterator, bool> ret = edges[node_comm].insert(make_pair(neigh_comm, 0));
-            ret.first->second += aeit->second;
+    //  Builds the graph of the communities as a CSR and assigns it: the members of every
+    //  community are grouped by a counting sort, and the arcs leaving them are summed by
+    //  target community in a dense per-thread array, one community per loop iteration.
+    id_type num_comms = (labels.empty()) ? 0 : *max_element(labels.begin(), labels.end()) + 1;
+    vector<id_type> offsets(num_comms + 1, 0), members(labels.size(), 0);
+    for (id_type i = 0; i < labels.size(); i++) offsets[labels[i] + 1]++;
+    for (id_type i = 0; i < num_comms; i++) offsets[i + 1] += offsets[i];
+    vector<id_type> cursor(offsets.begin(), offsets.end() - 1);
+    for (id_type i = 0; i < labels.size(); i++) members[cursor[labels[i]]++] = i;
+    vector< vector< pair<id_type, double> > > rows(num_comms);
+    bool directed = orig_graph.is_directed();
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel shared(orig_graph,labels,offsets,members,rows)
+#endif
+    {
+        vector<double> sums(num_comms, 0);
+        vector<id_type> marks(num_comms, num_comms), linked;
+#ifdef ENABLE_MULTITHREADING
+#pragma omp for schedule(dynamic,64)
+#endif
+        for (id_type c = 0; c < num_comms; c++) {
+            linked.clear();
+            for (id_type j = offsets[c]; j < offsets[c + 1]; j++) {
+                for (adjacent_edges_iterator aeit = orig_graph.out_edges_begin(members[j]); aeit != orig_graph.out_edges_end(members[j]); aeit++) {
+                    id_type neigh_comm = labels[aeit->first];
+                    if (!directed && neigh_comm < c) continue;
+                    if (marks[neigh_comm] != c) {
+                        marks[neigh_comm] = c;
+                        sums[neigh_comm] = 0;
+                        linked.push_back(neigh_comm);
+                    }
+                    sums[neigh_comm] += aeit->second;
+                }
+            }
+            for (id_type j = 0; j < linked.size(); j++) rows[c].push_back(make_pair(linked[j], sums[linked[j]]));
+        }
+    }
+    vector<id_type> first(num_comms + 1, 0);
+    for (id_type c = 0; c < num_comms; c++) first[c + 1] = first[c] + rows[c].size();
+    vector<id_type> from(first[num_comms]), to(first[num_comms]);
+    vector<wt_t> weights(first[num_comms]);
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel for shared(rows,first,from,to,weights)
+#endif
+    for (id_type c = 0; c < num_comms; c++) {
+        for (id_type j = 0; j < rows[c].size(); j++) {
+            from[first[c] + j] = c;
+            to[first[c] + j] = rows[c][j].first;
+            weights[first[c] + j] = rows[c][j].second;
         }
     }
-    orig_graph.clear();
-    for (id_type i = 0; i < edges.size(); i++) orig_graph.add_node();
-    for (id_type i = 0; i < edges.size(); i++)
-        for (unordered_map<id_type, double>::iterator it = edges[i].begin(); it != edges[i].end(); it++)
-            orig_graph.add_edge(i, it->first, it->second);
+    //  Undirected graphs keep only the arcs to communities of larger ids above; the CSR
+    //  mirrors them.
+    CSR collapsed;
+    collapsed.populate_from_edges(directed, true, num_comms, from, to, weights);
+    orig_graph.assign(collapsed);
     labels.assign(orig_graph.get_num_nodes(), 0);
     for (id_type i = 0; i < orig_graph.get_num_nodes(); i++)
         labels[i] = i;
@@ -2067,9 +2438,12 @@ void CDLib::cda_bgll_generic(const graph&g, const vector<id_type>& init_comms, v
     if (init_comms.size() == g.get_num_nodes()) copy(init_comms.begin(), init_comms.end(), curr_comms.begin());
     else for (id_type i = 0; i < g.get_num_nodes(); i++) curr_comms[i] = i;
     hier_comms.push_back(curr_comms);
+    //The books index their arrays by community
+    reindex_communities(curr_comms);
     //Create a copy of the graph
     graph curr_graph(g);
     curr_graph.convert_to_weighted();
+    book.init(g, hier_comms, curr_graph, curr_comms);
     double orig_obj_val = book.objval(curr_graph, curr_comms);
     //The Main Loop
     while (1) {
@@ -2087,54 +2461,109 @@ void CDLib::cda_bgll_generic(const graph&g, const vector<id_type>& init_comms, v
 }
 
 class bgll_modularity : public bgll_objective_w_internal {
+    //  Keeps the sum of the internal weights and the sum of the squared community totals
+    //  up to date through every kind of move, so objval takes constant time. Parallel moves
+    //  update both with atomics: capturing the total a move replaces makes the squares
+    //  telescope to the right sum whatever the order of the moves.
+    //  graph_weight is the total weight of the original graph: a collapsed graph counts
+    //  the weight of its self loops once more in get_total_weight, which would change the
+    //  modularity of the same partition from one level to the next.
 private:
-    unordered_map<id_type, double> total_weight;
+    vector<double> total_weight;
+    double graph_weight;
+    double inside;
+    double spread;
+
+    inline void add_to_total(id_type comm, double weight) {
+        double before;
+#ifdef ENABLE_MULTITHREADING
+#pragma omp atomic capture
+#endif
+        {
+            before = total_weight[comm];
+            total_weight[comm] += weight;
+        }
+        double change = (before + weight) * (before + weight) - before * before;
+#ifdef ENABLE_MULTITHREADING
+#pragma omp atomic
+#endif
+        spread += change;
+    }
 public:
 
-    bgll_modularity() : bgll_objective_w_internal() {
+    bgll_modularity() : bgll_objective_w_internal(), graph_weight(0), inside(0), spread(0) {
     }
 
-    bgll_modularity(double resolution_p) : bgll_objective_w_internal(resolution_p) {
+    bgll_modularity(double resolution_p) : bgll_objective_w_internal(resolution_p), graph_weight(0), inside(0), spread(0) {
     }
 
     void init(const graph& orig_graph, const vector<vector<id_type> >& hiercomms, const graph& curr_graph, const vector<id_type>& curr_comms) {
-        init_internal_params();
-        total_weight.clear();
+        init_internal_params(curr_graph.get_num_nodes());
+        total_weight.assign(curr_graph.get_num_nodes(), 0);
+        graph_weight = orig_graph.get_total_weight();
         for (id_type i = 0; i < curr_graph.get_num_nodes(); i++) {
             fill_internal_edges_for_vertex(curr_graph, curr_comms, i);
-            map_insert_and_increment<id_type, double>(total_weight, curr_comms[i], curr_graph.get_node_out_weight(i));
+            total_weight[curr_comms[i]] += curr_graph.get_node_out_weight(i);
         }
+        inside = accumulate(internal_weight.begin(), internal_weight.end(), 0.0);
+        spread = 0;
+        for (id_type i = 0; i < total_weight.size(); i++) spread += total_weight[i] * total_weight[i];
     }
 
     void detach_node(const graph& curr_graph, const vector<id_type>& labels, id_type vertex) {
-        update_internal_edges_on_vertex_detach(curr_graph, labels, vertex);
-        map_find_and_modify<id_type, double>(total_weight, labels[vertex], -curr_graph.get_node_out_weight(vertex));
+        inside -= update_internal_edges_on_vertex_detach(curr_graph, labels, vertex);
+        add_to_total(labels[vertex], -curr_graph.get_node_out_weight(vertex));
     }
 
     void attach_node(const graph& curr_graph, const vector<id_type>& labels, id_type vertex, id_type dst_comm) {
-        if (labels[vertex] != dst_comm) {
-            update_internal_edges_on_vertex_attach(dst_comm);
-            map_find_and_modify<id_type, double>(total_weight, dst_comm, curr_graph.get_node_out_weight(vertex));
-        }
+        inside += update_internal_edges_on_vertex_attach(labels[vertex], dst_comm);
+        add_to_total(dst_comm, curr_graph.get_node_out_weight(vertex));
     }
 
     double objval(const graph& curr_graph, const vector<id_type>& curr_comms) const {
-        double modularity = 0;
-        for (unordered_map<id_type, double>::const_iterator it = total_weight.begin(); it != total_weight.end(); it++) {
-            modularity += objval_internal_term_running(curr_graph, it->first);
-            modularity -= (pow(it->second / (2 * curr_graph.get_total_weight()), 2));
-        }
-        return modularity;
+        return ((resolution_param * inside) / (2 * graph_weight)) - (spread / (4 * graph_weight * graph_weight));
     }
 
     double compute_gain(const graph& curr_graph, const vector<id_type>& labels, id_type vertex, id_type dst_comm) const {
         double gain = 0;
         gain += gain_internal_term(dst_comm);
-        unordered_map<id_type, double>::const_iterator it = total_weight.find(dst_comm);
-        if (it != total_weight.end()) gain -= ((curr_graph.get_node_out_weight(vertex) * it->second) / curr_graph.get_total_weight());
+        gain -= ((curr_graph.get_node_out_weight(vertex) * total_weight[dst_comm]) / graph_weight);
         return gain;
     }
 
+    bool parallel_moves() const {
+        return true;
+    }
+
+    double move_gain(const graph& curr_graph, id_type vertex, id_type src_comm, id_type dst_comm, double link_weight) const {
+        double node_weight = curr_graph.get_node_out_weight(vertex), dst_weight = total_weight[dst_comm];
+        if (dst_comm == src_comm) dst_weight -= node_weight;
+        return (resolution_param * 2 * link_weight) - ((node_weight * dst_weight) / graph_weight);
+    }
+
+    void move_node(const graph& curr_graph, const vector<id_type>& labels, const vector<id_type>& next_labels, id_type vertex) {
+        //  An arc changes the internal weight when either end moves. The arcs to neighbors
+        //  that stay are counted here in both directions; of those between two moving
+        //  vertices each end counts its out-arc.
+        id_type src_comm = labels[vertex], dst_comm = next_labels[vertex];
+        double change = 0;
+        for (adjacent_edges_iterator aeit = curr_graph.out_edges_begin(vertex); aeit != curr_graph.out_edges_end(vertex); aeit++) {
+            if (aeit->first == vertex) continue;
+            double arcs = (labels[aeit->first] != next_labels[aeit->first] || curr_graph.is_directed()) ? 1 : 2;
+            change += arcs * aeit->second * ((next_labels[aeit->first] == dst_comm) - (double) (labels[aeit->first] == src_comm));
+        }
+        if (curr_graph.is_directed())
+            for (adjacent_edges_iterator aeit = curr_graph.in_edges_begin(vertex); aeit != curr_graph.in_edges_end(vertex); aeit++)
+                if (aeit->first != vertex && labels[aeit->first] == next_labels[aeit->first])
+                    change += aeit->second * ((next_labels[aeit->first] == dst_comm) - (double) (labels[aeit->first] == src_comm));
+#ifdef ENABLE_MULTITHREADING
+#pragma omp atomic
+#endif
+        inside += change;
+        add_to_total(src_comm, -curr_graph.get_node_out_weight(vertex));
+        add_to_total(dst_comm, curr_graph.get_node_out_weight(vertex));
+    }
+
 };
 
 void CDLib::cda_bgll_modularity(const graph& g, const vector<id_type>& init_comms, vector< vector<id_type> >& hier_comms, double resolution_param) {
@@ -2142,3 +2571,14 @@ void CDLib::cda_bgll_modularity(const graph& g, const vector<id_type>& init_comm
     cda_bgll_generic(g, init_comms, hier_comms, static_cast<bgll_objective&> (book));
 }
 
+#define LOCAL_COMMUNITY_INSTANTIATE(G) \
+    template bool CDLib::local_community_clauset<G>(const G&, id_type, size_t, node_set&); \
+    template bool CDLib::local_community_clauset_modified<G>(const G&, id_type, size_t, node_set&); \
+    template bool CDLib::LWP_2006<G>(const G&, id_type, node_set&); \
+    template void CDLib::VD_2011<G>(const G&, id_type, node_set&); \
+    template bool CDLib::Bagrow_2007<G>(const G&, id_type, node_set&); \
+    template bool CDLib::My_Algorithm<G>(const G&, id_type, node_set&); \
+    template bool CDLib::CZR<G>(const G&, id_type, node_set&); \
+    template bool CDLib::CZR_Beta<G>(const G&, id_type, node_set&);
+
+CDLIB_FOR_EACH_GRAPH_BACKEND(LOCAL_COMMUNITY_INSTANTIATE)
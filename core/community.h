@@ -19,31 +19,568 @@
 
 namespace CDLib {
 
-    bool local_community_clauset(const graph& g, id_type src, size_t k, node_set& output);
-    bool local_community_clauset_modified(const graph& g, id_type src, size_t k, node_set& output);
-    bool LWP_2006(const graph& g, id_type src, node_set& output);
-    void VD_2011(const graph& g, id_type src, node_set& output);
-    bool Bagrow_2007(const graph& g, id_type src, node_set& output);
-    bool My_Algorithm(const graph& g, id_type src, node_set& output);
-    bool CZR(const graph& g, id_type src, node_set& output);
-    bool CZR_Beta(const graph& g, id_type src, node_set& output);
+    //    Local community detection only reads the graph, so it is templated over the
+    //    backend and instantiated in community.cpp for each registered backend.
+    template <typename G> bool local_community_clauset(const G& g, id_type src, size_t k, node_set& output);
+    template <typename G> bool local_community_clauset_modified(const G& g, id_type src, size_t k, node_set& output);
+    template <typename G> bool LWP_2006(const G& g, id_type src, node_set& output);
+    template <typename G> void VD_2011(const G& g, id_type src, node_set& output);
+    template <typename G> bool Bagrow_2007(const G& g, id_type src, node_set& output);
+    template <typename G> bool My_Algorithm(const G& g, id_type src, node_set& output);
+    template <typename G> bool CZR(const G& g, id_type src, node_set& output);
+    template <typename G> bool CZR_Beta(const G& g, id_type src, node_set& output);
 
     typedef vector< vector<node_set> > dendrogram;
     void girvan_newman_2002(const graph& g, dendrogram& dendro);
+    //    Ranks the edges with betweenness estimated from num_samples seeded sources.
+    void girvan_newman_2002(const graph& g, dendrogram& dendro, id_type num_samples, unsigned long seed);
     void radicchi_et_al_2004(const graph& g, dendrogram & dendro);
 
     typedef vector<id_type> max_lplabel_container;
-    typedef unordered_map<id_type, double> lplabel_fitness_container;
 
-    class lp_raghavan_2007 {
+    //  Policies of lp_engine. A policy supplies the three hooks of a label propagation
+    //  variant as inline members, so the engine's inner loop has no virtual calls:
+    //    node_score(g, node), the weight of the label held by an in-neighbor,
+    //    edge_fitness(g, current, neighbor, weight), the weight of the edge it arrives on,
+    //    post_assign(g, labels, current, new_label, num_iters, max_labels), called before
+    //      a node's label changes from labels[current] to new_label,
+    //    post_iteration(g, num_iters), called after every sweep, and
+    //    local_fitness(), true when the fitness at a node only changes with the labels
+    //      of its in-neighbors, see lp_engine.
+    //  The fitness of a label at a node is the sum of node_score * edge_fitness over the
+    //  in-edges from neighbors holding it.
+
+    struct lp_raghavan_policy {
+
+        bool local_fitness() const {
+            return true;
+        }
+
+        double node_score(const graph& g, id_type node_id) const {
+            return 1.0;
+        }
+
+        double edge_fitness(const graph& g, id_type from_id, id_type to_id, double edge_weight) const {
+            return edge_weight;
+        }
+
+        void post_assign(const graph& g, const vector<id_type>& labels, id_type current, id_type new_label, id_type num_iters, max_lplabel_container& max_labels) {
+        }
+
+        void post_iteration(const graph& g, id_type num_iters) {
+        }
+    };
+
+    struct lp_leung_policy : public lp_raghavan_policy {
+        double hop_att;
+        vector<double> scores;
+
+        double node_score(const graph& g, id_type node_id) const {
+            return scores[node_id] - hop_att;
+        }
+
+        void post_assign(const graph& g, const vector<id_type>& labels, id_type current, id_type new_label, id_type num_iters, max_lplabel_container& max_labels) {
+            if (labels[current] == new_label) return;
+            double score = -numeric_limits<double>::infinity();
+            for (adjacent_edges_iterator aeit = g.in_edges_begin(current); aeit != g.in_edges_end(current); aeit++)
+                if (labels[aeit->first] == new_label && score < scores[aeit->first]) score = scores[aeit->first];
+            scores[current] = score;
+        }
+
+        lp_leung_policy(const graph& g, double hop_att_val) : hop_att(hop_att_val), scores(g.get_num_nodes(), 0) {
+        }
+    };
+
+    struct lp_track_changes_policy : public lp_raghavan_policy {
+        vector<id_type> num_lplabel_changes;
+        id_type num_iters_current;
+
+        bool local_fitness() const {
+            return false;
+        }
+
+        double edge_fitness(const graph& g, id_type from_id, id_type to_id, double edge_weight) const {
+            return (1.0 - ((double) num_lplabel_changes[to_id] / (double) (num_iters_current + 1))) * edge_weight;
+        }
+
+        void post_assign(const graph& g, const vector<id_type>& labels, id_type current, id_type new_label, id_type num_iters, max_lplabel_container& max_labels) {
+            if (labels[current] != new_label) num_lplabel_changes[current]++;
+        }
+
+        void post_iteration(const graph& g, id_type num_iters) {
+            num_iters_current = num_iters + 1;
+        }
+
+        lp_track_changes_policy(const graph& g) : num_lplabel_changes(g.get_num_nodes(), 0), num_iters_current(0) {
+        }
+    };
+
+    struct lp_dyn_hop_policy : public lp_track_changes_policy {
+        double hop_att_max;
+        double current_hop_att;
+        vector<double> distances;
+
+        double node_score(const graph& g, id_type node_id) const {
+            return 1 - (current_hop_att * distances[node_id]);
+        }
+
+        void post_assign(const graph& g, const vector<id_type>& labels, id_type current, id_type new_label, id_type num_iters, max_lplabel_container& max_labels) {
+            lp_track_changes_policy::post_assign(g, labels, current, new_label, num_iters, max_labels);
+            if (labels[current] == new_label) return;
+            double distance = numeric_limits<double>::infinity();
+            for (adjacent_edges_iterator aeit = g.in_edges_begin(current); aeit != g.in_edges_end(current); aeit++)
+                if (labels[aeit->first] == new_label && distance > distances[aeit->first]) distance = distances[aeit->first];
+            distances[current] = distance + 1;
+        }
+
+        void post_iteration(const graph& g, id_type num_iters) {
+            lp_track_changes_policy::post_iteration(g, num_iters);
+            double prop_change = 0;
+            for (id_type i = 0; i < num_lplabel_changes.size(); i++)
+                prop_change += num_lplabel_changes[i];
+            prop_change /= g.get_num_nodes();
+            current_hop_att = (prop_change > hop_att_max) ? 0 : current_hop_att;
+        }
+
+        lp_dyn_hop_policy(const graph& g, double hop_att_max_val) : lp_track_changes_policy(g), hop_att_max(hop_att_max_val), current_hop_att(0), distances(g.get_num_nodes(), 0) {
+        }
+    };
+
+    struct lp_offensive_policy : public lp_dyn_hop_policy {
+        vector<double> probabilities;
+
+        double edge_fitness(const graph& g, id_type from_id, id_type to_id, double edge_weight) const {
+            return node_score(g, to_id) * (1 - probabilities[to_id]) * edge_weight;
+        }
+
+        void post_assign(const graph& g, const vector<id_type>& labels, id_type current, id_type new_label, id_type num_iters, max_lplabel_container& max_labels) {
+            lp_dyn_hop_policy::post_assign(g, labels, current, new_label, num_iters, max_labels);
+            if (labels[current] == new_label) return;
+            double prob_num = 0;
+            for (adjacent_edges_iterator aeit = g.in_edges_begin(current); aeit != g.in_edges_end(current); aeit++)
+                if (labels[aeit->first] == new_label) prob_num += probabilities[aeit->first];
+            probabilities[current] = prob_num / g.get_node_in_weight(current);
+        }
+
+        lp_offensive_policy(const graph& g, double hop_att_max_val) : lp_dyn_hop_policy(g, hop_att_max_val), probabilities(g.get_num_nodes(), (double) 1 / (double) g.get_num_nodes()) {
+        }
+    };
+
+    struct lp_defensive_policy : public lp_offensive_policy {
+
+        double edge_fitness(const graph& g, id_type from_id, id_type to_id, double edge_weight) const {
+            return node_score(g, to_id) * probabilities[to_id] * edge_weight;
+        }
+
+        void post_assign(const graph& g, const vector<id_type>& labels, id_type current, id_type new_label, id_type num_iters, max_lplabel_container& max_labels) {
+            lp_dyn_hop_policy::post_assign(g, labels, current, new_label, num_iters, max_labels);
+            if (labels[current] == new_label) return;
+            double prob_denom = 0, prob_num = 0;
+            for (adjacent_edges_iterator aeit = g.in_edges_begin(current); aeit != g.in_edges_end(current); aeit++) {
+                if (labels[aeit->first] == new_label) {
+                    prob_num += probabilities[aeit->first];
+                    prob_denom += aeit->second;
+                }
+            }
+            probabilities[current] = prob_num / prob_denom;
+        }
+
+        lp_defensive_policy(const graph& g, double hop_att_max_val) : lp_offensive_policy(g, hop_att_max_val) {
+        }
+    };
+
+    struct lp_label_scratch {
+        //  The fitness of every label at a node, indexed by label; marks holds the evaluation
+        //  that last reset an entry, so the arrays are never cleared. The other members
+        //  collect what a thread did during a parallel sweep.
+        vector<double> fitness;
+        vector<id_type> marks;
+        vector<id_type> labels;
+        id_type stamp;
+        vector<id_type> changed;
+        vector<id_type> ties;
+        vector<id_type> tie_ends;
+
+        lp_label_scratch() : stamp(0) {
+        }
+    };
+
+    template<class lp_policy>
+    class lp_engine {
+        //  ids holds the nodes of the next sweep, shuffled once per sweep by reorder. The first
+        //  sweep visits every node, or the touched ones after resume. When the policy has a
+        //  local fitness, a later sweep only visits the nodes next to a change whose label is
+        //  no longer among their best ones, and the labels have converged once there are none.
+        //  Otherwise every sweep visits all the nodes and check_lplabels tests all of them.
+        //  After set_parallel, the sweeps are split among threads in fixed chunks and ties are
+        //  broken by a generator per thread. A synchronous sweep evaluates the nodes in
+        //  parallel, then calls post_assign for them in order. An asynchronous sweep goes
+        //  through the classes of a greedy coloring, whose nodes are never adjacent, so every
+        //  thread assigns its own nodes right away.
     protected:
+        lp_policy policy;
         bool synchronous;
+        bool parallel;
+        bool sweep_all;
         vector<id_type> positions;
         vector<id_type> ids;
         vector<id_type> lplabels;
         vector<id_type> lpnextlabels;
+        vector<id_type> changed_nodes;
+        vector<char> queued;
+        vector<lp_label_scratch> scratch;
+        vector<mt19937> generators;
+        vector<id_type> colors;
+        vector<id_type> color_offsets;
+        vector<id_type> colored_ids;
+
+        void get_max_lplabels(const graph& g, id_type current_node, lp_label_scratch& s, max_lplabel_container& max_labels) {
+            s.stamp++;
+            s.labels.clear();
+            for (adjacent_edges_iterator aeit = g.in_edges_begin(current_node); aeit != g.in_edges_end(current_node); aeit++) {
+                double fitness_value = policy.node_score(g, aeit->first) * policy.edge_fitness(g, current_node, aeit->first, aeit->second);
+                id_type label = lplabels[aeit->first];
+                if (label >= s.fitness.size()) {
+                    s.fitness.resize(label + 1, 0);
+                    s.marks.resize(label + 1, 0);
+                }
+                if (s.marks[label] != s.stamp) {
+                    s.marks[label] = s.stamp;
+                    s.fitness[label] = 0;
+                    s.labels.push_back(label);
+                }
+                s.fitness[label] += fitness_value;
+            }
+            double max_val = -numeric_limits<double>::infinity();
+            for (id_type i = 0; i < s.labels.size(); i++)
+                if (s.fitness[s.labels[i]] > max_val) max_val = s.fitness[s.labels[i]];
+            for (id_type i = 0; i < s.labels.size(); i++)
+                if (s.fitness[s.labels[i]] == max_val) max_labels.push_back(s.labels[i]);
+        }
+
+        bool has_max_lplabel(const graph& g, id_type node, lp_label_scratch& s) {
+            max_lplabel_container max_labels;
+            get_max_lplabels(g, node, s, max_labels);
+            return max_labels.empty() || find(max_labels.begin(), max_labels.end(), lplabels[node]) != max_labels.end();
+        }
+
+        id_type num_threads() const {
+            return generators.empty() ? 1 : generators.size();
+        }
+
+        bool check_lplabels(const graph& g) {
+            bool converged = true;
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel for schedule(dynamic,256) num_threads(num_threads()) reduction(&&:converged) if(parallel)
+#endif
+            for (id_type i = 0; i < g.get_num_nodes(); i++) {
+#ifdef ENABLE_MULTITHREADING
+                lp_label_scratch& s = scratch[omp_get_thread_num()];
+#else
+                lp_label_scratch& s = scratch[0];
+#endif
+                if (converged && !has_max_lplabel(g, i, s)) converged = false;
+            }
+            return converged;
+        }
+
+        id_type new_label_break_ties_randomly(const graph& g, id_type current_node, max_lplabel_container& max_labels) {
+            get_max_lplabels(g, current_node, scratch[0], max_labels);
+            if (max_labels.empty()) return lplabels[current_node];
+            CDLib::RandomGenerator<id_type> rnd_gen(0, max_labels.size() - 1);
+            return max_labels[rnd_gen.next()];
+        }
+
+        void reorder(const graph& g, id_type num_iters) {
+            random_shuffle(ids.begin(), ids.end());
+            for (vector<id_type>::iterator it = ids.begin(); it != ids.end(); it++)
+                positions[*it] = it - ids.begin();
+        }
+
+        void next_sweep(const graph& g) {
+            //  The nodes that changed and their out-neighbors, which see the change through
+            //  their in-edges, keeping those whose label is not among their best ones any more.
+            vector<id_type> candidates;
+            for (id_type i = 0; i < changed_nodes.size(); i++) {
+                id_type node = changed_nodes[i];
+                if (!queued[node]) {
+                    queued[node] = 1;
+                    candidates.push_back(node);
+                }
+                for (adjacent_edges_iterator aeit = g.out_edges_begin(node); aeit != g.out_edges_end(node); aeit++) {
+                    if (!queued[aeit->first]) {
+                        queued[aeit->first] = 1;
+                        candidates.push_back(aeit->first);
+                    }
+                }
+            }
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel for schedule(dynamic,256) num_threads(num_threads()) if(parallel)
+#endif
+            for (id_type i = 0; i < candidates.size(); i++) {
+#ifdef ENABLE_MULTITHREADING
+                lp_label_scratch& s = scratch[omp_get_thread_num()];
+#else
+                lp_label_scratch& s = scratch[0];
+#endif
+                if (has_max_lplabel(g, candidates[i], s)) queued[candidates[i]] = 0;
+            }
+            ids.clear();
+            for (id_type i = 0; i < candidates.size(); i++) {
+                if (queued[candidates[i]]) ids.push_back(candidates[i]);
+                queued[candidates[i]] = 0;
+            }
+        }
+
+        void color_nodes(const graph& g) {
+            //  Greedy coloring in id order: every node takes the smallest color absent from its
+            //  in- and out-neighbors with a smaller id.
+            id_type n = g.get_num_nodes(), num_colors = 0;
+            vector<id_type> used(n + 1, n);
+            colors.assign(n, 0);
+            for (id_type i = 0; i < n; i++) {
+                for (adjacent_edges_iterator aeit = g.in_edges_begin(i); aeit != g.in_edges_end(i); aeit++)
+                    if (aeit->first < i) used[colors[aeit->first]] = i;
+                for (adjacent_edges_iterator aeit = g.out_edges_begin(i); aeit != g.out_edges_end(i); aeit++)
+                    if (aeit->first < i) used[colors[aeit->first]] = i;
+                id_type color = 0;
+                while (used[color] == i) color++;
+                colors[i] = color;
+                if (color >= num_colors) num_colors = color + 1;
+            }
+            color_offsets.assign(num_colors + 1, 0);
+        }
+
+        void recolor_nodes(const graph& g, const vector<id_type>& nodes) {
+            //  Gives a node sharing its color with a neighbor the smallest color absent from
+            //  all its neighbors, after edges were added around the nodes.
+            colors.resize(g.get_num_nodes(), 0);
+            vector<char> used;
+            for (id_type i = 0; i < nodes.size(); i++) {
+                id_type node = nodes[i];
+                used.assign(g.get_node_in_degree(node) + g.get_node_out_degree(node) + 2, 0);
+                for (adjacent_edges_iterator aeit = g.in_edges_begin(node); aeit != g.in_edges_end(node); aeit++)
+                    if (aeit->first != node && colors[aeit->first] < used.size()) used[colors[aeit->first]] = 1;
+                for (adjacent_edges_iterator aeit = g.out_edges_begin(node); aeit != g.out_edges_end(node); aeit++)
+                    if (aeit->first != node && colors[aeit->first] < used.size()) used[colors[aeit->first]] = 1;
+                if (colors[node] < used.size() && !used[colors[node]]) continue;
+                id_type color = 0;
+                while (used[color]) color++;
+                colors[node] = color;
+                if (color + 1 >= color_offsets.size()) color_offsets.resize(color + 2, 0);
+            }
+        }
+
+        void parallel_sweep(const graph& g, id_type num_iters, const vector<id_type>& nodes, id_type begin, id_type end) {
+            id_type team_size = 1;
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel num_threads(num_threads())
+#endif
+            {
+#ifdef ENABLE_MULTITHREADING
+                id_type thread = omp_get_thread_num(), num_team = omp_get_num_threads();
+#pragma omp master
+                team_size = num_team;
+#else
+                id_type thread = 0, num_team = 1;
+#endif
+                lp_label_scratch& s = scratch[thread];
+                s.changed.clear();
+                s.ties.clear();
+                s.tie_ends.clear();
+                max_lplabel_container max_labels;
+                for (id_type j = begin + (end - begin) * thread / num_team; j < begin + (end - begin) * (thread + 1) / num_team; j++) {
+                    id_type node = nodes[j];
+                    max_labels.clear();
+                    get_max_lplabels(g, node, s, max_labels);
+                    id_type new_label = lplabels[node];
+                    if (max_labels.size() == 1) new_label = max_labels[0];
+                    else if (max_labels.size() > 1) {
+                        uniform_int_distribution<id_type> pick(0, max_labels.size() - 1);
+                        new_label = max_labels[pick(generators[thread])];
+                    }
+                    if (synchronous) {
+                        lpnextlabels[node] = new_label;
+                        s.ties.insert(s.ties.end(), max_labels.begin(), max_labels.end());
+                        s.tie_ends.push_back(s.ties.size());
+                    } else {
+                        policy.post_assign(g, lplabels, node, new_label, num_iters, max_labels);
+                        if (new_label != lplabels[node]) s.changed.push_back(node);
+                        lplabels[node] = new_label;
+                    }
+                }
+            }
+            max_lplabel_container max_labels;
+            for (id_type thread = 0; thread < team_size; thread++) {
+                lp_label_scratch& s = scratch[thread];
+                if (!synchronous) {
+                    changed_nodes.insert(changed_nodes.end(), s.changed.begin(), s.changed.end());
+                    continue;
+                }
+                id_type first = begin + (end - begin) * thread / team_size;
+                for (id_type k = 0; k < s.tie_ends.size(); k++) {
+                    id_type node = nodes[first + k];
+                    max_labels.assign(s.ties.begin() + (k ? s.tie_ends[k - 1] : 0), s.ties.begin() + s.tie_ends[k]);
+                    policy.post_assign(g, lplabels, node, lpnextlabels[node], num_iters, max_labels);
+                    if (lpnextlabels[node] != lplabels[node]) changed_nodes.push_back(node);
+                }
+            }
+        }
+
+        void sweep(const graph& g, id_type num_iters) {
+            if (parallel && synchronous) parallel_sweep(g, num_iters, ids, 0, ids.size());
+            else if (parallel) {
+                if (colors.empty()) color_nodes(g);
+                fill(color_offsets.begin(), color_offsets.end(), 0);
+                for (id_type i = 0; i < ids.size(); i++) color_offsets[colors[ids[i]] + 1]++;
+                for (id_type c = 1; c < color_offsets.size(); c++) color_offsets[c] += color_offsets[c - 1];
+                colored_ids.resize(ids.size());
+                vector<id_type> cursor(color_offsets.begin(), color_offsets.end() - 1);
+                for (id_type i = 0; i < ids.size(); i++) colored_ids[cursor[colors[ids[i]]]++] = ids[i];
+                for (id_type c = 0; c + 1 < color_offsets.size(); c++)
+                    if (color_offsets[c] < color_offsets[c + 1]) parallel_sweep(g, num_iters, colored_ids, color_offsets[c], color_offsets[c + 1]);
+            } else {
+                reorder(g, num_iters);
+                max_lplabel_container max_labels;
+                for (vector<id_type>::iterator it = ids.begin(); it != ids.end(); it++) {
+                    max_labels.clear();
+                    id_type new_label = new_label_break_ties_randomly(g, *it, max_labels);
+                    policy.post_assign(g, lplabels, *it, new_label, num_iters, max_labels);
+                    if (new_label != lplabels[*it]) changed_nodes.push_back(*it);
+                    if (synchronous) lpnextlabels[*it] = new_label;
+                    else lplabels[*it] = new_label;
+                }
+            }
+        }
+    public:
+
+        lp_policy& get_policy() {
+            return policy;
+        }
+
+        const vector<id_type>& get_lplabels() const {
+            return lplabels;
+        }
+
+        //  The nodes the next call to do_iteration visits, unless it visits all of them.
+
+        const vector<id_type>& get_frontier() const {
+            return ids;
+        }
+
+        //  Continues from the current labels after g changed around the touched nodes: nodes
+        //  added since are labelled by their own ids, and the next sweep visits only them and
+        //  the touched nodes, or every node when the fitness is not local. The policy must
+        //  already cover the added nodes.
+
+        void resume(const graph& g, const vector<id_type>& touched) {
+            id_type num_before = lplabels.size();
+            positions.resize(g.get_num_nodes(), 0);
+            queued.resize(g.get_num_nodes(), 0);
+            ids.clear();
+            for (id_type i = num_before; i < g.get_num_nodes(); i++) {
+                lplabels.push_back(i);
+                if (synchronous) lpnextlabels.push_back(i);
+                queued[i] = 1;
+                ids.push_back(i);
+            }
+            for (id_type i = 0; i < touched.size(); i++) {
+                if (!queued[touched[i]]) {
+                    queued[touched[i]] = 1;
+                    ids.push_back(touched[i]);
+                }
+            }
+            for (id_type i = 0; i < ids.size(); i++) queued[ids[i]] = 0;
+            if (!colors.empty()) recolor_nodes(g, ids);
+            sweep_all = false;
+        }
+
+        //  Runs the sweeps on all the threads, breaking ties with generators seeded from seed,
+        //  so that the labels only depend on the seed and the number of threads. node_score
+        //  and edge_fitness are then called concurrently, and so is post_assign in the
+        //  asynchronous mode.
+
+        void set_parallel(unsigned long seed) {
+            parallel = true;
+#ifdef ENABLE_MULTITHREADING
+            id_type max_threads = omp_get_max_threads();
+#else
+            id_type max_threads = 1;
+#endif
+            generators.clear();
+            for (id_type i = 0; i < max_threads; i++) generators.push_back(mt19937(seed + i));
+            scratch.resize(max_threads);
+        }
+
+        bool do_iteration(const graph& g, id_type num_iters) {
+            if (!policy.local_fitness() || sweep_all) {
+                ids.resize(g.get_num_nodes());
+                for (id_type i = 0; i < g.get_num_nodes(); i++) ids[i] = i;
+            }
+            sweep_all = false;
+            changed_nodes.clear();
+            sweep(g, num_iters);
+            if (synchronous)
+                for (id_type i = 0; i < changed_nodes.size(); i++)
+                    lplabels[changed_nodes[i]] = lpnextlabels[changed_nodes[i]];
+            policy.post_iteration(g, num_iters);
+            if (!policy.local_fitness()) return check_lplabels(g);
+            next_sweep(g);
+            return ids.empty();
+        }
+
+        void finalize(const graph& g, id_type num_iters, vector<id_type>& communities) {
+            communities.assign(lplabels.begin(), lplabels.end());
+        }
+
+        lp_engine(const graph& g, bool synchronous_val, const lp_policy& policy_val) :
+        policy(policy_val),
+        synchronous(synchronous_val),
+        parallel(false),
+        sweep_all(true),
+        positions(g.get_num_nodes(), 0),
+        ids(g.get_num_nodes(), 0),
+        lplabels(g.get_num_nodes(), 0),
+        queued(g.get_num_nodes(), 0),
+        scratch(1) {
+            if (synchronous) lpnextlabels.assign(g.get_num_nodes(), 0);
+            for (id_type i = 0; i < g.get_num_nodes(); i++) {
+                ids[i] = i;
+                positions[i] = i;
+                lplabels[i] = i;
+                if (synchronous) lpnextlabels[i] = i;
+            }
+        }
+    };
+
+    class lp_raghavan_2007;
+
+    //  Forwards the hooks to the virtual members of lp_raghavan_2007 and its subclasses.
+
+    struct lp_virtual_policy {
+        lp_raghavan_2007* algoman;
+        bool local_fitness() const;
+        double node_score(const graph& g, id_type node_id) const;
+        double edge_fitness(const graph& g, id_type from_id, id_type to_id, double edge_weight) const;
+        void post_assign(const graph& g, const vector<id_type>& labels, id_type current, id_type new_label, id_type num_iters, max_lplabel_container& max_labels);
+        void post_iteration(const graph& g, id_type num_iters);
+
+        lp_virtual_policy(lp_raghavan_2007* algoman_val) : algoman(algoman_val) {
+        }
+    };
+
+    class lp_raghavan_2007 : public lp_engine<lp_virtual_policy> {
+        //  The label propagation variants as a class hierarchy overriding virtual hooks,
+        //  run by lp_engine through lp_virtual_policy. The label_propagation_* functions
+        //  run lp_engine on the inline policies above instead.
+        friend struct lp_virtual_policy;
+    protected:
         unordered_set<id_type> nodes_with_fixed_lplabels;
 
+        virtual bool has_local_fitness() const {
+            return true;
+        }
+
         virtual double get_node_score(const graph& g, id_type node_id) {
             return 1.0;
         }
@@ -53,10 +590,6 @@ namespace CDLib {
         }
         virtual void post_node_assign(const graph& g, id_type current, id_type new_label, id_type num_iters, max_lplabel_container& max_labels);
         virtual void post_iteration(const graph& g, id_type num_iters);
-        virtual id_type new_label_break_ties_randomly(const graph& g, id_type current_node, max_lplabel_container& max_labels);
-        virtual void get_max_lplabels(const graph& g, id_type current_node, max_lplabel_container& max_labels);
-        virtual bool check_lplabels(const graph& g);
-        virtual void reorder(const graph& g, id_type num_iters);
         lp_raghavan_2007();
     public:
         bool is_node_lplabel_fixed(id_type node_id) const;
@@ -69,13 +602,26 @@ namespace CDLib {
         lp_raghavan_2007(const graph& g, bool synchronous_val);
     };
 
-    id_type label_propagation_run(const graph&g, vector<id_type>& communities, id_type max_iters, lp_raghavan_2007* algoman);
+    template<class lp_algorithm>
+    id_type label_propagation_run(const graph&g, vector<id_type>& communities, id_type max_iters, lp_algorithm* algoman) {
+        id_type num_iters = 0;
+        for (num_iters = 0; num_iters < max_iters; num_iters++)
+            if (algoman->do_iteration(g, num_iters)) break;
+        algoman->finalize(g, num_iters, communities);
+        return num_iters;
+    }
 
     class lp_track_changes : public lp_raghavan_2007 {
     protected:
         vector<id_type> num_lplabel_changes;
         id_type num_iters_current;
 
+        //  The fitness decays with the number of iterations for every node.
+
+        virtual bool has_local_fitness() const {
+            return false;
+        }
+
         virtual void post_iteration(const graph& g, id_type num_iters) {
             num_iters_current = num_iters + 1;
         }
@@ -199,7 +745,7 @@ namespace CDLib {
         }
 
         lp_dyn_hop_att(const graph& g, bool synchronous_val, double hop_att_max_val) :
-        lp_track_changes(g, synchronous),
+        lp_track_changes(g, synchronous_val),
         hop_att_max(hop_att_max_val),
         current_hop_att(0),
         distances(vector<double>(g.get_num_nodes(), 0)) {
@@ -258,7 +804,7 @@ namespace CDLib {
         extendable_lp_leung_2009();
     public:
 
-        extendable_lp_leung_2009(const graph& g, bool synchronous_val, double hop_att_val, node_preference_function& node_pref_f, edge_weight_function& edge_wt_f) : lp_leung_2009(g, synchronous, hop_att_val), node_pref_func(node_pref_f), edge_weight_func(edge_wt_f) {
+        extendable_lp_leung_2009(const graph& g, bool synchronous_val, double hop_att_val, node_preference_function& node_pref_f, edge_weight_function& edge_wt_f) : lp_leung_2009(g, synchronous_val, hop_att_val), node_pref_func(node_pref_f), edge_weight_func(edge_wt_f) {
         }
     };
 
@@ -274,7 +820,7 @@ namespace CDLib {
         extendable_lp_dyn_hop_att();
     public:
 
-        extendable_lp_dyn_hop_att(const graph& g, bool synchronous_val, double hop_att_max_val, node_preference_function_object& node_pref_f, edge_weight_function_object& edge_wt_f) : lp_dyn_hop_att(g, synchronous, hop_att_max_val), node_pref_func(node_pref_f), edge_weight_func(edge_wt_f) {
+        extendable_lp_dyn_hop_att(const graph& g, bool synchronous_val, double hop_att_max_val, node_preference_function_object& node_pref_f, edge_weight_function_object& edge_wt_f) : lp_dyn_hop_att(g, synchronous_val, hop_att_max_val), node_pref_func(node_pref_f), edge_weight_func(edge_wt_f) {
         }
     };
 
@@ -289,7 +835,7 @@ namespace CDLib {
         extendable_lp_offensive_lpa();
     public:
 
-        extendable_lp_offensive_lpa(const graph& g, bool synchronous_val, double hop_att_max_val, edge_weight_function_object& edge_wt_f) : lp_offensive_lpa(g, synchronous, hop_att_max_val), edge_weight_func(edge_wt_f) {
+        extendable_lp_offensive_lpa(const graph& g, bool synchronous_val, double hop_att_max_val, edge_weight_function_object& edge_wt_f) : lp_offensive_lpa(g, synchronous_val, hop_att_max_val), edge_weight_func(edge_wt_f) {
         }
     };
 
@@ -304,7 +850,7 @@ namespace CDLib {
         extendable_lp_defensive_lpa();
     public:
 
-        extendable_lp_defensive_lpa(const graph& g, bool synchronous_val, double hop_att_max_val, edge_weight_function_object& edge_wt_f) : lp_defensive_lpa(g, synchronous, hop_att_max_val), edge_weight_func(edge_wt_f) {
+        extendable_lp_defensive_lpa(const graph& g, bool synchronous_val, double hop_att_max_val, edge_weight_function_object& edge_wt_f) : lp_defensive_lpa(g, synchronous_val, hop_att_max_val), edge_weight_func(edge_wt_f) {
         }
     };
 
@@ -314,6 +860,14 @@ namespace CDLib {
     id_type label_propagation_olpa_2010(const graph& g, vector<id_type>& labels, id_type max_iters, bool synchronous, double hop_att_max);
     id_type label_propagation_dlpa_2010(const graph& g, vector<id_type>& labels, id_type max_iters, bool synchronous, double hop_att_max);
     id_type label_propagation_track_changes_2012(const graph& g, vector<id_type>& labels, id_type max_iters, bool synchronous);
+    //  The same on all threads, see lp_engine::set_parallel. The labels are the same for a
+    //  given seed and number of threads.
+    id_type label_propagation_raghavan_2007(const graph& g, vector<id_type>& labels, id_type max_iters, bool synchronous, unsigned long seed);
+    id_type label_propagation_leung_2009(const graph& g, vector<id_type>& labels, id_type max_iters, bool synchronous, double hop_att, unsigned long seed);
+    id_type label_propagation_dyn_hop_2010(const graph& g, vector<id_type>& labels, id_type max_iters, bool synchronous, double hop_att_max, unsigned long seed);
+    id_type label_propagation_olpa_2010(const graph& g, vector<id_type>& labels, id_type max_iters, bool synchronous, double hop_att_max, unsigned long seed);
+    id_type label_propagation_dlpa_2010(const graph& g, vector<id_type>& labels, id_type max_iters, bool synchronous, double hop_att_max, unsigned long seed);
+    id_type label_propagation_track_changes_2012(const graph& g, vector<id_type>& labels, id_type max_iters, bool synchronous, unsigned long seed);
 
     class evol_label_prop_new : public lp_track_changes {
     protected:
@@ -389,6 +943,75 @@ namespace CDLib {
     double evolutionary_label_propagation_edgelists(const string& snapshot_filepath, bool directed, bool weighted, dynamic_lp_input& input, dynamic_lp_output& output);
     void new_evolutionary_label_propagation_edgelists(const string& snapshot_filepath, bool directed, bool weighted, double alpha, bool basic, dynamic_lp_output& output);
 
+    struct lp_history_policy : public lp_raghavan_policy {
+        //  Weighs an edge by the stability of the label of the neighbor over the previous
+        //  snapshots, 1 when it never changed, blended with the plain weight by alpha as in
+        //  evolutionary_label_propagation. The stability is fixed while the labels of a
+        //  snapshot propagate, so the fitness stays local.
+        double alpha;
+        vector<double> stability;
+
+        double edge_fitness(const graph& g, id_type from_id, id_type to_id, double edge_weight) const {
+            return (alpha * stability[to_id] + 1 - alpha) * edge_weight;
+        }
+
+        lp_history_policy(const graph& g, double alpha_val) : alpha(alpha_val), stability(g.get_num_nodes(), 1) {
+        }
+    };
+
+    class lp_snapshot_stream {
+        //  Label propagation over one graph that evolves by batches of edge insertions and
+        //  deletions applied in place. After a batch the labels propagate again from the
+        //  endpoints of its edges only, so a snapshot costs about the volume of what changed
+        //  rather than the size of the graph. The window keeps, for each of the last
+        //  window_size snapshots, the nodes whose label changed; the stability of a node is
+        //  the share of those snapshots in which it kept its label, and a window_size of 0
+        //  is taken as 1. A change of stability reweighs the edges to the out-neighbors of
+        //  the node, which are touched for the next snapshot: until then their labels may
+        //  lag behind the new weights.
+    private:
+        graph g;
+        lp_engine<lp_history_policy> engine;
+        id_type window_size;
+        deque< vector<id_type> > window;
+        vector<id_type> window_changes;
+        vector<id_type> touched;
+        vector<id_type> labels_before;
+        vector<char> seen;
+        id_type num_changed;
+        void touch(id_type node);
+        void record_snapshot(vector<id_type>& restabilized);
+    public:
+        lp_snapshot_stream(bool directed, bool weighted, double alpha, id_type window_size_val);
+        const graph& get_graph() const;
+        const vector<id_type>& get_lplabels() const;
+        id_type get_num_touched() const;
+        id_type get_num_changed() const;
+        void set_parallel(unsigned long seed);
+        //  Adds the edge or sets its weight, adding any missing end point.
+        bool insert_edge(const string& from_label, const string& to_label, wt_t weight);
+        bool remove_edge(const string& from_label, const string& to_label);
+        //  Reads a batch from a file with one change per line: "+ from to [weight]" inserts an
+        //  edge and "- from to" removes one, lines starting with # or % are skipped.
+        bool read_delta(const string& filepath);
+        //  Propagates the labels from the nodes touched since the last call and moves the
+        //  window forward. Returns the number of sweeps.
+        id_type propagate(id_type max_iters);
+    };
+
+    struct lp_stream_output {
+        vector<id_type> lp_iters;
+        vector<double> lp_times;
+        vector<id_type> num_touched;
+        vector<id_type> num_changed;
+    };
+
+    //  The first line of delta_list_filepath names an edge list with the first snapshot, every
+    //  following line a delta file in the format of lp_snapshot_stream::read_delta. labels
+    //  receives the labels of the last snapshot. Returns 0 without reading anything when
+    //  window_size is 0.
+    double evolutionary_label_propagation_deltas(const string& delta_list_filepath, bool directed, bool weighted, double alpha, id_type window_size, vector<id_type>& labels, lp_stream_output& output);
+
     class bgll_objective {
     public:
         virtual void init(const graph& orig_graph, const vector<vector<id_type> >& hiercomms, const graph& curr_graph, const vector<id_type>& curr_comms) = 0;
@@ -396,19 +1019,45 @@ namespace CDLib {
         virtual double compute_gain(const graph& curr_graph, const vector<id_type>& labels, id_type vertex, id_type dst_comm) const = 0;
         virtual void detach_node(const graph& curr_graph, const vector<id_type>& labels, id_type vertex) = 0;
         virtual void attach_node(const graph& curr_graph, const vector<id_type>& labels, id_type vertex, id_type dst_comm) = 0;
+
+        //  attach_node follows every detach_node, with the community of the vertex itself
+        //  when it stays.
+        //  A book whose parallel_moves returns true is driven by the parallel local moving of
+        //  bgll_vertex_mover_optimizer through move_gain and move_node instead of detach_node,
+        //  compute_gain and attach_node, from several threads at once. move_gain is the gain of
+        //  vertex, a member of src_comm, joining dst_comm, to which its out-edges weigh
+        //  link_weight, up to a term equal for every dst_comm including src_comm. move_node
+        //  moves vertex from labels[vertex] to next_labels[vertex] while every other vertex
+        //  whose two labels differ moves as well, and updates the book without locks. objval
+        //  is called after every round of moves and should not cost a pass over the graph.
+        virtual bool parallel_moves() const {
+            return false;
+        }
+
+        virtual double move_gain(const graph& curr_graph, id_type vertex, id_type src_comm, id_type dst_comm, double link_weight) const {
+            return 0;
+        }
+
+        virtual void move_node(const graph& curr_graph, const vector<id_type>& labels, const vector<id_type>& next_labels, id_type vertex) {
+        }
     };
 
     class bgll_objective_w_internal : public bgll_objective {
+        //  Community ids lie in [0, num_comms), so the weights are kept in flat arrays indexed
+        //  by community; linked_comms lists the entries of node_link_weights the last vertex
+        //  set, which are reset before the next one.
     protected:
-        unordered_map<id_type, double> internal_weight;
-        unordered_map<id_type, double> node_link_weights;
+        vector<double> internal_weight;
+        vector<double> node_link_weights;
+        vector<id_type> linked_comms;
         double resolution_param;
         double self_weight;
         double weight_inside;
 
-        inline void init_internal_params() {
-            internal_weight.clear();
-            node_link_weights.clear();
+        inline void init_internal_params(id_type num_comms) {
+            internal_weight.assign(num_comms, 0);
+            node_link_weights.assign(num_comms, 0);
+            linked_comms.clear();
             self_weight = 0;
             weight_inside = 0;
         }
@@ -416,47 +1065,44 @@ namespace CDLib {
         inline void fill_internal_edges_for_vertex(const graph& curr_graph, const vector<id_type>& curr_comms, id_type vertex) {
             for (adjacent_edges_iterator aeit = curr_graph.out_edges_begin(vertex); aeit != curr_graph.out_edges_end(vertex); aeit++)
                 if (curr_comms[vertex] == curr_comms[aeit->first])
-                    map_insert_and_increment<id_type,double>(internal_weight, curr_comms[vertex], aeit->second);
+                    internal_weight[curr_comms[vertex]] += aeit->second;
         }
 
         inline void process_vertex_links(const graph& curr_graph, const vector<id_type>& labels, id_type vertex) {
-            node_link_weights.clear();
+            for (id_type i = 0; i < linked_comms.size(); i++) node_link_weights[linked_comms[i]] = 0;
+            linked_comms.clear();
             self_weight = 0;
             weight_inside = 0;
             for (adjacent_edges_iterator aeit = curr_graph.out_edges_begin(vertex); aeit != curr_graph.out_edges_end(vertex); aeit++) {
                 if (labels[aeit->first] != labels[vertex]) {
-                    pair < unordered_map<id_type, double>::iterator, bool> ret = node_link_weights.insert(make_pair(labels[aeit->first], 0));
-                    ret.first->second += aeit->second;
+                    if (!node_link_weights[labels[aeit->first]]) linked_comms.push_back(labels[aeit->first]);
+                    node_link_weights[labels[aeit->first]] += aeit->second;
                 } else if (vertex != aeit->first) {
                     weight_inside += aeit->second;
                 } else self_weight = aeit->second;
             }
         }
 
-        inline void update_internal_edges_on_vertex_detach(const graph& curr_graph, const vector<id_type>& labels, id_type vertex) {
+        //  Both return the internal weight they move.
+
+        inline double update_internal_edges_on_vertex_detach(const graph& curr_graph, const vector<id_type>& labels, id_type vertex) {
             process_vertex_links(curr_graph, labels, vertex);
-            unordered_map<id_type, double>::iterator it = internal_weight.find(labels[vertex]);
-            if (it != internal_weight.end()) it->second -= (2 * weight_inside + self_weight);
+            internal_weight[labels[vertex]] -= (2 * weight_inside + self_weight);
+            return 2 * weight_inside + self_weight;
         }
 
-        inline void update_internal_edges_on_vertex_attach(id_type dst_comm) {
-            unordered_map<id_type, double>::iterator it_in = internal_weight.find(dst_comm), it_nl = node_link_weights.find(dst_comm);
-            double int_wt = self_weight;
-            if (it_nl != node_link_weights.end()) int_wt += (2 * it_nl->second);
-            if (it_in != internal_weight.end()) it_in->second += int_wt;
-            else internal_weight.insert(make_pair(dst_comm, int_wt));
+        inline double update_internal_edges_on_vertex_attach(id_type src_comm, id_type dst_comm) {
+            double int_wt = self_weight + 2 * ((dst_comm == src_comm) ? weight_inside : node_link_weights[dst_comm]);
+            internal_weight[dst_comm] += int_wt;
+            return int_wt;
         }
 
         inline double objval_internal_term_running(const graph& curr_graph, id_type comm_id) const {
-            double int_weight = 0;
-            unordered_map<id_type, double>::const_iterator cit = internal_weight.find(comm_id);
-            if (cit != internal_weight.end()) int_weight = cit->second;
-            return ((resolution_param * int_weight) / (2 * curr_graph.get_total_weight()));
+            return ((resolution_param * internal_weight[comm_id]) / (2 * curr_graph.get_total_weight()));
         }
 
         inline double gain_internal_term(id_type dst_comm) const {
-            unordered_map<id_type, double>::const_iterator it = node_link_weights.find(dst_comm);
-            if (it != node_link_weights.end()) return (resolution_param * ((2 * it->second) + self_weight));
+            if (node_link_weights[dst_comm]) return (resolution_param * ((2 * node_link_weights[dst_comm]) + self_weight));
             else return 0;
         }
     public:
@@ -471,6 +1117,9 @@ namespace CDLib {
         virtual void detach_node(const graph& curr_graph, const vector<id_type>& labels, id_type vertex) = 0;
         virtual void attach_node(const graph& curr_graph, const vector<id_type>& labels, id_type vertex, id_type dst_comm) = 0;
     };
+    //  Labels are community ids in [0, g.get_num_nodes()). Books with parallel_moves move
+    //  every vertex at once in synchronous rounds, see community.cpp; the others one vertex
+    //  at a time.
     double bgll_vertex_mover_optimizer(const graph& g, vector<id_type>& labels, bgll_objective& book);
     void cda_bgll_generic(const graph&g, const vector<id_type>& init_comms, vector< vector<id_type> >& hier_comms, bgll_objective& book);
     void cda_bgll_modularity(const graph& g, const vector<id_type>& init_comms, vector< vector<id_type> >& hier_comms, double resolution_param);
@@ -9,6 +9,63 @@
 
 using namespace CDLib;
 
+struct node_set_membership
+{
+    const node_set& comm;
+    node_set_membership(const node_set& comm_val) : comm(comm_val) {}
+    bool operator()(id_type id) const { return comm.find(id) != comm.end(); }
+};
+
+struct label_membership
+{
+    const vector<id_type>& labels;
+    id_type label;
+    label_membership(const vector<id_type>& labels_val,id_type label_val) : labels(labels_val),label(label_val) {}
+    bool operator()(id_type id) const { return labels[id] == label; }
+};
+
+template <class membership>
+void add_cluster_node(const graph& g,id_type node,const membership& in_comm,cluster_edges& ce)
+{
+    double node_intra_cluster_edges = 0.0;
+    double node_inter_cluster_edges = 0.0;
+    for(adjacent_edges_iterator aeit = g.out_edges_begin(node); aeit != g.out_edges_end(node); aeit++)
+    {
+        double wt_expected = (g.get_node_out_weight(node)*g.get_node_in_weight(aeit->first))/(2*g.get_total_weight());
+        double num_expected = (double)(g.get_node_out_degree(node)*g.get_node_in_degree(aeit->first)/(double)(2*g.get_num_edges()));
+        if(in_comm(aeit->first))
+        {
+            node_intra_cluster_edges+=aeit->second;
+            ce.num_intra_cluster_edges++;
+            ce.num_expected_intra_cluster_edges += num_expected;
+            ce.wt_intra_cluster_edges += aeit->second;
+            ce.wt_expected_intra_cluster_edges += wt_expected;
+            ce.wt_intra_cluster_ratio += aeit->second/(g.get_node_out_weight(node)*g.get_node_in_weight(aeit->first));
+        }
+        else
+        {
+            node_inter_cluster_edges += aeit->second;
+            ce.num_inter_cluster_edges++;
+            ce.num_expected_inter_cluster_edges += num_expected;
+            ce.wt_inter_cluster_edges += aeit->second;
+            ce.wt_expected_inter_cluster_edges += wt_expected;
+        }
+
+    }
+    if(node_inter_cluster_edges > node_intra_cluster_edges) ce.is_strong_radicchi_community = false;
+    double odf = node_inter_cluster_edges/g.get_node_out_degree(node);
+    ce.max_odf = (odf > ce.max_odf) ? odf : ce.max_odf;
+    ce.avg_odf += odf;
+    if(node_intra_cluster_edges < (g.get_node_out_degree(node)/2)) ce.flake_odf++;
+}
+
+void finish_cluster_edges(id_type size,cluster_edges& ce)
+{
+    ce.is_weak_radicchi_community = (ce.wt_intra_cluster_edges > ce.wt_inter_cluster_edges);
+    ce.avg_odf /= size;
+    ce.flake_odf /= (double)size;
+}
+
 CDLib::cluster_edges::cluster_edges() :
     num_inter_cluster_edges(0),
     num_intra_cluster_edges(0),
@@ -18,6 +75,7 @@ CDLib::cluster_edges::cluster_edges() :
     wt_intra_cluster_edges(0.0),
     wt_expected_inter_cluster_edges(0.0),
     wt_expected_intra_cluster_edges(0.0),
+    wt_intra_cluster_ratio(0.0),
     max_odf(-numeric_limits<double>::infinity()),
     avg_odf(0.0),
     flake_odf(0.0),
@@ -27,53 +85,120 @@ CDLib::cluster_edges::cluster_edges() :
 
 CDLib::cluster_edges::cluster_edges(const graph& g,node_set& comm)
 {
-    num_inter_cluster_edges = 0;
-    num_intra_cluster_edges = 0;
-    num_expected_inter_cluster_edges = 0;
-    num_expected_intra_cluster_edges = 0;
-    wt_inter_cluster_edges = 0.0;
-    wt_intra_cluster_edges = 0.0;
-    wt_expected_inter_cluster_edges = 0.0;
-    wt_expected_intra_cluster_edges = 0.0;
+    *this = cluster_edges();
     is_strong_radicchi_community = true;
-    max_odf = -numeric_limits<double>::infinity();
-    avg_odf = 0.0;
-    flake_odf = 0.0;
+    node_set_membership in_comm(comm);
     for(node_set::iterator it = comm.begin(); it != comm.end(); it++)
+        add_cluster_node(g,*it,in_comm,*this);
+    finish_cluster_edges(comm.size(),*this);
+}
+
+void merge_cluster_edges(const cluster_edges& part,cluster_edges& ce)
+{
+    ce.num_inter_cluster_edges += part.num_inter_cluster_edges;
+    ce.num_intra_cluster_edges += part.num_intra_cluster_edges;
+    ce.num_expected_inter_cluster_edges += part.num_expected_inter_cluster_edges;
+    ce.num_expected_intra_cluster_edges += part.num_expected_intra_cluster_edges;
+    ce.wt_inter_cluster_edges += part.wt_inter_cluster_edges;
+    ce.wt_intra_cluster_edges += part.wt_intra_cluster_edges;
+    ce.wt_expected_inter_cluster_edges += part.wt_expected_inter_cluster_edges;
+    ce.wt_expected_intra_cluster_edges += part.wt_expected_intra_cluster_edges;
+    ce.wt_intra_cluster_ratio += part.wt_intra_cluster_ratio;
+    ce.max_odf = (part.max_odf > ce.max_odf) ? part.max_odf : ce.max_odf;
+    ce.avg_odf += part.avg_odf;
+    ce.flake_odf += part.flake_odf;
+    ce.is_strong_radicchi_community = ce.is_strong_radicchi_community && part.is_strong_radicchi_community;
+}
+
+//  Out-edges plus nodes per chunk of the sweep in compute_cluster_edges.
+const id_type cluster_edges_chunk_volume = 1 << 14;
+
+void CDLib::compute_cluster_edges(const graph& g, const vector<id_type>& labels, id_type num_comms, vector<id_type>& sizes, vector<cluster_edges>& ces)
+{
+    //  The nodes are grouped by community with a counting sort and the grouped list is cut
+    //  into chunks of about cluster_edges_chunk_volume, so one giant community is spread
+    //  over all threads. A community inside one chunk is summed in place; the pieces of one
+    //  that spans several are kept per chunk and merged in chunk order afterwards. The cuts
+    //  do not depend on the number of threads, and neither do the sums.
+    vector<id_type> offsets(num_comms+1,0),members;
+    for(id_type i=0;i<labels.size();i++) if(labels[i]<num_comms) offsets[labels[i]+1]++;
+    for(id_type i=0;i<num_comms;i++) offsets[i+1] += offsets[i];
+    members.resize(offsets[num_comms]);
+    vector<id_type> cursor(offsets.begin(),offsets.end()-1);
+    for(id_type i=0;i<labels.size();i++) if(labels[i]<num_comms) members[cursor[labels[i]]++] = i;
+    vector<id_type> chunks(1,0);
+    id_type volume = 0;
+    for(id_type j=0;j<members.size();j++)
     {
-        double node_intra_cluster_edges = 0.0;
-        double node_inter_cluster_edges = 0.0;
-        for(adjacent_edges_iterator aeit = g.out_edges_begin(*it); aeit != g.out_edges_end(*it); aeit++)
+        volume += g.get_node_out_degree(members[j]) + 1;
+        if(volume >= cluster_edges_chunk_volume)
         {
-            double wt_expected = (g.get_node_out_weight(*it)*g.get_node_in_weight(aeit->first))/(2*g.get_total_weight());
-            double num_expected = (double)(g.get_node_out_degree(*it)*g.get_node_in_degree(aeit->first)/(double)(2*g.get_num_edges()));
-            if(comm.find(aeit->first) != comm.end() )
-            {
-                node_intra_cluster_edges+=aeit->second;
-                num_intra_cluster_edges++;
-                num_expected_intra_cluster_edges += num_expected;
-                wt_intra_cluster_edges += aeit->second;
-                wt_expected_intra_cluster_edges += wt_expected;
-            }
-            else
+            chunks.push_back(j+1);
+            volume = 0;
+        }
+    }
+    if(chunks.back() != members.size()) chunks.push_back(members.size());
+    sizes.assign(num_comms,0);
+    ces.assign(num_comms,cluster_edges());
+    for(id_type c=0;c<num_comms;c++) ces[c].is_strong_radicchi_community = true;
+    id_type num_chunks = chunks.size() - 1;
+    vector< vector< pair<id_type,cluster_edges> > > pieces(num_chunks);
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel for schedule(dynamic,1) shared(g,labels,offsets,members,chunks,ces,pieces)
+#endif
+    for(id_type k=0;k<num_chunks;k++)
+    {
+        for(id_type begin=chunks[k],end;begin<chunks[k+1];begin=end)
+        {
+            id_type c = labels[members[begin]];
+            end = min(offsets[c+1],chunks[k+1]);
+            label_membership in_comm(labels,c);
+            bool whole = (begin == offsets[c] && end == offsets[c+1]);
+            if(!whole)
             {
-                node_inter_cluster_edges += aeit->second;
-                num_inter_cluster_edges++;
-                num_expected_inter_cluster_edges += num_expected;
-                wt_inter_cluster_edges += aeit->second;
-                wt_expected_inter_cluster_edges += wt_expected;
+                pieces[k].push_back(make_pair(c,cluster_edges()));
+                pieces[k].back().second.is_strong_radicchi_community = true;
             }
+            cluster_edges& ce = (whole) ? ces[c] : pieces[k].back().second;
+            for(id_type j=begin;j<end;j++) add_cluster_node(g,members[j],in_comm,ce);
+        }
+    }
+    for(id_type k=0;k<pieces.size();k++)
+        for(id_type p=0;p<pieces[k].size();p++) merge_cluster_edges(pieces[k][p].second,ces[pieces[k][p].first]);
+    for(id_type c=0;c<num_comms;c++)
+    {
+        sizes[c] = offsets[c+1] - offsets[c];
+        finish_cluster_edges(sizes[c],ces[c]);
+    }
+}
 
+void cluster_edges_of_sets(const graph& g,vector<node_set>& comms,vector<id_type>& sizes,vector<cluster_edges>& ces)
+{
+    //  Disjoint sets go through one sweep over their labels. In an overlapping cover a node
+    //  has no single label, so every set is then evaluated on its own as before.
+    vector<id_type> labels(g.get_num_nodes(),comms.size());
+    bool disjoint = true;
+    for(id_type i=0;i<comms.size() && disjoint;i++)
+        for(node_set::iterator it=comms[i].begin();it!=comms[i].end() && disjoint;it++)
+        {
+            if(labels[*it] != comms.size()) disjoint = false;
+            labels[*it] = i;
         }
-        if(node_inter_cluster_edges > node_intra_cluster_edges) is_strong_radicchi_community = false;
-        double odf = node_inter_cluster_edges/g.get_node_out_degree(*it);
-        max_odf = (odf > max_odf) ? odf : max_odf;
-        avg_odf += odf;
-        if(node_intra_cluster_edges < (g.get_node_out_degree(*it)/2)) flake_odf++;
+    if(disjoint)
+    {
+        compute_cluster_edges(g,labels,comms.size(),sizes,ces);
+        return;
+    }
+    sizes.assign(comms.size(),0);
+    ces.assign(comms.size(),cluster_edges());
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel for schedule(dynamic,64) shared(g,comms,sizes,ces)
+#endif
+    for(id_type i=0;i<comms.size();i++)
+    {
+        sizes[i] = comms[i].size();
+        ces[i] = cluster_edges(g,comms[i]);
     }
-    is_weak_radicchi_community = (wt_intra_cluster_edges > wt_inter_cluster_edges);
-    avg_odf /= comm.size();
-    flake_odf /= (double)comm.size();
 }
 
 double CDLib::volume_comm(const graph& g, node_set& comm)
@@ -251,72 +376,103 @@ double CDLib::description_length(const graph& g, vector<node_set>& comms)
 }
 
 
-void CDLib::compute_imp_metrics_partition(const graph& g, vector<node_set>& comms,vector<double>& metrics)
+void imp_metrics_from_cluster_edges(const vector<id_type>& sizes,const vector<cluster_edges>& ces,vector<double>& metrics)
 {
     metrics.assign(4,0.0);
-    for(id_type i=0;i<comms.size();i++)
+    for(id_type i=0;i<ces.size();i++)
     {
-        cluster_edges ce(g,comms[i]);
-        metrics[0] +=  ce.wt_intra_cluster_edges/static_cast<double>(comms[i].size()); // RASSOC
-        metrics[1] +=  ce.wt_inter_cluster_edges/static_cast<double>(comms[i].size()); // EXP
+        const cluster_edges& ce = ces[i];
+        metrics[0] +=  ce.wt_intra_cluster_edges/static_cast<double>(sizes[i]); // RASSOC
+        metrics[1] +=  ce.wt_inter_cluster_edges/static_cast<double>(sizes[i]); // EXP
         metrics[2] +=  ce.wt_intra_cluster_edges/(2*ce.wt_intra_cluster_edges + ce.wt_inter_cluster_edges); //NASSOC
         metrics[3] +=  ce.wt_inter_cluster_edges/(2*ce.wt_intra_cluster_edges + ce.wt_inter_cluster_edges); //Conductance
     }
 }
 
-void CDLib::compute_all_metrics_partition(const graph& g, vector<node_set>& comms,vector<double>& metrics)
+void all_metrics_from_cluster_edges(const graph& g,const vector<id_type>& sizes,const vector<cluster_edges>& ces,bool compatible,vector<double>& metrics)
 {
+    //  compatible keeps the values the node_set entry point has always returned: an internal
+    //  density summed from the inter cluster edges and a modularity whose 1/4 factor is an
+    //  integer division, so always 0. Otherwise they are internal_density_comm and modularity.
     metrics.assign(14,0.0);
-    for(id_type i=0;i<comms.size();i++)
+    for(id_type i=0;i<ces.size();i++)
     {
-        cluster_edges ce(g,comms[i]);
+        const cluster_edges& ce = ces[i];
         metrics[0] +=  ce.wt_intra_cluster_edges; // Community Volume
         metrics[1] += ce.wt_inter_cluster_edges; //Cut
-        metrics[2] += (double)ce.wt_inter_cluster_edges / (double)(comms[i].size()*(g.get_num_nodes() - comms[i].size())); //Cut Ratio
+        metrics[2] += (double)ce.wt_inter_cluster_edges / (double)(sizes[i]*(g.get_num_nodes() - sizes[i])); //Cut Ratio
         metrics[3] +=  ce.wt_inter_cluster_edges/(2*ce.wt_intra_cluster_edges + ce.wt_inter_cluster_edges); //Conductance
         metrics[4] += ce.wt_inter_cluster_edges/(2*(g.get_total_weight() - ce.wt_intra_cluster_edges) + ce.wt_inter_cluster_edges); //Resistance
-        metrics[5] += (double)ce.num_inter_cluster_edges/(double)comms[i].size(); //Expansion
-        metrics[6] += ((g.is_directed()? 1 : 2))*ce.num_inter_cluster_edges/(double)(comms[i].size()*(comms[i].size()+((g.get_num_self_edges())?-1:1))); //Internal Density
+        metrics[5] += (double)ce.num_inter_cluster_edges/(double)sizes[i]; //Expansion
+        id_type internal_edges = (compatible) ? ce.num_inter_cluster_edges : ce.num_intra_cluster_edges;
+        metrics[6] += ((g.is_directed()? 1 : 2))*internal_edges/(double)(sizes[i]*(sizes[i]+((g.get_num_self_edges())?-1:1))); //Internal Density
         metrics[7] +=  (ce.wt_inter_cluster_edges/(2*ce.wt_intra_cluster_edges + ce.wt_inter_cluster_edges)) + (ce.wt_inter_cluster_edges/(2*(g.get_total_weight() - ce.wt_intra_cluster_edges) + ce.wt_inter_cluster_edges));//Normalized Cut
-        metrics[8] += ce.max_odf/comms[i].size();
-        metrics[9] += ce.avg_odf/comms[i].size();
-        metrics[10] += ce.flake_odf/comms[i].size();
-        metrics[11] += (1/4*(g.get_total_weight())*(ce.wt_intra_cluster_edges - ce.wt_expected_intra_cluster_edges)); //Modularity
+        metrics[8] += ce.max_odf/sizes[i];
+        metrics[9] += ce.avg_odf/sizes[i];
+        metrics[10] += ce.flake_odf/sizes[i];
+        if(compatible) metrics[11] += (1/4*(g.get_total_weight())*(ce.wt_intra_cluster_edges - ce.wt_expected_intra_cluster_edges)); //Modularity
+        else metrics[11] += ce.wt_intra_cluster_edges - ce.wt_expected_intra_cluster_edges;
         metrics[12] += (ce.wt_intra_cluster_edges/ce.wt_expected_intra_cluster_edges); //Modularity Density
-        metrics[13] += pow((2*ce.wt_intra_cluster_edges)/comms[i].size(),2);
+        metrics[13] += pow((2*ce.wt_intra_cluster_edges)/sizes[i],2);
     }
-    metrics[11]/=(4*g.get_total_weight());
+    metrics[11]/=((compatible) ? 4 : 2)*g.get_total_weight();
 }
 
-void CDLib::compute_community_metrics(const graph& g, node_set& comm,community_metrics& metrics)
+void CDLib::compute_imp_metrics_partition(const graph& g, vector<node_set>& comms,vector<double>& metrics)
 {
-    metrics.size = comm.size();
-    metrics.intracluster_edges = 0;
-    metrics.intercluster_edges = 0;
-    metrics.modularity = 0;
-    metrics.modularity_density = 0;
-    for(node_set::iterator nit = comm.begin();nit != comm.end();nit++)
-    {
-        for(adjacent_edges_iterator aeit = g.out_edges_begin(*nit);aeit != g.out_edges_end(*nit);aeit++)
-        {
-            if(is_member_of(aeit->first,comm))
-            {
-                metrics.intracluster_edges+=aeit->second;
-                metrics.modularity += aeit->second - ((g.get_node_out_weight(*nit)*g.get_node_in_weight(aeit->first))/2*g.get_total_weight());
-                metrics.modularity_density += (2*g.get_total_weight()*aeit->second)/(g.get_node_out_weight(*nit)*g.get_node_in_weight(aeit->first));
-            }
-            else metrics.intercluster_edges+=aeit->second;
-        }
-    }
-    metrics.intracluster_edges/=2;
+    vector<id_type> sizes;
+    vector<cluster_edges> ces;
+    cluster_edges_of_sets(g,comms,sizes,ces);
+    imp_metrics_from_cluster_edges(sizes,ces,metrics);
+}
+
+void CDLib::compute_all_metrics_partition(const graph& g, vector<node_set>& comms,vector<double>& metrics)
+{
+    vector<id_type> sizes;
+    vector<cluster_edges> ces;
+    cluster_edges_of_sets(g,comms,sizes,ces);
+    all_metrics_from_cluster_edges(g,sizes,ces,true,metrics);
+}
+
+void CDLib::compute_imp_metrics_partition(const graph& g, const vector<id_type>& labels,vector<double>& metrics)
+{
+    vector<id_type> comms,sizes;
+    vector<cluster_edges> ces;
+    id_type num_comms = reindex_communities(labels,comms);
+    compute_cluster_edges(g,comms,num_comms,sizes,ces);
+    imp_metrics_from_cluster_edges(sizes,ces,metrics);
+}
+
+void CDLib::compute_all_metrics_partition(const graph& g, const vector<id_type>& labels,vector<double>& metrics)
+{
+    vector<id_type> comms,sizes;
+    vector<cluster_edges> ces;
+    id_type num_comms = reindex_communities(labels,comms);
+    compute_cluster_edges(g,comms,num_comms,sizes,ces);
+    all_metrics_from_cluster_edges(g,sizes,ces,false,metrics);
+}
+
+void edge_metrics_from_cluster_edges(const graph& g,id_type size,const cluster_edges& ce,community_metrics& metrics)
+{
+    //  The per-edge modularity terms of an internal edge are its weight less out weight *
+    //  in weight / 2 * total weight, whose sum wt_expected_intra_cluster_edges gives up to
+    //  a factor of the squared total weight.
+    metrics.size = size;
+    metrics.intracluster_edges = ce.wt_intra_cluster_edges/2;
+    metrics.intercluster_edges = ce.wt_inter_cluster_edges;
+    metrics.modularity = (ce.wt_intra_cluster_edges - g.get_total_weight()*g.get_total_weight()*ce.wt_expected_intra_cluster_edges)/g.get_total_weight();
+    metrics.modularity_density = 2*g.get_total_weight()*ce.wt_intra_cluster_ratio;
     double volume = 2*metrics.intracluster_edges + metrics.intercluster_edges;
     metrics.expansion = metrics.intercluster_edges/static_cast<double>(metrics.size);
     metrics.conductance = metrics.intercluster_edges/volume;
-    metrics.modularity /= g.get_total_weight();
     metrics.nassoc = metrics.intracluster_edges/volume;
     metrics.cohesion = metrics.intracluster_edges/static_cast<double>(metrics.size);
     metrics.internal_density = ((g.is_directed() ? 2 : 1)* metrics.intracluster_edges)/static_cast<double>(metrics.size*metrics.size-1);
     metrics.community_score = pow(metrics.intracluster_edges,2)/static_cast<double>(metrics.size);
+}
+
+void structure_metrics_of_community(const graph& g, node_set& comm,community_metrics& metrics)
+{
     graph cg(0,0);
     extract_subgraph(g,comm,cg);
     vector<id_type> out_degrees;
@@ -335,96 +491,355 @@ void CDLib::compute_community_metrics(const graph& g, node_set& comm,community_m
     if(cg.get_num_nodes()>=2)for(id_type i=0;i<cg.get_num_nodes();i++) if(qfinal[i] && qinit[i]) metrics.rwalk_entropy += qinit[i]*log(qinit[i]/qfinal[i]);
 }
 
-bool comm_find_pair(vector<node_set>& comms,id_type x,id_type y)
+void CDLib::compute_community_metrics(const graph& g, node_set& comm,community_metrics& metrics)
 {
-    for(id_type i=0; i< comms.size();i++)
-        if(comms[i].find(x)!= comms[i].end() && comms[i].find(y)!= comms[i].end())
-            return true;
-    return false;
+    cluster_edges ce(g,comm);
+    edge_metrics_from_cluster_edges(g,comm.size(),ce,metrics);
+    structure_metrics_of_community(g,comm,metrics);
+}
+
+void CDLib::compute_community_metrics(const graph& g, const vector<id_type>& labels, vector<community_metrics>& metrics)
+{
+    //  The edge based metrics come from one sweep; the degree and random walk ones need the
+    //  subgraph of each community.
+    vector<id_type> comms,sizes;
+    vector<cluster_edges> ces;
+    id_type num_comms = reindex_communities(labels,comms);
+    compute_cluster_edges(g,comms,num_comms,sizes,ces);
+    vector<node_set> members(num_comms);
+    for(id_type i=0;i<comms.size();i++) members[comms[i]].insert(i);
+    metrics.assign(num_comms,community_metrics());
+    for(id_type c=0;c<num_comms;c++)
+    {
+        edge_metrics_from_cluster_edges(g,sizes[c],ces[c],metrics[c]);
+        structure_metrics_of_community(g,members[c],metrics[c]);
+    }
 }
 
-id_type num_common(node_set& comm1, node_set& comm2)
+void assemble_contingency_rows(const vector< vector< pair<id_type,id_type> > >& rows, contingency_table& table)
 {
-    id_type common = 0;
-    for(node_set::iterator nsit = comm1.begin(); nsit != comm1.end(); nsit++)
-        if(comm2.find(*nsit) != comm2.end()) common++;
-    return common;
+    id_type num_rows = rows.size();
+    table.row_offsets.assign(num_rows+1,0);
+    for(id_type r=0;r<num_rows;r++) table.row_offsets[r+1] = table.row_offsets[r] + rows[r].size();
+    table.col_ids.resize(table.row_offsets[num_rows]);
+    table.cell_sizes.resize(table.row_offsets[num_rows]);
+    for(id_type r=0;r<num_rows;r++)
+        for(id_type k=0;k<rows[r].size();k++)
+        {
+            table.col_ids[table.row_offsets[r]+k] = rows[r][k].first;
+            table.cell_sizes[table.row_offsets[r]+k] = rows[r][k].second;
+        }
 }
 
-id_type max_common(vector<node_set>& comms1, vector<node_set>& comms2)
+void fill_contingency_cells(const vector<id_type>& labels1, const vector<id_type>& labels2, contingency_table& table)
 {
-    id_type sum_max = 0;
-    for(id_type i=0; i< comms1.size(); i++)
+    //  The nodes are grouped by their community in the first partition with a counting sort,
+    //  and the row of every community is summed in a dense per-thread array indexed by the
+    //  communities of the second. Labels past row_sizes or col_sizes mark nodes outside a
+    //  partition and are skipped.
+    id_type num_rows = table.row_sizes.size(), num_cols = table.col_sizes.size();
+    vector<id_type> offsets(num_rows+1,0),members;
+    for(id_type i=0;i<labels1.size();i++) if(labels1[i]<num_rows && labels2[i]<num_cols) offsets[labels1[i]+1]++;
+    for(id_type i=0;i<num_rows;i++) offsets[i+1] += offsets[i];
+    members.resize(offsets[num_rows]);
+    vector<id_type> cursor(offsets.begin(),offsets.end()-1);
+    for(id_type i=0;i<labels1.size();i++) if(labels1[i]<num_rows && labels2[i]<num_cols) members[cursor[labels1[i]]++] = i;
+    vector< vector< pair<id_type,id_type> > > rows(num_rows);
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel shared(labels2,offsets,members,rows)
+#endif
     {
-        id_type max_common = 0;
-        for(id_type j=0; j<comms2.size();j++)
+        vector<id_type> counts(num_cols,0),linked;
+#ifdef ENABLE_MULTITHREADING
+#pragma omp for schedule(dynamic,64)
+#endif
+        for(id_type r=0;r<num_rows;r++)
         {
-            id_type n_common = num_common(comms1[i],comms2[j]);
-            max_common = (n_common > max_common) ? n_common : max_common;
+            linked.clear();
+            for(id_type j=offsets[r];j<offsets[r+1];j++)
+            {
+                id_type c = labels2[members[j]];
+                if(!counts[c]) linked.push_back(c);
+                counts[c]++;
+            }
+            sort(linked.begin(),linked.end());
+            for(id_type k=0;k<linked.size();k++)
+            {
+                rows[r].push_back(make_pair(linked[k],counts[linked[k]]));
+                counts[linked[k]] = 0;
+            }
         }
-        sum_max+= max_common;
     }
-    return sum_max;
+    assemble_contingency_rows(rows,table);
 }
 
-double CDLib::rand_index(id_type num_nodes, vector<node_set>& comms1, vector<node_set>& comms2)
+void fill_contingency_cells_of_covers(vector<node_set>& comms1, vector<node_set>& comms2, id_type max_id, contingency_table& table)
 {
-    id_type a00=0,a11=0,a01=0,a10=0;
-    for(id_type i=0; i<num_nodes; i++)
+    //  Every node adds one to the cell of each pair of sets, one per side, that it belongs
+    //  to, so a cell is the size of the intersection of its two sets even when they overlap
+    //  others. The sets of the second side containing a node are gathered by node first.
+    id_type num_rows = comms1.size(), num_cols = comms2.size();
+    vector<id_type> col_offsets(max_id+1,0),col_members;
+    for(id_type i=0;i<num_cols;i++) for(node_set::iterator it=comms2[i].begin();it!=comms2[i].end();it++) col_offsets[*it+1]++;
+    for(id_type i=0;i<max_id;i++) col_offsets[i+1] += col_offsets[i];
+    col_members.resize(col_offsets[max_id]);
+    vector<id_type> cursor(col_offsets.begin(),col_offsets.end()-1);
+    for(id_type i=0;i<num_cols;i++) for(node_set::iterator it=comms2[i].begin();it!=comms2[i].end();it++) col_members[cursor[*it]++] = i;
+    vector< vector< pair<id_type,id_type> > > rows(num_rows);
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel shared(comms1,col_offsets,col_members,rows)
+#endif
     {
-        for(id_type j=0; j<num_nodes; j++)
+        vector<id_type> counts(num_cols,0),linked;
+#ifdef ENABLE_MULTITHREADING
+#pragma omp for schedule(dynamic,64)
+#endif
+        for(id_type r=0;r<num_rows;r++)
         {
-            bool find_1 = comm_find_pair(comms1,i,j);
-            bool find_2 = comm_find_pair(comms2,i,j);
-            if(find_1 && find_2) a11++;
-            else if(!find_1 && !find_2) a00++;
-            else if(!find_1 && find_2) a01++;
-            else a10++;
+            linked.clear();
+            for(node_set::iterator it=comms1[r].begin();it!=comms1[r].end();it++)
+                for(id_type j=col_offsets[*it];j<col_offsets[*it+1];j++)
+                {
+                    id_type c = col_members[j];
+                    if(!counts[c]) linked.push_back(c);
+                    counts[c]++;
+                }
+            sort(linked.begin(),linked.end());
+            for(id_type k=0;k<linked.size();k++)
+            {
+                rows[r].push_back(make_pair(linked[k],counts[linked[k]]));
+                counts[linked[k]] = 0;
+            }
         }
     }
-    return (double)(a00+a11)/(double)(a10 + a01 + a00 + a11);
+    assemble_contingency_rows(rows,table);
 }
 
-double CDLib::dongen_index(id_type num_nodes, vector<node_set>& comms1, vector<node_set>& comms2)
+bool CDLib::build_contingency_table(const vector<id_type>& labels1, const vector<id_type>& labels2, contingency_table& table)
 {
-    id_type t1 = max_common(comms1,comms2),t2 = max_common(comms2,comms1);
-    return 1 - ((double)(t1+t2)/(double)(2*num_nodes));
+    if(labels1.size() != labels2.size()) return false;
+    vector<id_type> rows,cols;
+    table.num_nodes = labels1.size();
+    table.row_sizes.assign(reindex_communities(labels1,rows),0);
+    table.col_sizes.assign(reindex_communities(labels2,cols),0);
+    for(id_type i=0;i<rows.size();i++)
+    {
+        table.row_sizes[rows[i]]++;
+        table.col_sizes[cols[i]]++;
+    }
+    fill_contingency_cells(rows,cols,table);
+    return true;
 }
 
-double CDLib::nmi(id_type num_nodes, vector<node_set>& comms1, vector<node_set>& comms2)
+void CDLib::build_contingency_table(id_type num_nodes, vector<node_set>& comms1, vector<node_set>& comms2, contingency_table& table)
 {
-    if(!num_nodes || !comms1.size() || !comms2.size()) return 0;
-    double num=0,denom1=0,denom2=0;
-    for(id_type i=0; i< comms1.size(); i++)
-        if(comms1[i].size())denom1 += ((double)comms1[i].size()/(double)num_nodes)*log((double)comms1[i].size()/(double)num_nodes);
-    for(id_type i=0; i< comms2.size(); i++)
-        if(comms2[i].size())denom2 += ((double)comms2[i].size()/(double)num_nodes)*log((double)comms2[i].size()/(double)num_nodes);
-    for(id_type i=0; i< comms1.size(); i++)
+    //  The sizes are those of the sets and the cells count the nodes a set of each side has
+    //  in common. Disjoint sets go through one label per node; when a side has a node in
+    //  several sets, the cells are counted from every pair of sets containing the node.
+    id_type max_id = 0;
+    for(id_type i=0;i<comms1.size();i++) for(node_set::iterator it=comms1[i].begin();it!=comms1[i].end();it++) max_id = max(max_id,*it+1);
+    for(id_type i=0;i<comms2.size();i++) for(node_set::iterator it=comms2[i].begin();it!=comms2[i].end();it++) max_id = max(max_id,*it+1);
+    vector<id_type> rows(max_id,comms1.size()),cols(max_id,comms2.size());
+    table.num_nodes = num_nodes;
+    table.row_sizes.assign(comms1.size(),0);
+    table.col_sizes.assign(comms2.size(),0);
+    bool disjoint = true;
+    for(id_type i=0;i<comms1.size();i++)
+    {
+        table.row_sizes[i] = comms1[i].size();
+        for(node_set::iterator it=comms1[i].begin();it!=comms1[i].end();it++)
+        {
+            if(rows[*it] != comms1.size()) disjoint = false;
+            rows[*it] = i;
+        }
+    }
+    for(id_type i=0;i<comms2.size();i++)
     {
-        for(id_type j=0; j<comms2.size();j++)
+        table.col_sizes[i] = comms2[i].size();
+        for(node_set::iterator it=comms2[i].begin();it!=comms2[i].end();it++)
         {
-            id_type n_com = num_common(comms1[i],comms2[j]);
-            if(n_com && comms1[i].size() && comms2[j].size()) num += ((double)n_com/(double)num_nodes)*log((double)(n_com*num_nodes)/(double)(comms1[i].size()*comms2[j].size()));
+            if(cols[*it] != comms2.size()) disjoint = false;
+            cols[*it] = i;
         }
     }
-    return (double)(-(2*num))/(double)(denom1+denom2);
+    if(disjoint) fill_contingency_cells(rows,cols,table);
+    else fill_contingency_cells_of_covers(comms1,comms2,max_id,table);
 }
 
-double CDLib::variation_of_information(id_type num_nodes,vector<node_set>& comms1, vector<node_set>& comms2)
+double CDLib::rand_index(const contingency_table& table)
+{
+    //  Over the ordered pairs of nodes, a node paired with itself included, the pairs that
+    //  share a community in both partitions or in neither.
+    double n = table.num_nodes,same1=0,same2=0,same_both=0;
+    if(!table.num_nodes) return 0;
+    for(id_type i=0;i<table.row_sizes.size();i++) same1 += (double)table.row_sizes[i]*table.row_sizes[i];
+    for(id_type j=0;j<table.col_sizes.size();j++) same2 += (double)table.col_sizes[j]*table.col_sizes[j];
+    for(id_type k=0;k<table.cell_sizes.size();k++) same_both += (double)table.cell_sizes[k]*table.cell_sizes[k];
+    return (n*n - same1 - same2 + 2*same_both)/(n*n);
+}
+
+double CDLib::dongen_index(const contingency_table& table)
 {
-    double num1=0,num2=0;
-    for(id_type i=0; i< comms1.size(); i++)
+    id_type t1 = 0,t2 = 0;
+    vector<id_type> col_max(table.col_sizes.size(),0);
+    for(id_type i=0;i+1<table.row_offsets.size();i++)
     {
-        for(id_type j=0; j<comms2.size();j++)
+        id_type row_max = 0;
+        for(id_type k=table.row_offsets[i];k<table.row_offsets[i+1];k++)
         {
-            id_type n_com = num_common(comms1[i],comms2[j]);
-            if(comms1[i].size() && n_com && num_nodes) num1 += ((double)n_com/(double)num_nodes)*log((double)n_com/(double)comms1[i].size());
-            if(comms2[j].size() && n_com && num_nodes) num2 += ((double)n_com/(double)num_nodes)*log((double)n_com/(double)comms2[j].size());
+            row_max = max(row_max,table.cell_sizes[k]);
+            col_max[table.col_ids[k]] = max(col_max[table.col_ids[k]],table.cell_sizes[k]);
         }
+        t1 += row_max;
     }
+    for(id_type j=0;j<col_max.size();j++) t2 += col_max[j];
+    return 1 - ((double)(t1+t2)/(double)(2*table.num_nodes));
+}
+
+double CDLib::nmi(const contingency_table& table)
+{
+    double n = table.num_nodes,num=0,denom1=0,denom2=0;
+    if(!table.num_nodes || table.row_sizes.empty() || table.col_sizes.empty()) return 0;
+    for(id_type i=0;i<table.row_sizes.size();i++)
+        if(table.row_sizes[i]) denom1 += (table.row_sizes[i]/n)*log(table.row_sizes[i]/n);
+    for(id_type j=0;j<table.col_sizes.size();j++)
+        if(table.col_sizes[j]) denom2 += (table.col_sizes[j]/n)*log(table.col_sizes[j]/n);
+    for(id_type i=0;i+1<table.row_offsets.size();i++)
+        for(id_type k=table.row_offsets[i];k<table.row_offsets[i+1];k++)
+            num += (table.cell_sizes[k]/n)*log((table.cell_sizes[k]*n)/((double)table.row_sizes[i]*table.col_sizes[table.col_ids[k]]));
+    return (-(2*num))/(denom1+denom2);
+}
+
+double CDLib::variation_of_information(const contingency_table& table)
+{
+    double n = table.num_nodes,num1=0,num2=0;
+    if(!table.num_nodes) return 0;
+    for(id_type i=0;i+1<table.row_offsets.size();i++)
+        for(id_type k=table.row_offsets[i];k<table.row_offsets[i+1];k++)
+        {
+            num1 += (table.cell_sizes[k]/n)*log((double)table.cell_sizes[k]/table.row_sizes[i]);
+            num2 += (table.cell_sizes[k]/n)*log((double)table.cell_sizes[k]/table.col_sizes[table.col_ids[k]]);
+        }
     return -(num1 + num2);
 }
 
+bool sets_are_disjoint(vector<node_set>& comms)
+{
+    unordered_set<id_type> seen;
+    for(id_type i=0;i<comms.size();i++)
+        for(node_set::iterator it=comms[i].begin();it!=comms[i].end();it++)
+            if(!seen.insert(*it).second) return false;
+    return true;
+}
+
+void sets_of_nodes(id_type num_nodes, vector<node_set>& comms, vector<id_type>& offsets, vector<id_type>& sets)
+{
+    //  The sets containing each node below num_nodes, grouped by node.
+    offsets.assign(num_nodes+1,0);
+    for(id_type i=0;i<comms.size();i++) for(node_set::iterator it=comms[i].begin();it!=comms[i].end();it++) if(*it<num_nodes) offsets[*it+1]++;
+    for(id_type i=0;i<num_nodes;i++) offsets[i+1] += offsets[i];
+    sets.resize(offsets[num_nodes]);
+    vector<id_type> cursor(offsets.begin(),offsets.end()-1);
+    for(id_type i=0;i<comms.size();i++) for(node_set::iterator it=comms[i].begin();it!=comms[i].end();it++) if(*it<num_nodes) sets[cursor[*it]++] = i;
+}
+
+double rand_index_of_covers(id_type num_nodes, vector<node_set>& comms1, vector<node_set>& comms2)
+{
+    //  With overlapping sets two nodes share a community when any set holds both, which no
+    //  contingency table records. Every node instead stamps the nodes it shares a set with
+    //  on each side, and the ordered pairs agreeing on both sides are counted from those.
+    if(!num_nodes) return 0;
+    vector<id_type> offsets1,sets1,offsets2,sets2;
+    sets_of_nodes(num_nodes,comms1,offsets1,sets1);
+    sets_of_nodes(num_nodes,comms2,offsets2,sets2);
+    double agree = 0;
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel shared(comms1,comms2,offsets1,sets1,offsets2,sets2) reduction(+:agree)
+#endif
+    {
+        //  Each node is visited once per call, so its id stamps the nodes it reached and the
+        //  arrays never need clearing.
+        vector<id_type> marks1(num_nodes,num_nodes),marks2(num_nodes,num_nodes);
+#ifdef ENABLE_MULTITHREADING
+#pragma omp for schedule(dynamic,64)
+#endif
+        for(id_type i=0;i<num_nodes;i++)
+        {
+            id_type same1=0,same2=0,same_both=0;
+            for(id_type k=offsets1[i];k<offsets1[i+1];k++)
+                for(node_set::iterator it=comms1[sets1[k]].begin();it!=comms1[sets1[k]].end();it++)
+                    if(*it<num_nodes && marks1[*it] != i)
+                    {
+                        marks1[*it] = i;
+                        same1++;
+                    }
+            for(id_type k=offsets2[i];k<offsets2[i+1];k++)
+                for(node_set::iterator it=comms2[sets2[k]].begin();it!=comms2[sets2[k]].end();it++)
+                    if(*it<num_nodes && marks2[*it] != i)
+                    {
+                        marks2[*it] = i;
+                        same2++;
+                        if(marks1[*it] == i) same_both++;
+                    }
+            agree += (double)num_nodes - same1 - same2 + 2*same_both;
+        }
+    }
+    return agree/((double)num_nodes*num_nodes);
+}
+
+double CDLib::rand_index(id_type num_nodes, vector<node_set>& comms1, vector<node_set>& comms2)
+{
+    if(!sets_are_disjoint(comms1) || !sets_are_disjoint(comms2)) return rand_index_of_covers(num_nodes,comms1,comms2);
+    contingency_table table;
+    build_contingency_table(num_nodes,comms1,comms2,table);
+    return rand_index(table);
+}
+
+double CDLib::dongen_index(id_type num_nodes, vector<node_set>& comms1, vector<node_set>& comms2)
+{
+    contingency_table table;
+    build_contingency_table(num_nodes,comms1,comms2,table);
+    return dongen_index(table);
+}
+
+double CDLib::nmi(id_type num_nodes, vector<node_set>& comms1, vector<node_set>& comms2)
+{
+    contingency_table table;
+    build_contingency_table(num_nodes,comms1,comms2,table);
+    return nmi(table);
+}
+
+double CDLib::variation_of_information(id_type num_nodes,vector<node_set>& comms1, vector<node_set>& comms2)
+{
+    contingency_table table;
+    build_contingency_table(num_nodes,comms1,comms2,table);
+    return variation_of_information(table);
+}
+
+double CDLib::rand_index(const vector<id_type>& labels1, const vector<id_type>& labels2)
+{
+    contingency_table table;
+    return (build_contingency_table(labels1,labels2,table)) ? rand_index(table) : 0;
+}
+
+double CDLib::dongen_index(const vector<id_type>& labels1, const vector<id_type>& labels2)
+{
+    contingency_table table;
+    return (build_contingency_table(labels1,labels2,table)) ? dongen_index(table) : 0;
+}
+
+double CDLib::nmi(const vector<id_type>& labels1, const vector<id_type>& labels2)
+{
+    contingency_table table;
+    return (build_contingency_table(labels1,labels2,table)) ? nmi(table) : 0;
+}
+
+double CDLib::variation_of_information(const vector<id_type>& labels1, const vector<id_type>& labels2)
+{
+    contingency_table table;
+    return (build_contingency_table(labels1,labels2,table)) ? variation_of_information(table) : 0;
+}
+
 id_type CDLib::reindex_communities(const vector<id_type>& old_comms,vector<id_type>& new_comms){
     unordered_map<id_type,id_type> labelmap;
     new_comms.assign(old_comms.size(),0);
@@ -565,6 +980,40 @@ double CDLib::evolutionary_cluster_validation(const graph& g1, const graph& g2,v
     return func(common1,comms_new1,comms_new2);
 }
 
+double CDLib::evolutionary_cluster_validation_table(const graph& g1, const graph& g2,vector<node_set>& comms1,vector<node_set>& comms2,double (*func)(const contingency_table& table))
+{
+    //  The nodes of g1 that g2 also has, labelled by their communities on either side;
+    //  communities are counted over those nodes only.
+    id_type common1 = 0,common2 = 0;
+    contingency_table table;
+    vector<id_type> rows(g1.get_num_nodes(),comms1.size()),cols(g1.get_num_nodes(),comms2.size());
+    table.row_sizes.assign(comms1.size(),0);
+    table.col_sizes.assign(comms2.size(),0);
+    for(id_type i=0;i<comms1.size();i++)
+        for(node_set::iterator it=comms1[i].begin();it != comms1[i].end();it++)
+            if(*it < g1.get_num_nodes() && g2.get_node_id(g1.get_node_label(*it)) < g2.get_num_nodes())
+            {
+                rows[*it] = i;
+                table.row_sizes[i]++;
+                common1++;
+            }
+    for(id_type j=0;j<comms2.size();j++)
+        for(node_set::iterator it=comms2[j].begin();it != comms2[j].end();it++)
+        {
+            id_type g1_node_id = (*it < g2.get_num_nodes()) ? g1.get_node_id(g2.get_node_label(*it)) : g1.get_num_nodes();
+            if(g1_node_id < g1.get_num_nodes())
+            {
+                cols[g1_node_id] = j;
+                table.col_sizes[j]++;
+                common2++;
+            }
+        }
+    if(common1 != common2) return 0;
+    table.num_nodes = common1;
+    fill_contingency_cells(rows,cols,table);
+    return func(table);
+}
+
 double CDLib::evolutionary_cluster_validation_union(const graph& g1, const graph& g2,vector<node_set>& comms1,vector<node_set>& comms2,double (*func)(id_type num_nodes, vector<node_set>& comms1, vector<node_set>& comms2))
 {
     vector<node_set> comms_new1,comms_new2;
@@ -35,6 +35,19 @@ namespace CDLib
         double f_score;
     };
 
+    struct contingency_table
+    {
+        //  The overlaps of two partitions of num_nodes nodes in sparse rows: community i of the
+        //  first meets the communities col_ids[row_offsets[i]..row_offsets[i+1]) of the second,
+        //  with the numbers of common nodes in cell_sizes. Only nonzero cells are stored.
+        id_type num_nodes;
+        vector<id_type> row_sizes;
+        vector<id_type> col_sizes;
+        vector<id_type> row_offsets;
+        vector<id_type> col_ids;
+        vector<id_type> cell_sizes;
+    };
+
     struct community_metrics
     {
         id_type size;
@@ -67,6 +80,10 @@ namespace CDLib
         double wt_expected_inter_cluster_edges;
         double wt_expected_intra_cluster_edges;
 
+        //  Sum over the internal edges of the weight divided by the out weight of the source
+        //  and the in weight of the target.
+        double wt_intra_cluster_ratio;
+
         double max_odf;
         double avg_odf;
         double flake_odf;
@@ -98,13 +115,33 @@ namespace CDLib
     double modularity_density(const graph& g, vector<node_set>& comms);
     double community_score(const graph& g, vector<node_set>& comms);
     double description_length(const graph& g, vector<node_set>& comms);
+    //  The cluster_edges of every community of a partition from one sweep over the edges, in
+    //  parallel over the communities. Nodes labelled num_comms or above belong to none.
+    void compute_cluster_edges(const graph& g, const vector<id_type>& labels, id_type num_comms, vector<id_type>& sizes, vector<cluster_edges>& ces);
     void compute_community_metrics(const graph& g, node_set& comm,community_metrics& metrics);
+    void compute_community_metrics(const graph& g, const vector<id_type>& labels, vector<community_metrics>& metrics);
     void compute_all_metrics_partition(const graph& g, vector<node_set>& comms,vector<double>& metrics);
     void compute_imp_metrics_partition(const graph& g, vector<node_set>& comms,vector<double>& metrics);
+    //  Unlike the node_set version, metrics[6] is the internal density of internal_density_comm
+    //  and metrics[11] the modularity of modularity, both summed over the communities.
+    void compute_all_metrics_partition(const graph& g, const vector<id_type>& labels,vector<double>& metrics);
+    void compute_imp_metrics_partition(const graph& g, const vector<id_type>& labels,vector<double>& metrics);
     double rand_index(id_type num_nodes, vector<node_set>& comms1, vector<node_set>& comms2);
     double dongen_index(id_type num_nodes, vector<node_set>& comms1, vector<node_set>& comms2);
     double nmi(id_type num_nodes, vector<node_set>& comms1, vector<node_set>& comms2);
     double variation_of_information(id_type num_nodes, vector<node_set>& comms1, vector<node_set>& comms2);
+    //  Both partitions as community labels of the same nodes, compared in O(n) through their
+    //  contingency table. False when the label vectors differ in size.
+    bool build_contingency_table(const vector<id_type>& labels1, const vector<id_type>& labels2, contingency_table& table);
+    void build_contingency_table(id_type num_nodes, vector<node_set>& comms1, vector<node_set>& comms2, contingency_table& table);
+    double rand_index(const contingency_table& table);
+    double dongen_index(const contingency_table& table);
+    double nmi(const contingency_table& table);
+    double variation_of_information(const contingency_table& table);
+    double rand_index(const vector<id_type>& labels1, const vector<id_type>& labels2);
+    double dongen_index(const vector<id_type>& labels1, const vector<id_type>& labels2);
+    double nmi(const vector<id_type>& labels1, const vector<id_type>& labels2);
+    double variation_of_information(const vector<id_type>& labels1, const vector<id_type>& labels2);
     id_type get_num_of_communities(const vector<id_type>& labels);
     void convert_labels_to_communities(const vector<id_type>& labels,vector<node_set>& communities);
     bool read_partition(const graph& g,const string& filepath,vector<node_set>& communities);
@@ -119,6 +156,7 @@ namespace CDLib
 
 
     double evolutionary_cluster_validation(const graph& g1, const graph& g2,vector<node_set>& comms1,vector<node_set>& comms2,double (*func)(id_type num_nodes, vector<node_set>& comms1, vector<node_set>& comms2));
+    double evolutionary_cluster_validation_table(const graph& g1, const graph& g2,vector<node_set>& comms1,vector<node_set>& comms2,double (*func)(const contingency_table& table));
     double evolutionary_cluster_validation_union(const graph& g1, const graph& g2,vector<node_set>& comms1,vector<node_set>& comms2,double (*func)(id_type num_nodes, vector<node_set>& comms1, vector<node_set>& comms2));
 
     bool is_member_of(id_type id, node_set& ns);
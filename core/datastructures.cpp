@@ -2,33 +2,103 @@
 using namespace std;
 using namespace CDLib;
 
+string CDLib::id_to_label(id_type id) {
+    char buffer[24];
+    char* pos = buffer + sizeof (buffer);
+    do {
+        *(--pos) = '0' + (id % 10);
+        id /= 10;
+    } while (id);
+    return string(pos, buffer + sizeof (buffer));
+}
+
+bool CDLib::label_to_id(const string& label, id_type& id) {
+    //  Accepts only the canonical decimal form produced by id_to_label.
+    if (label.empty() || label.size() > 19 || (label.size() > 1 && label[0] == '0')) return false;
+    id = 0;
+    for (id_type i = 0; i < label.size(); i++) {
+        if (label[i] < '0' || label[i] > '9') return false;
+        id = 10 * id + (label[i] - '0');
+    }
+    return true;
+}
+
+bidirectional_label_map::bidirectional_label_map() : fm_labels(), rm_ids(), b_identity(true), st_identity_size(0) {
+}
+
+bool bidirectional_label_map::identity() const {
+    return __atomic_load_n(&b_identity, __ATOMIC_ACQUIRE);
+}
+
+void bidirectional_label_map::materialize() const {
+    //  Const callers may get here from several threads at once. The first one to enter the
+    //  critical section builds the maps; clearing b_identity with release order publishes
+    //  them to the acquire loads in identity().
+    if (!identity()) return;
+#ifdef ENABLE_MULTITHREADING
+#pragma omp critical(bidirectional_label_map_materialize)
+#endif
+    if (b_identity) {
+        fm_labels.reserve(st_identity_size);
+        rm_ids.reserve(st_identity_size);
+        for (id_type i = 0; i < st_identity_size; i++) {
+            string label = id_to_label(i);
+            fm_labels.insert(make_pair(label, i));
+            rm_ids.insert(make_pair(i, label));
+        }
+        __atomic_store_n(&b_identity, false, __ATOMIC_RELEASE);
+    }
+}
+
+bool bidirectional_label_map::is_identity() const {
+    return identity();
+}
+
 id_type bidirectional_label_map::size() const {
+    if (identity()) return st_identity_size;
     return fm_labels.size();
 }
 
 node_label_iterator bidirectional_label_map::begin() const {
+    materialize();
     return fm_labels.begin();
 }
 
 node_label_iterator bidirectional_label_map::end() const {
+    materialize();
     return fm_labels.end();
 }
 
 
 string bidirectional_label_map::get_label(id_type id) const {
+    if (identity()) return (id < st_identity_size) ? id_to_label(id) : string("");
     unordered_map<id_type, string>::const_iterator it = rm_ids.find(id);
     if (it != rm_ids.end()) return it->second;
     return string("");
 }
 
 id_type bidirectional_label_map::get_id(const string& label) const {
+    if (identity()) {
+        id_type id;
+        if (label_to_id(label, id) && id < st_identity_size) return id;
+        return size();
+    }
     node_label_iterator it = fm_labels.find(label);
-    if (it != end()) return it->second;
+    if (it != fm_labels.end()) return it->second;
     return size();
 }
 
 bool bidirectional_label_map::insert(const string& label) {
     id_type curr_size = size();
+    if (b_identity) {
+        id_type id;
+        if (label_to_id(label, id) && id <= curr_size) {
+            if (id < curr_size) return false;
+            st_identity_size++;
+            return true;
+        }
+        materialize();
+    }
     if (get_id(label) == curr_size) {
         fm_labels.insert(make_pair(label, curr_size));
         rm_ids.insert(make_pair(curr_size, label));
@@ -37,9 +107,23 @@ bool bidirectional_label_map::insert(const string& label) {
     return false;
 }
 
+bool bidirectional_label_map::insert_next() {
+    //  Inserts the label equal to the next id, without building it in identity mode.
+    if (b_identity) {
+        st_identity_size++;
+        return true;
+    }
+    return insert(id_to_label(size()));
+}
+
 bool bidirectional_label_map::erase(const string& label) {
     id_type del_id = get_id(label);
     if (del_id != size()) {
+        if (b_identity && del_id == st_identity_size - 1) {
+            st_identity_size--;
+            return true;
+        }
+        materialize();
         fm_labels.erase(label);
         rm_ids.erase(del_id);
         return true;
@@ -48,6 +132,12 @@ bool bidirectional_label_map::erase(const string& label) {
 }
 
 bool bidirectional_label_map::erase(id_type id) {
+    if (b_identity && id >= st_identity_size) return false;
+    if (b_identity && id == st_identity_size - 1) {
+        st_identity_size--;
+        return true;
+    }
+    materialize();
     id_type last_id = size() - 1;
     string del_label = get_label(id), rep_label = get_label(last_id);
     if (del_label != "") {
@@ -61,6 +151,8 @@ bool bidirectional_label_map::erase(id_type id) {
 }
 
 bool bidirectional_label_map::swap_labels(id_type old_id,id_type new_id){
+    if (b_identity && old_id == new_id) return old_id < st_identity_size;
+    materialize();
     unordered_map<id_type, string>::iterator rit_new = rm_ids.find(new_id);
     unordered_map<id_type, string>::iterator rit_old = rm_ids.find(old_id);
     if(rit_new == rm_ids.end() || rit_old == rm_ids.end()) return false;
@@ -72,11 +164,18 @@ bool bidirectional_label_map::swap_labels(id_type old_id,id_type new_id){
     return true;
 }
 
+void bidirectional_label_map::reserve(id_type n) {
+    if (b_identity) return;
+    fm_labels.reserve(n);
+    rm_ids.reserve(n);
+}
 
 bool bidirectional_label_map::clear() {
-    if (!fm_labels.size()) return false;
+    if (!size()) return false;
     fm_labels.clear();
     rm_ids.clear();
+    b_identity = true;
+    st_identity_size = 0;
     return true;
 }
 
@@ -274,6 +373,63 @@ bool double_adjacency_map::clear() {
     return true;
 }
 
+void merge_adjacency_map(adjacency_map& am, vector<wt_t>& strengths, id_type num_nodes, const id_type* offsets, const id_type* neighbors, const wt_t* weights, id_type& num_added, wt_t& added_weight, id_type& num_self, wt_t& self_weight) {
+    //  Every node owns its hash map, so the nodes are merged independently. Arcs that are
+    //  already present keep their weight, as insert_edge does.
+    id_type added = 0, self = 0;
+    wt_t added_wt = 0, self_wt = 0;
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel for schedule(dynamic,256) shared(am,strengths,offsets,neighbors,weights) reduction(+:added,added_wt,self,self_wt)
+#endif
+    for (id_type i = 0; i < num_nodes; i++) {
+        am[i].reserve(am[i].size() + offsets[i + 1] - offsets[i]);
+        for (id_type j = offsets[i]; j < offsets[i + 1]; j++) {
+            wt_t weight = (weights) ? weights[j] : 1;
+            if (!am[i].insert(make_pair(neighbors[j], weight)).second) continue;
+            strengths[i] += weight;
+            added++;
+            added_wt += weight;
+            if (neighbors[j] == i) {
+                self++;
+                self_wt += weight;
+            }
+        }
+    }
+    num_added = added;
+    added_weight = added_wt;
+    num_self = self;
+    self_weight = self_wt;
+}
+
+bool double_adjacency_map::insert_edges(const csr_arrays& arrays) {
+    //  Bulk insertion of the arcs of a CSR over the first arrays.num_nodes nodes, without
+    //  going through insert_edge for every arc. The in arrays alias the out arrays for
+    //  undirected graphs, as CSR arranges.
+    if (arrays.num_nodes > num_nodes()) return false;
+    id_type added, self, in_added, in_self;
+    wt_t added_wt, self_wt, in_added_wt, in_self_wt;
+    merge_adjacency_map(am_out_edges, vw_out_degree, arrays.num_nodes, arrays.out_offsets, arrays.out_neighbors, arrays.out_weights, added, added_wt, self, self_wt);
+    merge_adjacency_map(am_in_edges, vw_in_degree, arrays.num_nodes, arrays.in_offsets, arrays.in_neighbors, arrays.in_weights, in_added, in_added_wt, in_self, in_self_wt);
+    st_num_edges += added;
+    st_num_self_edges += self;
+    wt_total_wt += added_wt;
+    wt_self_edge_wt += self_wt;
+    return true;
+}
+
+bool double_adjacency_map::assign(const csr_arrays& arrays) {
+    //  Replaces the whole map by the contents of a CSR.
+    am_out_edges.assign(arrays.num_nodes, adjacent_edge_sequence());
+    am_in_edges.assign(arrays.num_nodes, adjacent_edge_sequence());
+    vw_out_degree.assign(arrays.num_nodes, 0);
+    vw_in_degree.assign(arrays.num_nodes, 0);
+    st_num_edges = 0;
+    st_num_self_edges = 0;
+    wt_total_wt = 0;
+    wt_self_edge_wt = 0;
+    return insert_edges(arrays);
+}
+
 bool binary_heap::compare(const pair<id_type, wt_type>& left, const pair<id_type, wt_type>& right) const {
     return (b_max) ? (left.second > right.second) : (left.second < right.second);
 }
@@ -348,48 +504,282 @@ binary_heap::binary_heap(const vector<wt_type>& v, bool max) : vpiw_heap(), umis
 binary_heap::binary_heap(bool max) : vpiw_heap(), umis_pos(), b_max(max) {
 }
 
-disjoint_set::disjoint_set() : st_num_sets(0), inm_elems() {
+const id_type bucket_queue::max_span = 1024;
+const id_type indexed_dary_heap::arity = 4;
+const id_type indexed_dary_heap::absent = numeric_limits<id_type>::max();
+
+bool indexed_dary_heap::compare(wt_type left, wt_type right) const {
+    return (b_max) ? (left > right) : (left < right);
+}
+
+void indexed_dary_heap::place(id_type pos, const pair<id_type, wt_type>& piw_in) {
+    vpiw_heap[pos] = piw_in;
+    vid_pos[piw_in.first] = pos;
+}
+
+void indexed_dary_heap::heapify_up(id_type pos, const pair<id_type, wt_type>& piw_in) {
+    //  Moves the hole at pos up instead of swapping, and drops piw_in in at the end.
+    while (pos > 0) {
+        id_type parent = (pos - 1) / arity;
+        if (!compare(piw_in.second, vpiw_heap[parent].second)) break;
+        place(pos, vpiw_heap[parent]);
+        pos = parent;
+    }
+    place(pos, piw_in);
+}
+
+void indexed_dary_heap::heapify_down(id_type pos, const pair<id_type, wt_type>& piw_in) {
+    id_type num_entries = vpiw_heap.size();
+    while (true) {
+        id_type first = pos * arity + 1;
+        if (first >= num_entries) break;
+        id_type last = (first + arity < num_entries) ? first + arity : num_entries;
+        id_type best = first;
+        for (id_type child = first + 1; child < last; child++)
+            if (compare(vpiw_heap[child].second, vpiw_heap[best].second)) best = child;
+        if (!compare(vpiw_heap[best].second, piw_in.second)) break;
+        place(pos, vpiw_heap[best]);
+        pos = best;
+    }
+    place(pos, piw_in);
+}
+
+indexed_dary_heap::indexed_dary_heap(id_type num_elems, bool max) : vpiw_heap(), vid_pos(num_elems, absent), b_max(max) {
+}
+
+id_type indexed_dary_heap::size() const {
+    return vpiw_heap.size();
+}
+
+bool indexed_dary_heap::empty() const {
+    return vpiw_heap.empty();
+}
+
+bool indexed_dary_heap::contains(id_type id) const {
+    return id < vid_pos.size() && vid_pos[id] != absent;
+}
+
+pair<id_type, wt_type> indexed_dary_heap::top() const {
+    return vpiw_heap[0];
+}
+
+void indexed_dary_heap::push(id_type id, wt_type key) {
+    update_key(make_pair(id, key));
+}
+
+void indexed_dary_heap::update_key(const pair<id_type, wt_type>& piw_in) {
+    if (piw_in.first >= vid_pos.size()) vid_pos.resize(piw_in.first + 1, absent);
+    id_type pos = vid_pos[piw_in.first];
+    if (pos == absent) {
+        vpiw_heap.push_back(piw_in);
+        heapify_up(vpiw_heap.size() - 1, piw_in);
+    } else if (compare(piw_in.second, vpiw_heap[pos].second)) heapify_up(pos, piw_in);
+    else heapify_down(pos, piw_in);
+}
+
+void indexed_dary_heap::pop() {
+    vid_pos[vpiw_heap[0].first] = absent;
+    pair<id_type, wt_type> last = vpiw_heap.back();
+    vpiw_heap.pop_back();
+    if (!vpiw_heap.empty()) heapify_down(0, last);
+}
+
+void indexed_dary_heap::clear() {
+    for (id_type i = 0; i < vpiw_heap.size(); i++) vid_pos[vpiw_heap[i].first] = absent;
+    vpiw_heap.clear();
+}
+
+lazy_heap::lazy_heap() : vpiw_heap() {
+}
+
+id_type lazy_heap::size() const {
+    return vpiw_heap.size();
+}
+
+bool lazy_heap::empty() const {
+    return vpiw_heap.empty();
+}
+
+pair<id_type, wt_type> lazy_heap::top() const {
+    return vpiw_heap[0];
+}
+
+void lazy_heap::push(id_type id, wt_type key) {
+    id_type pos = vpiw_heap.size();
+    vpiw_heap.push_back(make_pair(id, key));
+    while (pos > 0) {
+        id_type parent = (pos - 1) / indexed_dary_heap::arity;
+        if (!(key < vpiw_heap[parent].second)) break;
+        vpiw_heap[pos] = vpiw_heap[parent];
+        pos = parent;
+    }
+    vpiw_heap[pos] = make_pair(id, key);
+}
+
+void lazy_heap::pop() {
+    pair<id_type, wt_type> last = vpiw_heap.back();
+    vpiw_heap.pop_back();
+    id_type num_entries = vpiw_heap.size(), pos = 0;
+    if (!num_entries) return;
+    while (true) {
+        id_type first = pos * indexed_dary_heap::arity + 1;
+        if (first >= num_entries) break;
+        id_type last_child = (first + indexed_dary_heap::arity < num_entries) ? first + indexed_dary_heap::arity : num_entries;
+        id_type best = first;
+        for (id_type child = first + 1; child < last_child; child++)
+            if (vpiw_heap[child].second < vpiw_heap[best].second) best = child;
+        if (!(vpiw_heap[best].second < last.second)) break;
+        vpiw_heap[pos] = vpiw_heap[best];
+        pos = best;
+    }
+    vpiw_heap[pos] = last;
+}
+
+void lazy_heap::clear() {
+    vpiw_heap.clear();
+}
+
+bucket_queue::bucket_queue(id_type max_edge_weight) : vvid_buckets(max_edge_weight + 1), st_cursor(0), st_key(0), st_size(0) {
+}
+
+void bucket_queue::advance() {
+    if (!st_size) return;
+    while (vvid_buckets[st_cursor].empty()) {
+        st_cursor = (st_cursor + 1 == vvid_buckets.size()) ? 0 : st_cursor + 1;
+        st_key++;
+    }
+}
+
+id_type bucket_queue::size() const {
+    return st_size;
+}
+
+bool bucket_queue::empty() const {
+    return !st_size;
+}
+
+pair<id_type, wt_type> bucket_queue::top() const {
+    return make_pair(vvid_buckets[st_cursor].back(), static_cast<wt_type> (st_key));
+}
+
+void bucket_queue::push(id_type id, wt_type key) {
+    //  pop moves the cursor to the next entry right away, so a key pushed by the node
+    //  just popped may lie before it; it is still within max_edge_weight of every entry.
+    id_type bucket_key = static_cast<id_type> (key);
+    if (!st_size || bucket_key < st_key) {
+        st_key = bucket_key;
+        st_cursor = bucket_key % vvid_buckets.size();
+    }
+    vvid_buckets[bucket_key % vvid_buckets.size()].push_back(id);
+    st_size++;
+}
+
+void bucket_queue::pop() {
+    vvid_buckets[st_cursor].pop_back();
+    st_size--;
+    advance();
+}
+
+void bucket_queue::clear() {
+    for (id_type i = 0; i < vvid_buckets.size(); i++) vvid_buckets[i].clear();
+    st_size = 0;
+}
+
+const id_type disjoint_set::absent = numeric_limits<id_type>::max();
+
+disjoint_set::disjoint_set() : vid_parents(), vuc_ranks(), st_size(0), st_num_sets(0) {
+}
+
+disjoint_set::disjoint_set(id_type num_elems) : vid_parents(num_elems), vuc_ranks(num_elems, 0), st_size(num_elems), st_num_sets(num_elems) {
+    for (id_type i = 0; i < num_elems; i++) vid_parents[i] = i;
 }
 
 id_type disjoint_set::size() const {
-    return inm_elems.size();
+    return st_size;
 }
 
 id_type disjoint_set::num_sets() const {
     return st_num_sets;
 }
 
-ds_iterator disjoint_set::begin() const {
-    return inm_elems.begin();
+bool disjoint_set::contains(id_type x) const {
+    return x < vid_parents.size() && vid_parents[x] != absent;
+}
+
+bool disjoint_set::make_set(id_type x) {
+    if (x >= vid_parents.size()) {
+        vid_parents.resize(x + 1, absent);
+        vuc_ranks.resize(x + 1, 0);
+    }
+    if (vid_parents[x] != absent) return false;
+    vid_parents[x] = x;
+    st_size++;
+    st_num_sets++;
+    return true;
+}
+
+id_type disjoint_set::find(id_type x) {
+    if (!contains(x)) return absent;
+    id_type root = x;
+    while (vid_parents[root] != root) root = vid_parents[root];
+    while (vid_parents[x] != root) {
+        id_type next = vid_parents[x];
+        vid_parents[x] = root;
+        x = next;
+    }
+    return root;
 }
 
-ds_iterator disjoint_set::end() const {
-    return inm_elems.end();
+bool disjoint_set::join(id_type x, id_type y) {
+    x = find(x);
+    y = find(y);
+    if (x == absent || y == absent || x == y) return false;
+    if (vuc_ranks[x] < vuc_ranks[y]) swap(x, y);
+    vid_parents[y] = x;
+    if (vuc_ranks[x] == vuc_ranks[y]) vuc_ranks[x]++;
+    st_num_sets--;
+    return true;
 }
 
-pair<ds_iterator, bool> disjoint_set::make_set(id_type x) {
-    return inm_elems.insert(make_pair(x, make_pair(x, 0)));
+bool disjoint_set::same_set(id_type x, id_type y) {
+    id_type root = find(x);
+    return root != absent && root == find(y);
 }
 
-pair<ds_iterator, bool> disjoint_set::find(id_type x) {
-    ds_iterator dit = inm_elems.find(x);
-    if (dit == inm_elems.end()) return make_pair(dit, false);
-    if (inm_elems[x].first != x)
-        inm_elems[x].first = find(inm_elems[x].first).first->second.first;
-    return make_pair(inm_elems.find(dit->second.first), true);
+concurrent_disjoint_set::concurrent_disjoint_set(id_type num_elems) : vid_parents(num_elems) {
+    for (id_type i = 0; i < num_elems; i++) vid_parents[i] = i;
 }
 
-pair<ds_iterator, bool> disjoint_set::join(id_type x, id_type y) {
-    pair<ds_iterator, bool> ret_x = find(x);
-    pair<ds_iterator, bool> ret_y = find(y);
-    if (!ret_x.second || !ret_y.second) return make_pair(inm_elems.end(), false);
-    if (ret_x.first == ret_y.first) return ret_x;
-    if (ret_x.first->second.second < ret_y.first->second.second) {
-        inm_elems[ret_x.first->first].first = ret_y.first->first;
-        return ret_y;
-    } else {
-        inm_elems[ret_y.first->first].second++;
-        inm_elems[ret_y.first->first].first = ret_x.first->first;
-        return ret_x;
+id_type concurrent_disjoint_set::size() const {
+    return vid_parents.size();
+}
+
+id_type concurrent_disjoint_set::find(id_type x) {
+    while (vid_parents[x] != x) {
+        id_type grand_parent = vid_parents[vid_parents[x]];
+        vid_parents[x] = grand_parent;
+        x = grand_parent;
+    }
+    return x;
+}
+
+bool concurrent_disjoint_set::join(id_type x, id_type y) {
+    while (true) {
+        x = find(x);
+        y = find(y);
+        if (x == y) return false;
+        if (x < y) swap(x, y);
+        if (__sync_bool_compare_and_swap(&vid_parents[x], x, y)) return true;
+    }
+}
+
+bool concurrent_disjoint_set::same_set(id_type x, id_type y) {
+    //  Roots can move while other threads join, so the answer is only final once
+    //  x's root is confirmed unchanged.
+    while (true) {
+        x = find(x);
+        y = find(y);
+        if (x == y) return true;
+        if (vid_parents[x] == x) return false;
     }
 }
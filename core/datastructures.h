@@ -17,23 +17,68 @@ namespace CDLib {
     typedef unordered_map<id_type, string> reverse_map;
     typedef forward_map::const_iterator node_label_iterator;
 
+    string id_to_label(id_type id);
+    bool label_to_id(const string& label, id_type& id);
+
     class bidirectional_label_map {
+        //  Starts out in identity mode, where node i is labelled by the decimal string of i
+        //  and no strings are stored: labels and ids are computed on demand. The maps are
+        //  materialized the first time a label breaks the pattern, a node other than the
+        //  last one is erased or the labels are iterated. The const methods are safe to call
+        //  from several threads, iteration included.
     private:
-        forward_map fm_labels;
-        reverse_map rm_ids;
+        mutable forward_map fm_labels;
+        mutable reverse_map rm_ids;
+        mutable bool b_identity;
+        id_type st_identity_size;
+        bool identity() const;
+        void materialize() const;
     public:
+        bidirectional_label_map();
         bool swap_labels(id_type old_id,id_type new_id);
+        bool is_identity() const;
         id_type size() const;
         node_label_iterator begin() const;
         node_label_iterator end() const;
         string get_label(id_type id) const;
         id_type get_id(const string& label) const;
         bool insert(const string& label);
+        bool insert_next();
         bool erase(const string& label);
         bool erase(id_type id);
+        void reserve(id_type n);
         bool clear();
     };
 
+    struct csr_arrays {
+        //  Raw views of the CSR storage (see CSR in graph.h). They point either into vectors
+        //  owned by a CSR or into a read-only memory mapped file, see read_binary_CSR in graphio.h.
+        //  label_offsets is NULL when every node is labelled by its own id.
+        bool directed;
+        bool weighted;
+        id_type num_nodes;
+        id_type num_arcs;
+        id_type num_self_edges;
+        wt_t total_arc_weight;
+        wt_t self_edges_weight;
+        const id_type* out_offsets;
+        const id_type* out_neighbors;
+        const wt_t* out_weights;
+        const id_type* in_offsets;
+        const id_type* in_neighbors;
+        const wt_t* in_weights;
+        const wt_t* out_strength;
+        const wt_t* in_strength;
+        const id_type* label_offsets;
+        const char* label_chars;
+        const id_type* label_order;
+
+        csr_arrays() : directed(false), weighted(false), num_nodes(0), num_arcs(0), num_self_edges(0), total_arc_weight(0), self_edges_weight(0),
+        out_offsets(NULL), out_neighbors(NULL), out_weights(NULL), in_offsets(NULL), in_neighbors(NULL), in_weights(NULL),
+        out_strength(NULL), in_strength(NULL), label_offsets(NULL), label_chars(NULL), label_order(NULL) {
+        }
+    };
+
     typedef unordered_map<id_type, wt_t> adjacent_edge_sequence;
     typedef vector<adjacent_edge_sequence> adjacency_map;
     typedef typename adjacent_edge_sequence::const_iterator adjacent_edges_iterator;
@@ -71,26 +116,49 @@ namespace CDLib {
         wt_t set_edge_wt(id_type from_id, id_type to_id, wt_t weight);
         bool delete_node(id_type id);
         bool delete_all_edges();
+        bool insert_edges(const csr_arrays& arrays);
+        bool assign(const csr_arrays& arrays);
         bool clear();
     };
 
-    typedef unordered_map< id_type,pair<id_type,id_type> > id_node_map;
-    typedef id_node_map::const_iterator ds_iterator;
     class disjoint_set {
+        //  Union-find in flat arrays indexed by id, with path compression and union by rank.
+        //  Ids join through make_set, or all of [0, num_elems) at construction; find returns
+        //  absent for an id that never did.
     private:
+        vector<id_type> vid_parents;
+        vector<unsigned char> vuc_ranks;
+        id_type st_size;
         id_type st_num_sets;
-        id_node_map inm_elems;
     public:
+        static const id_type absent;
         disjoint_set();
+        disjoint_set(id_type num_elems);
         id_type size() const;
         id_type num_sets() const;
-        ds_iterator begin() const;
-        ds_iterator end() const;
-        pair<ds_iterator,bool> make_set(id_type x);
-        pair<ds_iterator,bool> find(id_type x);
-        pair<ds_iterator,bool> join(id_type x, id_type y);
+        bool contains(id_type x) const;
+        bool make_set(id_type x);
+        id_type find(id_type x);
+        //  True when x and y were in two different sets, which are now merged.
+        bool join(id_type x, id_type y);
+        bool same_set(id_type x, id_type y);
     };
-    
+
+    class concurrent_disjoint_set {
+        //  Lock-free union-find over [0, num_elems) for edges processed by several threads.
+        //  join hooks the larger root under the smaller with a compare and swap and retries
+        //  when another thread moved it first, so the root of a set is always its smallest
+        //  id. find halves the path, which only ever moves an entry to one of its ancestors.
+    private:
+        vector<id_type> vid_parents;
+    public:
+        concurrent_disjoint_set(id_type num_elems);
+        id_type size() const;
+        id_type find(id_type x);
+        bool join(id_type x, id_type y);
+        bool same_set(id_type x, id_type y);
+    };
+
     class binary_heap {
     private:
         vector< pair<id_type,wt_type> >vpiw_heap;
@@ -110,7 +178,79 @@ namespace CDLib {
         binary_heap(bool min);
         binary_heap(const vector<wt_type>& v,bool max);
     };
-    
+
+    //  The priority queues below hold node ids in [0, num_elems) and share one interface:
+    //  push inserts an id or moves it to a better key, top and pop serve the best key.
+    //  Only indexed_dary_heap keeps one entry per id. lazy_heap and bucket_queue insert
+    //  the id again on every push, so a popped entry whose key is worse than the
+    //  current distance of its id is stale and must be skipped by the caller.
+
+    class indexed_dary_heap {
+        //  Heap of arity 4 with the slot of every id in a flat array, so a decrease key is
+        //  an array access instead of a hash lookup. Four children per node halve the
+        //  depth of a binary heap and keep the children of a slot on one cache line.
+    private:
+        vector< pair<id_type,wt_type> > vpiw_heap;
+        vector<id_type> vid_pos;
+        bool b_max;
+        bool compare(wt_type left,wt_type right) const;
+        void place(id_type pos,const pair<id_type,wt_type>& piw_in);
+        void heapify_up(id_type pos,const pair<id_type,wt_type>& piw_in);
+        void heapify_down(id_type pos,const pair<id_type,wt_type>& piw_in);
+    public:
+        static const id_type arity;
+        static const id_type absent;
+        indexed_dary_heap(id_type num_elems,bool max);
+        id_type size() const;
+        bool empty() const;
+        bool contains(id_type id) const;
+        pair<id_type,wt_type> top() const;
+        void push(id_type id,wt_type key);
+        void update_key(const pair<id_type,wt_type>& piw_in);
+        void pop();
+        void clear();
+    };
+
+    class lazy_heap {
+        //  Min heap of arity 4 without a position index: push never searches for an old
+        //  entry, it appends a new one. Cheaper per operation than decrease key when few
+        //  keys improve more than once, as on sparse graphs.
+    private:
+        vector< pair<id_type,wt_type> > vpiw_heap;
+    public:
+        lazy_heap();
+        id_type size() const;
+        bool empty() const;
+        pair<id_type,wt_type> top() const;
+        void push(id_type id,wt_type key);
+        void pop();
+        void clear();
+    };
+
+    class bucket_queue {
+        //  Dial's monotone bucket queue for non-negative integer keys. While a key k is the
+        //  minimum, every pushed key lies in [k, k + max_edge_weight], so a circular array of
+        //  max_edge_weight + 1 buckets indexed by key modulo its size holds all entries and
+        //  push and pop take constant time plus the empty buckets skipped.
+    private:
+        vector< vector<id_type> > vvid_buckets;
+        id_type st_cursor;
+        id_type st_key;
+        id_type st_size;
+        void advance();
+    public:
+        //  Largest edge weight the search routines use a bucket_queue for; past it the
+        //  empty buckets skipped cost more than a heap.
+        static const id_type max_span;
+        bucket_queue(id_type max_edge_weight);
+        id_type size() const;
+        bool empty() const;
+        pair<id_type,wt_type> top() const;
+        void push(id_type id,wt_type key);
+        void pop();
+        void clear();
+    };
+
     
 };
 
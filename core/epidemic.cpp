@@ -9,6 +9,15 @@
 
 using namespace CDLib;
 
+void percolation_steps(bfs_engine<graph>& engine, id_type seed_node_id, double transition_prob, vector<id_type>& step) {
+    //  Number of nodes first reached at each step of the cascade from seed_node_id.
+    step.clear();
+    engine.run_percolation(seed_node_id, transition_prob);
+    const vector<id_type>& offsets = engine.get_level_offsets();
+    for (id_type i = 1; i < offsets.size(); i++)
+        step.push_back(offsets[i] - offsets[i - 1]);
+}
+
 void CDLib::diffusion_step(const graph& g, double transition_prob, id_type monte_carlo, vector<double>& cover) {
     cover.clear();
     if (transition_prob < 0)
@@ -17,9 +26,12 @@ void CDLib::diffusion_step(const graph& g, double transition_prob, id_type monte
         monte_carlo = 1;
     srand(time(NULL));
     RandomGenerator<id_type> p_gen(0, g.get_num_nodes() - 1, 0);
+    bfs_engine<graph> engine(g);
+    vector<id_type> step;
     for (id_type i = 0; i < monte_carlo; i++) {
-        vector<id_type> step;
-        propagation(g, p_gen.next(), transition_prob, step);
+        id_type seed_node_id = p_gen.next();
+        if (seed_node_id < g.get_num_nodes()) percolation_steps(engine, seed_node_id, transition_prob, step);
+        else step.clear();
         if (step.size() > cover.size()) {
             for (id_type j = cover.size(); j < step.size(); j++)
                 cover.push_back(0);
@@ -46,30 +58,8 @@ void CDLib::propagation(const graph& g, id_type seed_node_id, double transition_
     step.clear();
     if ((seed_node_id >= g.get_num_nodes()) || (transition_prob < 0)) 
         return;
-    RandomGenerator<double> p_gen(0, 1, 0);
-    vector< vector<id_type> > nodes;
-    node_set visited;
-    id_type counts = 1;
-    nodes.push_back(vector<id_type>());
-    nodes[0].push_back(seed_node_id);
-    visited.insert(seed_node_id);
-    while (nodes.size() <= counts) {
-        nodes.push_back(vector<id_type>());
-        for (id_type i = 0; i < nodes[counts - 1].size(); i++) {            
-            for (adjacent_edges_iterator aeit = g.out_edges_begin(nodes[counts - 1][i]); aeit != g.out_edges_end(nodes[counts - 1][i]); aeit++) {
-                if ((p_gen.next() <= transition_prob) && (visited.find(aeit->first) == visited.end())) {
-                    visited.insert(aeit->first);
-                    nodes[counts].push_back(aeit->first);
-                }
-            }
-        }
-        if (nodes[counts].size() != 0)
-            counts++;
-    }
-    for (id_type i = 0; i < nodes.size(); i++) {
-        step.push_back(nodes[i].size());
-    }
-    step.pop_back();
+    bfs_engine<graph> engine(g);
+    percolation_steps(engine, seed_node_id, transition_prob, step);
 }
 
 
@@ -10,6 +10,7 @@
 
 #include "graph.h"
 #include "datastructures.h"
+#include "paths_and_components.h"
 using namespace std;
 
 namespace CDLib {
@@ -68,6 +68,10 @@ id_type graph::get_node_id(const string& label) const {
     return blm_labels.get_id(label);
 }
 
+bool graph::has_identity_labels() const {
+    return blm_labels.is_identity();
+}
+
 id_type graph::get_node_in_degree(id_type id) const {
     return dam_backend.in_degree(id);
 }
@@ -154,9 +158,8 @@ id_type graph::add_node(const string& label) {
 }
 
 id_type graph::add_node() {
-    ostringstream oss;
-    oss << get_num_nodes();
-    return add_node(oss.str());
+    if (blm_labels.insert_next()) return dam_backend.insert_node();
+    return get_node_id(id_to_label(get_num_nodes()));
 }
 
 bool graph::add_edge(id_type from_id, id_type to_id, wt_t weight) {
@@ -166,6 +169,41 @@ bool graph::add_edge(id_type from_id, id_type to_id, wt_t weight) {
     return dam_backend.insert_edge(from_id, to_id, weight2);
 }
 
+id_type graph::add_edges(const vector<id_type>& from, const vector<id_type>& to, const vector<wt_t>& weights) {
+    //  Batch counterpart of add_edge. The edges are sorted and merged into a CSR in one
+    //  pass (in parallel with ENABLE_MULTITHREADING) and the adjacency maps are then filled
+    //  node by node. The result is that of calling add_edge for every edge in order: edges
+    //  already present and repeated edges keep their first weight, weight 0 and unknown
+    //  ids are ignored. weights may be empty, in which case every edge weighs 1. Returns
+    //  the number of edges added.
+    id_type before = get_num_edges(), num_nodes = get_num_nodes(), num_edges = from.size();
+    vector<wt_t> checked(num_edges, 0);
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel for shared(from,to,weights,checked)
+#endif
+    for (id_type k = 0; k < num_edges; k++)
+        if (from[k] < num_nodes && to[k] < num_nodes) checked[k] = (weights.size()) ? weights[k] : 1;
+    CSR batch;
+    batch.populate_from_edges(is_directed(), is_weighted(), num_nodes, from, to, checked);
+    dam_backend.insert_edges(batch.arrays());
+    return get_num_edges() - before;
+}
+
+id_type graph::add_edges(const vector<struct edge>& edges) {
+    id_type num_edges = edges.size();
+    vector<id_type> from(num_edges), to(num_edges);
+    vector<wt_t> weights(num_edges);
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel for shared(edges,from,to,weights)
+#endif
+    for (id_type k = 0; k < num_edges; k++) {
+        from[k] = edges[k].from;
+        to[k] = edges[k].to;
+        weights[k] = edges[k].weight;
+    }
+    return add_edges(from, to, weights);
+}
+
 void graph::add_self_edges(double weight) {
     if (weight)
         for (id_type i = 0; i < get_num_nodes(); i++)
@@ -332,6 +370,20 @@ bool graph::clear() {
     return (dam_backend.clear() && blm_labels.clear() && graph_name.empty());
 }
 
+bool graph::assign(const CSR& csr) {
+    //  Bulk construction from a CSR. The adjacency maps are filled node by node instead of
+    //  edge by edge through add_edge, which is how the text readers in graphio.h build graphs.
+    clear();
+    b_directed = csr.is_directed();
+    b_weighted = csr.is_weighted();
+    graph_name = csr.get_graph_name();
+    if (csr.arrays().label_offsets) {
+        blm_labels.reserve(csr.get_num_nodes());
+        for (id_type i = 0; i < csr.get_num_nodes(); i++) blm_labels.insert(csr.get_node_label(i));
+    } else for (id_type i = 0; i < csr.get_num_nodes(); i++) blm_labels.insert_next();
+    return dam_backend.assign(csr.arrays());
+}
+
 bool graph::convert_to_unweighted(double threshold) {
     if (!is_weighted()) return false;
     for (id_type i = 0; i < get_num_nodes(); i++)
@@ -386,9 +438,371 @@ vector<struct edge> graph::get_all_edges() const {
     vector<struct edge> all_edges;
     for (id_type i = 0; i < get_num_nodes(); i++) {
         for (adjacent_edges_iterator aeit = out_edges_begin(i); aeit != out_edges_end(i); aeit++) {
-            struct edge *each = new edge(i, aeit->first, aeit->second);
-            all_edges.push_back(*each);
+            all_edges.push_back(edge(i, aeit->first, aeit->second));
+        }
+    }
+    return all_edges;
+}
+
+CSR::CSR() : view(), region(), graph_name() {
+    bind_owned();
+}
+
+CSR::CSR(const graph & g) : view(), region(), graph_name() {
+    populate_from_graph(g);
+}
+
+CSR::CSR(const CSR & other) : view(other.view), v_out_offsets(other.v_out_offsets), v_out_neighbors(other.v_out_neighbors), v_out_weights(other.v_out_weights),
+v_in_offsets(other.v_in_offsets), v_in_neighbors(other.v_in_neighbors), v_in_weights(other.v_in_weights), v_out_strength(other.v_out_strength),
+v_in_strength(other.v_in_strength), v_label_offsets(other.v_label_offsets), v_label_chars(other.v_label_chars), v_label_order(other.v_label_order),
+region(other.region), graph_name(other.graph_name) {
+    if (!region) bind_owned();
+}
+
+CSR& CSR::operator=(const CSR & other) {
+    if (this != &other) {
+        view = other.view;
+        v_out_offsets = other.v_out_offsets;
+        v_out_neighbors = other.v_out_neighbors;
+        v_out_weights = other.v_out_weights;
+        v_in_offsets = other.v_in_offsets;
+        v_in_neighbors = other.v_in_neighbors;
+        v_in_weights = other.v_in_weights;
+        v_out_strength = other.v_out_strength;
+        v_in_strength = other.v_in_strength;
+        v_label_offsets = other.v_label_offsets;
+        v_label_chars = other.v_label_chars;
+        v_label_order = other.v_label_order;
+        region = other.region;
+        graph_name = other.graph_name;
+        if (!region) bind_owned();
+    }
+    return *this;
+}
+
+void CSR::bind_owned() {
+    //  Points the view at the owned vectors. Undirected graphs share the out arrays.
+    if (v_out_offsets.empty()) v_out_offsets.assign(1, 0);
+    view.num_nodes = v_out_offsets.size() - 1;
+    view.out_offsets = v_out_offsets.data();
+    view.out_neighbors = v_out_neighbors.data();
+    view.out_weights = (v_out_weights.size()) ? v_out_weights.data() : NULL;
+    view.out_strength = v_out_strength.data();
+    if (view.directed) {
+        view.in_offsets = v_in_offsets.data();
+        view.in_neighbors = v_in_neighbors.data();
+        view.in_weights = (v_in_weights.size()) ? v_in_weights.data() : NULL;
+        view.in_strength = v_in_strength.data();
+    } else {
+        view.in_offsets = view.out_offsets;
+        view.in_neighbors = view.out_neighbors;
+        view.in_weights = view.out_weights;
+        view.in_strength = view.out_strength;
+    }
+    view.label_offsets = (v_label_offsets.size()) ? v_label_offsets.data() : NULL;
+    view.label_chars = v_label_chars.data();
+    view.label_order = v_label_order.data();
+}
+
+void CSR::attach(const csr_arrays& arrays, shared_ptr<const void> owner, const string& name) {
+    //  Adopts externally owned arrays, e.g. a memory mapped file. owner keeps them alive.
+    clear();
+    view = arrays;
+    region = owner;
+    graph_name = name;
+    if (!view.directed) {
+        view.in_offsets = view.out_offsets;
+        view.in_neighbors = view.out_neighbors;
+        view.in_weights = view.out_weights;
+        view.in_strength = view.out_strength;
+    }
+}
+
+void CSR::clear() {
+    view = csr_arrays();
+    v_out_offsets.assign(1, 0);
+    v_out_neighbors.clear();
+    v_out_weights.clear();
+    v_in_offsets.clear();
+    v_in_neighbors.clear();
+    v_in_weights.clear();
+    v_out_strength.clear();
+    v_in_strength.clear();
+    v_label_offsets.clear();
+    v_label_chars.clear();
+    v_label_order.clear();
+    region.reset();
+    graph_name.clear();
+    bind_owned();
+}
+
+void fill_csr_direction(const graph& g, bool out, vector<id_type>& offsets, vector<id_type>& neighbors, vector<wt_t>& weights, vector<wt_t>& strengths) {
+    //  Degrees first, then a prefix sum for the offsets, then every node copies and
+    //  sorts its own slice independently.
+    id_type num_nodes = g.get_num_nodes();
+    offsets.assign(num_nodes + 1, 0);
+    strengths.assign(num_nodes, 0);
+    for (id_type i = 0; i < num_nodes; i++) {
+        offsets[i + 1] = offsets[i] + ((out) ? g.get_node_out_degree(i) : g.get_node_in_degree(i));
+        strengths[i] = (out) ? g.get_node_out_weight(i) : g.get_node_in_weight(i);
+    }
+    neighbors.assign(offsets[num_nodes], 0);
+    if (g.is_weighted()) weights.assign(offsets[num_nodes], 0);
+    else weights.clear();
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel for schedule(dynamic,256) shared(g,offsets,neighbors,weights)
+#endif
+    for (id_type i = 0; i < num_nodes; i++) {
+        vector< pair<id_type, wt_t> > slice;
+        slice.reserve(offsets[i + 1] - offsets[i]);
+        if (out) for (adjacent_edges_iterator aeit = g.out_edges_begin(i); aeit != g.out_edges_end(i); aeit++) slice.push_back(*aeit);
+        else for (adjacent_edges_iterator aeit = g.in_edges_begin(i); aeit != g.in_edges_end(i); aeit++) slice.push_back(*aeit);
+        sort(slice.begin(), slice.end());
+        for (id_type j = 0; j < slice.size(); j++) {
+            neighbors[offsets[i] + j] = slice[j].first;
+            if (weights.size()) weights[offsets[i] + j] = slice[j].second;
+        }
+    }
+}
+
+struct csr_label_less {
+    //  Orders node ids by their labels, used to build the label lookup index.
+    const vector<id_type>& offsets;
+    const vector<char>& chars;
+
+    csr_label_less(const vector<id_type>& o, const vector<char>& c) : offsets(o), chars(c) {
+    }
+
+    bool operator()(id_type left, id_type right) const {
+        return lexicographical_compare(chars.begin() + offsets[left], chars.begin() + offsets[left + 1], chars.begin() + offsets[right], chars.begin() + offsets[right + 1]);
+    }
+};
+
+void CSR::populate_from_graph(const graph & g) {
+    clear();
+    view.directed = g.is_directed();
+    view.weighted = g.is_weighted();
+    graph_name = g.get_graph_name();
+    fill_csr_direction(g, true, v_out_offsets, v_out_neighbors, v_out_weights, v_out_strength);
+    if (view.directed) fill_csr_direction(g, false, v_in_offsets, v_in_neighbors, v_in_weights, v_in_strength);
+    view.num_arcs = v_out_neighbors.size();
+    if (!g.has_identity_labels()) v_label_offsets.assign(g.get_num_nodes() + 1, 0);
+    for (id_type i = 0; i < g.get_num_nodes(); i++) {
+        if (v_label_offsets.size()) {
+            string label = g.get_node_label(i);
+            v_label_chars.insert(v_label_chars.end(), label.begin(), label.end());
+            v_label_offsets[i + 1] = v_label_chars.size();
+        }
+        wt_t self_wt = g.get_edge_weight(i, i);
+        if (self_wt) {
+            view.num_self_edges++;
+            view.self_edges_weight += self_wt;
+        }
+    }
+    index_labels();
+    view.total_arc_weight = accumulate(v_out_strength.begin(), v_out_strength.end(), 0.0);
+    bind_owned();
+}
+
+void CSR::index_labels() {
+    //  Drops the label arrays when every node is labelled by its own id, otherwise builds
+    //  the sorted index used by get_node_id.
+    id_type num_nodes = v_out_offsets.size() - 1;
+    bool identity_labels = true;
+    for (id_type i = 0; identity_labels && i + 1 < v_label_offsets.size(); i++) {
+        string label(v_label_chars.begin() + v_label_offsets[i], v_label_chars.begin() + v_label_offsets[i + 1]);
+        identity_labels = (label == id_to_label(i));
+    }
+    v_label_order.clear();
+    if (identity_labels) {
+        v_label_offsets.clear();
+        v_label_chars.clear();
+    } else {
+        v_label_order.assign(num_nodes, 0);
+        for (id_type i = 0; i < num_nodes; i++) v_label_order[i] = i;
+        sort(v_label_order.begin(), v_label_order.end(), csr_label_less(v_label_offsets, v_label_chars));
+    }
+}
+
+void fill_csr_from_edges(id_type num_nodes, const vector<id_type>& rows, const vector<id_type>& cols, const vector<wt_t>& weights, bool mirror, bool weighted,
+        vector<id_type>& offsets, vector<id_type>& neighbors, vector<wt_t>& arc_weights, vector<wt_t>& strengths) {
+    //  Count, prefix sum and scatter. Every arc carries the position of its edge in the
+    //  input, so that once a slice is sorted the duplicates resolve to their first
+    //  occurrence, as repeated add_edge calls would. Edges of weight 0 are dropped and
+    //  mirror adds the reverse arc of every non self edge (undirected graphs).
+    id_type num_edges = rows.size();
+    vector<id_type> cursor(num_nodes + 1, 0);
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel for shared(rows,cols,weights,cursor)
+#endif
+    for (id_type k = 0; k < num_edges; k++) {
+        if (weights.size() && !weights[k]) continue;
+#ifdef ENABLE_MULTITHREADING
+#pragma omp atomic
+#endif
+        cursor[rows[k] + 1]++;
+        if (mirror && rows[k] != cols[k]) {
+#ifdef ENABLE_MULTITHREADING
+#pragma omp atomic
+#endif
+            cursor[cols[k] + 1]++;
+        }
+    }
+    for (id_type i = 0; i < num_nodes; i++) cursor[i + 1] += cursor[i];
+    vector< pair<id_type, id_type> > slots(cursor[num_nodes]);
+    vector<id_type> next(cursor.begin(), cursor.end() - 1);
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel for shared(rows,cols,weights,slots,next)
+#endif
+    for (id_type k = 0; k < num_edges; k++) {
+        if (weights.size() && !weights[k]) continue;
+        id_type pos;
+#ifdef ENABLE_MULTITHREADING
+#pragma omp atomic capture
+#endif
+        pos = next[rows[k]]++;
+        slots[pos] = make_pair(cols[k], k);
+        if (mirror && rows[k] != cols[k]) {
+#ifdef ENABLE_MULTITHREADING
+#pragma omp atomic capture
+#endif
+            pos = next[cols[k]]++;
+            slots[pos] = make_pair(rows[k], k);
+        }
+    }
+    offsets.assign(num_nodes + 1, 0);
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel for schedule(dynamic,256) shared(slots,cursor,offsets)
+#endif
+    for (id_type i = 0; i < num_nodes; i++) {
+        sort(slots.begin() + cursor[i], slots.begin() + cursor[i + 1]);
+        id_type kept = 0;
+        for (id_type j = cursor[i]; j < cursor[i + 1]; j++)
+            if (!kept || slots[j].first != slots[cursor[i] + kept - 1].first) slots[cursor[i] + kept++] = slots[j];
+        offsets[i + 1] = kept;
+    }
+    for (id_type i = 0; i < num_nodes; i++) offsets[i + 1] += offsets[i];
+    neighbors.assign(offsets[num_nodes], 0);
+    if (weighted) arc_weights.assign(offsets[num_nodes], 0);
+    else arc_weights.clear();
+    strengths.assign(num_nodes, 0);
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel for schedule(dynamic,256) shared(slots,cursor,offsets,neighbors,arc_weights,strengths,weights)
+#endif
+    for (id_type i = 0; i < num_nodes; i++) {
+        for (id_type j = 0; j < offsets[i + 1] - offsets[i]; j++) {
+            const pair<id_type, id_type>& slot = slots[cursor[i] + j];
+            wt_t weight = (weighted && weights.size()) ? weights[slot.second] : 1;
+            neighbors[offsets[i] + j] = slot.first;
+            if (weighted) arc_weights[offsets[i] + j] = weight;
+            strengths[i] += weight;
+        }
+    }
+}
+
+void CSR::populate_from_edges(bool directed, bool weighted, id_type num_nodes, const vector<id_type>& from, const vector<id_type>& to, const vector<wt_t>& weights) {
+    //  Builds the CSR in one pass from an edge list over the ids [0,num_nodes), with the
+    //  result of calling graph::add_edge for every edge in order on an empty graph. weights
+    //  may be empty, in which case every edge weighs 1. Every node is labelled by its id
+    //  until set_node_labels is called.
+    clear();
+    view.directed = directed;
+    view.weighted = weighted;
+    fill_csr_from_edges(num_nodes, from, to, weights, !directed, weighted, v_out_offsets, v_out_neighbors, v_out_weights, v_out_strength);
+    if (directed) fill_csr_from_edges(num_nodes, to, from, weights, false, weighted, v_in_offsets, v_in_neighbors, v_in_weights, v_in_strength);
+    view.num_arcs = v_out_neighbors.size();
+    for (id_type i = 0; i < num_nodes; i++) {
+        vector<id_type>::const_iterator first = v_out_neighbors.begin() + v_out_offsets[i], last = v_out_neighbors.begin() + v_out_offsets[i + 1];
+        vector<id_type>::const_iterator pos = lower_bound(first, last, i);
+        if (pos != last && *pos == i) {
+            view.num_self_edges++;
+            view.self_edges_weight += (weighted) ? v_out_weights[pos - v_out_neighbors.begin()] : 1;
         }
     }
+    view.total_arc_weight = accumulate(v_out_strength.begin(), v_out_strength.end(), 0.0);
+    bind_owned();
+}
+
+void CSR::set_node_labels(vector<id_type>& offsets, vector<char>& chars) {
+    //  Takes over the label arrays (offsets has get_num_nodes()+1 entries); the arguments
+    //  are left empty.
+    v_label_offsets.swap(offsets);
+    v_label_chars.swap(chars);
+    offsets.clear();
+    chars.clear();
+    index_labels();
+    bind_owned();
+}
+
+void CSR::set_graph_name(const string& name) {
+    graph_name = name;
+}
+
+string CSR::get_node_label(id_type id) const {
+    if (id >= view.num_nodes) return string("");
+    if (!view.label_offsets) return id_to_label(id);
+    return string(view.label_chars + view.label_offsets[id], view.label_chars + view.label_offsets[id + 1]);
+}
+
+id_type CSR::get_node_id(const string& label) const {
+    //  Returns get_num_nodes() when the label is absent, as graph does.
+    if (!view.label_offsets) {
+        id_type id;
+        return (label_to_id(label, id) && id < view.num_nodes) ? id : view.num_nodes;
+    }
+    id_type low = 0, high = view.num_nodes;
+    while (low < high) {
+        id_type mid = low + (high - low) / 2, id = view.label_order[mid];
+        const char* first = view.label_chars + view.label_offsets[id];
+        const char* last = view.label_chars + view.label_offsets[id + 1];
+        if (lexicographical_compare(first, last, label.begin(), label.end())) low = mid + 1;
+        else high = mid;
+    }
+    if (low < view.num_nodes) {
+        id_type id = view.label_order[low];
+        if (label.size() == view.label_offsets[id + 1] - view.label_offsets[id] && equal(label.begin(), label.end(), view.label_chars + view.label_offsets[id]))
+            return id;
+    }
+    return view.num_nodes;
+}
+
+wt_t CSR::get_density() const {
+    id_type n = get_num_nodes();
+    double denom = n * ((double) n + (double) (get_num_self_edges() ? 0 : -1));
+    return (is_directed() ? 1 : 2)*get_num_edges() / denom;
+}
+
+double CSR::extreme_weight(bool max) const {
+    if (!is_weighted()) return 1;
+    double minimum = numeric_limits<double>::infinity();
+    double maximum = -1 * numeric_limits<double>::infinity();
+    if (view.out_weights) {
+        for (id_type i = 0; i < view.num_arcs; i++) {
+            if (view.out_weights[i] < minimum)
+                minimum = view.out_weights[i];
+            if (view.out_weights[i] > maximum)
+                maximum = view.out_weights[i];
+        }
+    }
+    if (max)
+        return maximum;
+    else
+        return minimum;
+}
+
+double CSR::minimum_weight() const {
+    return extreme_weight(0);
+}
+
+double CSR::maximum_weight() const {
+    return extreme_weight(1);
+}
+
+vector<struct edge> CSR::get_all_edges() const {
+    vector<struct edge> all_edges;
+    all_edges.reserve(view.num_arcs);
+    for (id_type i = 0; i < get_num_nodes(); i++)
+        for (edgeIter eit = out_edges_begin(i); eit != out_edges_end(i); eit++)
+            all_edges.push_back(edge(i, eit->first, eit->second));
     return all_edges;
 }
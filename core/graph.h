@@ -14,6 +14,8 @@
 
 namespace CDLib {
 
+    class CSR;
+
     class graph {
     private:
 
@@ -42,6 +44,7 @@ namespace CDLib {
 
         string get_node_label(id_type id) const;
         id_type get_node_id(const string& label) const;
+        bool has_identity_labels() const;
 
         id_type get_node_in_degree(id_type id) const;
         id_type get_node_in_degree(const string& label) const;
@@ -79,6 +82,8 @@ namespace CDLib {
         id_type add_node();
 
         bool add_edge(id_type from_id, id_type to_id, wt_t weight);
+        id_type add_edges(const vector<id_type>& from, const vector<id_type>& to, const vector<wt_t>& weights);
+        id_type add_edges(const vector<struct edge>& edges);
         void add_self_edges(double weight);
         void remove_self_edges();
         wt_t add_edge(const string& from_label, const string& to_label, wt_t weight);
@@ -106,6 +111,7 @@ namespace CDLib {
 
         bool remove_all_edges();
         bool clear();
+        bool assign(const CSR& csr);
 
         bool convert_to_unweighted(double threshold);
         bool convert_to_undirected();
@@ -186,109 +192,242 @@ namespace CDLib {
         return edge_iterator(&g, g.get_num_nodes() - 1, g.out_edges_end(g.get_num_nodes() - 1));
     }
 
+    class csr_edges_iterator {
+        //  Walks the contiguous neighbor (and weight) arrays of a CSR node. It exposes
+        //  the same ->first/->second interface as adjacent_edges_iterator so that the
+        //  algorithm bodies written against graph compile unchanged against CSR.
+    private:
+        const id_type* nit;
+        const wt_t* wit;
+        mutable pair<id_type, wt_t> current;
+    public:
+        typedef forward_iterator_tag iterator_category;
+        typedef pair<id_type, wt_t> value_type;
+        typedef ptrdiff_t difference_type;
+        typedef const pair<id_type, wt_t>* pointer;
+        typedef const pair<id_type, wt_t>& reference;
+
+        csr_edges_iterator() : nit(NULL), wit(NULL) {
+        }
+
+        csr_edges_iterator(const id_type* n, const wt_t* w) : nit(n), wit(w) {
+        }
+
+        inline reference operator *() const {
+            current.first = *nit;
+            current.second = (wit) ? *wit : 1;
+            return current;
+        }
+
+        inline pointer operator ->() const {
+            return &(operator *());
+        }
+
+        inline csr_edges_iterator& operator ++() {
+            nit++;
+            if (wit) wit++;
+            return (*this);
+        }
+
+        inline csr_edges_iterator operator ++(int) {
+            csr_edges_iterator old(*this);
+            ++(*this);
+            return old;
+        }
+
+        inline difference_type operator -(const csr_edges_iterator& rhs) const {
+            return nit - rhs.nit;
+        }
+
+        inline bool operator ==(const csr_edges_iterator& rhs) const {
+            return nit == rhs.nit;
+        }
+
+        inline bool operator !=(const csr_edges_iterator& rhs) const {
+            return nit != rhs.nit;
+        }
+
+        inline const id_type* neighbor_ptr() const {
+            return nit;
+        }
+
+        inline const wt_t* weight_ptr() const {
+            return wit;
+        }
+    };
+
     class CSR {
+        //  Frozen, read-only compressed sparse row view of a graph. Out-edges and in-edges
+        //  are kept in contiguous offset/neighbor/weight arrays with the neighbors of each
+        //  node sorted by id. Undirected graphs share a single set of arrays for both
+        //  directions and unweighted graphs do not store weights at all (every edge weighs 1).
+        //  The accessors mirror those of graph so that the read-only algorithms can be
+        //  instantiated for either backend. The arrays are either owned by the CSR or
+        //  borrowed from a memory mapped file which stays mapped while any copy refers to it.
     private:
-        vector<id_type> xadj;
-        vector<id_type> adjncy;
-        vector<double> weights;
-        double total_weight;
+        csr_arrays view;
+        vector<id_type> v_out_offsets;
+        vector<id_type> v_out_neighbors;
+        vector<wt_t> v_out_weights;
+        vector<id_type> v_in_offsets;
+        vector<id_type> v_in_neighbors;
+        vector<wt_t> v_in_weights;
+        vector<wt_t> v_out_strength;
+        vector<wt_t> v_in_strength;
+        vector<id_type> v_label_offsets;
+        vector<char> v_label_chars;
+        vector<id_type> v_label_order;
+        shared_ptr<const void> region;
+        string graph_name;
+
+        void bind_owned();
+        void index_labels();
+
     public:
-        typedef vector<id_type>::const_iterator edgeIter;
+        typedef csr_edges_iterator edgeIter;
+
+        CSR();
+        CSR(const graph & g);
+        CSR(const CSR & other);
+        CSR& operator=(const CSR & other);
+        void populate_from_graph(const graph & g);
+        void populate_from_edges(bool directed, bool weighted, id_type num_nodes, const vector<id_type>& from, const vector<id_type>& to, const vector<wt_t>& weights);
+        void set_node_labels(vector<id_type>& offsets, vector<char>& chars);
+        void set_graph_name(const string& name);
+        void attach(const csr_arrays& arrays, shared_ptr<const void> owner, const string& name);
+        void clear();
+
+        inline const csr_arrays& arrays() const {
+            return view;
+        }
+
+        inline bool is_mapped() const {
+            return (bool) region;
+        }
+
+        inline bool is_directed() const {
+            return view.directed;
+        }
+
+        inline bool is_weighted() const {
+            return view.weighted;
+        }
+
+        inline string get_graph_name() const {
+            return graph_name;
+        }
 
         inline id_type get_num_nodes() const {
-            return xadj.size();
+            return view.num_nodes;
         }
 
         inline id_type get_num_edges() const {
-            return adjncy.size();
+            if (view.directed) return view.num_arcs;
+            else return (view.num_arcs + view.num_self_edges) / 2;
         }
 
-        inline double get_total_weight() const {
-            if (weights.size()) return total_weight;
-            else return 0;
+        inline id_type get_num_self_edges() const {
+            return view.num_self_edges;
         }
 
-        inline id_type get_node_degree(id_type i) const {
-            if (i < xadj.size() - 1) return xadj[i + 1] - xadj[i];
-            else return (adjncy.size() - xadj[i]);
+        inline wt_t get_total_weight() const {
+            if (view.directed) return view.total_arc_weight;
+            else return (view.total_arc_weight + view.self_edges_weight) / 2;
         }
 
-        inline bool is_weighted() const {
-            return weights.size();
+        inline wt_t get_self_edges_weight() const {
+            return view.self_edges_weight;
+        }
+
+        wt_t get_density() const;
+        string get_node_label(id_type id) const;
+        id_type get_node_id(const string& label) const;
+
+        inline id_type get_node_out_degree(id_type id) const {
+            if (id < view.num_nodes) return view.out_offsets[id + 1] - view.out_offsets[id];
+            return 0;
+        }
+
+        inline id_type get_node_in_degree(id_type id) const {
+            if (id < view.num_nodes) return view.in_offsets[id + 1] - view.in_offsets[id];
+            return 0;
+        }
+
+        inline id_type get_node_degree(id_type id) const {
+            return get_node_out_degree(id);
+        }
+
+        inline wt_t get_node_out_weight(id_type id) const {
+            if (id < view.num_nodes) return view.out_strength[id];
+            return 0;
+        }
+
+        inline wt_t get_node_in_weight(id_type id) const {
+            if (id < view.num_nodes) return view.in_strength[id];
+            return 0;
         }
 
         inline edgeIter out_edges_begin(id_type id) const {
-            if (id < xadj.size())return adjncy.begin() + xadj[id];
-            else return adjncy.end();
+            if (id >= view.num_nodes) id = view.num_nodes;
+            return edgeIter(view.out_neighbors + view.out_offsets[id], (view.out_weights) ? view.out_weights + view.out_offsets[id] : NULL);
         }
 
         inline edgeIter out_edges_end(id_type id) const {
-            if (id + 1 < xadj.size())return adjncy.begin() + xadj[id + 1];
-            else return adjncy.end();
+            if (id >= view.num_nodes) return out_edges_begin(id);
+            return edgeIter(view.out_neighbors + view.out_offsets[id + 1], (view.out_weights) ? view.out_weights + view.out_offsets[id + 1] : NULL);
         }
 
-        inline edgeIter edges_begin() const {
-            return adjncy.begin();
+        inline edgeIter in_edges_begin(id_type id) const {
+            if (id >= view.num_nodes) id = view.num_nodes;
+            return edgeIter(view.in_neighbors + view.in_offsets[id], (view.in_weights) ? view.in_weights + view.in_offsets[id] : NULL);
         }
 
-        inline edgeIter edges_end() const {
-            return adjncy.end();
+        inline edgeIter in_edges_end(id_type id) const {
+            if (id >= view.num_nodes) return in_edges_begin(id);
+            return edgeIter(view.in_neighbors + view.in_offsets[id + 1], (view.in_weights) ? view.in_weights + view.in_offsets[id + 1] : NULL);
         }
 
-        edgeIter find_edge(id_type i, id_type j) const {
-            if (i < xadj.size() && j < xadj.size()) {
-                edgeIter it;
-                if (i < xadj.size() - 1)it = lower_bound(adjncy.begin() + xadj[i], adjncy.begin() + xadj[i + 1], j);
-                else it = lower_bound(adjncy.begin() + xadj[i], adjncy.end(), j);
-                return it;
-            }
-            return adjncy.end();
+        inline edgeIter edges_begin() const {
+            return out_edges_begin(0);
         }
 
-        inline double get_edge_weight(edgeIter eit) const {
-            if (eit != adjncy.end() && weights.size())return *(weights.begin() + (eit - adjncy.begin()));
-            else if (eit != adjncy.end()) return 1;
-            return 0;
+        inline edgeIter edges_end() const {
+            return out_edges_end(view.num_nodes - 1);
         }
 
-        inline double get_edge_weight(id_type i, id_type j) const {
-            return get_edge_weight(find_edge(i, j));
-        }
-
-        void populate_from_graph(const graph & g) {
-            adjncy.clear();
-            weights.clear();
-            xadj.assign(g.get_num_nodes(), 0);
-            id_type num_edges;
-            total_weight = g.get_total_weight();
-            if (g.is_directed()) num_edges = g.get_num_edges();
-            else num_edges = (2 * g.get_num_edges()) - g.get_num_self_edges();
-            adjncy.reserve(num_edges);
-            if (g.is_weighted()) weights.reserve(num_edges);
-            for (id_type i = 0; i < g.get_num_nodes(); i++) {
-                if (i)xadj[i] = xadj[i - 1] + g.get_node_out_degree(i - 1);
-                vector<id_type> out_edges;
-                vector<double> out_edge_wts;
-                out_edges.reserve(g.get_node_out_degree(i));
-                for (adjacent_edges_iterator aeit = g.out_edges_begin(i); aeit != g.out_edges_end(i); aeit++)out_edges.push_back(aeit->first);
-                sort(out_edges.begin(), out_edges.end());
-                copy(out_edges.begin(), out_edges.end(), back_inserter(adjncy));
-                if (g.is_weighted()) {
-                    out_edge_wts.reserve(g.get_node_out_degree(i));
-                    for (id_type j = 0; j < out_edge_wts.size(); j++)out_edge_wts.push_back(g.get_edge_weight(i, j));
-                    copy(out_edge_wts.begin(), out_edge_wts.end(), back_inserter(weights));
-                }
-            }
+        inline edgeIter find_edge(id_type from_id, id_type to_id) const {
+            //  Binary search on the sorted neighbors. Returns out_edges_end(from_id) when absent.
+            edgeIter eit = out_edges_begin(from_id), eend = out_edges_end(from_id);
+            const id_type* pos = lower_bound(eit.neighbor_ptr(), eend.neighbor_ptr(), to_id);
+            if (pos == eend.neighbor_ptr() || *pos != to_id) return eend;
+            return edgeIter(pos, (eit.weight_ptr()) ? eit.weight_ptr() + (pos - eit.neighbor_ptr()) : NULL);
         }
 
-        CSR() {
+        inline wt_t get_edge_weight(id_type from_id, id_type to_id) const {
+            if (from_id >= view.num_nodes || to_id >= view.num_nodes) return 0;
+            edgeIter eit = find_edge(from_id, to_id);
+            if (eit == out_edges_end(from_id)) return 0;
+            return eit->second;
         }
 
-        CSR(const graph & g) {
-            populate_from_graph(g);
-        }
+        vector<struct edge> get_all_edges() const;
+        double extreme_weight(bool max) const;
+        double minimum_weight() const;
+        double maximum_weight() const;
     };
 
+    //  Graph backend concept. Every read-only algorithm that is templated over G expects:
+    //  get_num_nodes(), get_num_edges(), is_directed(), is_weighted(), get_node_label(id),
+    //  get_node_out_degree(id), get_node_in_degree(id), get_node_out_weight(id),
+    //  get_node_in_weight(id), get_edge_weight(from, to) and out/in_edges_begin/end(id).
+    //  The edge iterators yield the neighbor in ->first and the edge weight in ->second.
+
+    //  Every translation unit holding templated algorithms instantiates them once per
+    //  backend listed here, so adding a backend only requires an entry in this list.
+#define CDLIB_FOR_EACH_GRAPH_BACKEND(INSTANTIATE) \
+    INSTANTIATE(graph) \
+    INSTANTIATE(CSR)
+
 };
 
 #endif	/* GRAPH_H */
@@ -8,22 +8,27 @@
 #include "graph_operations.h"
 using namespace CDLib;
 
+id_type subgraph_node(const graph& g, id_type id, graph& sg, unordered_map<id_type, id_type>& sg_ids) {
+    //  Id of node id of g in sg, adding it (with its label) on first use.
+    pair<unordered_map<id_type, id_type>::iterator, bool> ins = sg_ids.insert(make_pair(id, sg.get_num_nodes()));
+    if (ins.second) sg.add_node(g.get_node_label(id));
+    return ins.first->second;
+}
+
 id_type CDLib::extract_subgraph(const graph& g, const node_set& nodes, graph& sg) {
     sg.clear();
     if (sg.is_directed() != g.is_directed() && sg.is_weighted() != g.is_weighted()) return 0;
     id_type min_node_id = g.get_num_nodes();
+    unordered_map<id_type, id_type> sg_ids;
+    vector<edge> edges;
     for (node_set::const_iterator nit = nodes.begin(); nit != nodes.end(); nit++) {
         if(*nit < min_node_id) min_node_id = *nit;
-        string first_label = g.get_node_label(*nit);
-        sg.add_node(first_label);
-        for (adjacent_edges_iterator aeit = g.out_edges_begin(*nit); aeit != g.out_edges_end(*nit); aeit++) {
-            if (nodes.find(aeit->first) != nodes.end()) {
-                string second_label = g.get_node_label(aeit->first);
-                sg.add_node(second_label);
-                sg.add_edge(first_label, second_label, aeit->second);
-            }
-        }
+        id_type from_id = subgraph_node(g, *nit, sg, sg_ids);
+        for (adjacent_edges_iterator aeit = g.out_edges_begin(*nit); aeit != g.out_edges_end(*nit); aeit++)
+            if (nodes.find(aeit->first) != nodes.end())
+                edges.push_back(edge(from_id, subgraph_node(g, aeit->first, sg, sg_ids), aeit->second));
     }
+    sg.add_edges(edges);
     sg.set_graph_name(g.get_graph_name() + "_sg_" + g.get_node_label(min_node_id));
     return sg.get_num_edges();
 }
@@ -32,31 +37,16 @@ id_type CDLib::copy_graph(const graph& src, graph& dst) {
     dst.clear();
     dst.set_graph_name(src.get_graph_name());
     for (id_type i = 0; i < src.get_num_nodes(); i++) dst.add_node(src.get_node_label(i));
-    for (id_type i = 0; i < src.get_num_nodes(); i++)
-        for (adjacent_edges_iterator aeit = src.out_edges_begin(i); aeit != src.out_edges_end(i); aeit++)
-            dst.add_edge(i, aeit->first, aeit->second);
+    dst.add_edges(src.get_all_edges());
     return 0;
 }
 
 void CDLib::sample_graph(const graph&g, node_set& seeds, id_type hop_dist, graph& sample) {
     node_set new_nodes;
+    bfs_engine<graph> engine(g);
     for (node_set::iterator nit = seeds.begin(); nit != seeds.end(); nit++) {
-        vector<double> distances(g.get_num_nodes(), numeric_limits<double>::infinity());
-        queue<id_type> bfs_queue;
-        bfs_queue.push(*nit);
-        distances[*nit] = 0;
-        new_nodes.insert(*nit);
-        while (!bfs_queue.empty()) {
-            id_type curr = bfs_queue.front();
-            bfs_queue.pop();
-            for (adjacent_edges_iterator aeit = g.out_edges_begin(curr); aeit != g.out_edges_end(curr); aeit++) {
-                if (distances[aeit->first] == numeric_limits<double>::infinity() && distances[curr] < hop_dist) {
-                    distances[aeit->first] = distances[curr] + 1;
-                    new_nodes.insert(aeit->first);
-                    bfs_queue.push(aeit->first);
-                }
-            }
-        }
+        engine.run(*nit, hop_dist);
+        new_nodes.insert(engine.get_order().begin(), engine.get_order().end());
     }
     extract_subgraph(g, new_nodes, sample);
 }
@@ -9,6 +9,7 @@
 #define	GRAPH_OPERATIONS_H
 
 #include "graph.h"
+#include "paths_and_components.h"
 
 namespace CDLib {
     
@@ -7,7 +7,8 @@
 
 #include "graph_properties.h"
 
-void CDLib::get_degree_histogram(const graph& g, vector<id_type>& dist, bool in_degrees) {
+template <typename G>
+void CDLib::get_degree_histogram(const G& g, vector<id_type>& dist, bool in_degrees) {
     vector<id_type> degrees;
     get_degree_sequence(g, degrees, in_degrees);
     get_discrete_distribution<id_type > (degrees, dist);
@@ -26,7 +27,8 @@ void CDLib::get_degree_histogram(const graph& g, vector<id_type>& dist, bool in_
 //    return expectation;
 //}
 
-double CDLib::get_degree_distribution(const graph& g, vector<double>& dist, bool in_degrees) {
+template <typename G>
+double CDLib::get_degree_distribution(const G& g, vector<double>& dist, bool in_degrees) {
     dist.clear();
     double expectation = 0;
     for (id_type i = 0; i < g.get_num_nodes(); i++) {
@@ -40,7 +42,8 @@ double CDLib::get_degree_distribution(const graph& g, vector<double>& dist, bool
     return expectation;
 }
 
-double CDLib::get_excess_degree_distribution(const graph& g, vector<double>& dist, bool in_degrees) {
+template <typename G>
+double CDLib::get_excess_degree_distribution(const G& g, vector<double>& dist, bool in_degrees) {
     dist.clear();
     double expectation = 0;
     double mean = get_degree_distribution(g, dist, in_degrees);
@@ -53,7 +56,8 @@ double CDLib::get_excess_degree_distribution(const graph& g, vector<double>& dis
     return expectation;
 }
 
-double CDLib::get_degree_variance(const graph& g, bool in_degrees) {
+template <typename G>
+double CDLib::get_degree_variance(const G& g, bool in_degrees) {
     if (g.get_num_nodes() <= 0)
         return 0;
     vector<id_type> degrees;
@@ -61,7 +65,8 @@ double CDLib::get_degree_variance(const graph& g, bool in_degrees) {
     return variance(degrees);
 }
 
-double CDLib::get_degree_assortativity_coefficient(const graph& g, vector<double>& assortativity) {
+template <typename G>
+double CDLib::get_degree_assortativity_coefficient(const G& g, vector<double>& assortativity) {
     /* Gives the assortativity contributions from each node */
     /* The calculation is based on Classifying Complex Networks using Unbiased Local Assortativity, 2010 paper by Piraveenan et al. */
     /* This should only be used for undirected graphs, otherwise this will lead to incorrect results. */
@@ -90,7 +95,7 @@ double CDLib::get_degree_assortativity_coefficient(const graph& g, vector<double
 #endif
     for (id_type i = 0; i < g.get_num_nodes(); i++) {
         double avg_excess_degree_neighbour = 0;
-        for (adjacent_edges_iterator aeit = g.in_edges_begin(i); aeit != g.in_edges_end(i); aeit++) {
+        for (auto aeit = g.in_edges_begin(i); aeit != g.in_edges_end(i); aeit++) {
             avg_excess_degree_neighbour += g.get_node_in_degree(aeit->first);
         }
         if (g.get_node_in_degree(i) > 0) {
@@ -102,7 +107,8 @@ double CDLib::get_degree_assortativity_coefficient(const graph& g, vector<double
     return assortativity_coef;
 }
 
-double CDLib::unbiased_assortativity(const graph& g) {
+template <typename G>
+double CDLib::unbiased_assortativity(const G& g) {
     /* This is the new way of unbiased assortativity for undirected graph. This is weighted by region-wise assorativity. */
     double weighted_assortativity = 0;
     vector<double> assortativity_node;
@@ -117,27 +123,29 @@ double CDLib::unbiased_assortativity(const graph& g) {
     return weighted_assortativity;
 }
 
-double CDLib::regularity_configuration_model(const graph& g) {
+template <typename G>
+double CDLib::regularity_configuration_model(const G& g) {
     double regularity = 0;
     #ifdef ENABLE_MULTITHREADING
 #pragma omp parallel for shared(g) reduction(+:regularity)
 #endif
     for (id_type i = 0; i < g.get_num_nodes(); i++) {
         for (id_type j = 0; j < g.get_num_nodes(); j++) {
-            regularity += ((double)(g.get_node_out_degree(i) * g.get_node_in_degree(j)) / (1 + abs(g.get_node_out_degree(i) - g.get_node_in_degree(j))));
+            regularity += ((double)(g.get_node_out_degree(i) * g.get_node_in_degree(j)) / (1 + fabs((double) g.get_node_out_degree(i) - (double) g.get_node_in_degree(j))));
         }
     }
     regularity = regularity/(4 * (g.get_total_weight() * g.get_total_weight()));
     return regularity;
 }
 
-double CDLib::regularity(const graph& g) {
+template <typename G>
+double CDLib::regularity(const G& g) {
     double harmonic = 0;
 #ifdef ENABLE_MULTITHREADING
 #pragma omp parallel for shared(g) reduction(+:harmonic)
 #endif
     for (id_type i = 0; i < g.get_num_nodes(); i++)
-        for (adjacent_edges_iterator aeit = g.out_edges_begin(i); aeit != g.out_edges_end(i); aeit++)
+        for (auto aeit = g.out_edges_begin(i); aeit != g.out_edges_end(i); aeit++)
             harmonic += 1 / (1 + abs(g.get_node_out_weight(i) - g.get_node_in_weight(aeit->first)));
     if (g.get_total_weight())
         return harmonic / (2 * g.get_total_weight());
@@ -145,11 +153,13 @@ double CDLib::regularity(const graph& g) {
         return 1;
 }
 
-double CDLib::normalized_regularity(const graph& g) {
+template <typename G>
+double CDLib::normalized_regularity(const G& g) {
     return regularity(g)/regularity_configuration_model(g);
 }
 
-double CDLib::regularity(const graph& g, vector<double>& node_regularity) {
+template <typename G>
+double CDLib::regularity(const G& g, vector<double>& node_regularity) {
     // This function is based on node degree and does not consider weights
     double harmonic = 0;
     double normalization = 2 * g.get_num_edges();
@@ -164,8 +174,8 @@ double CDLib::regularity(const graph& g, vector<double>& node_regularity) {
 #pragma omp parallel for shared(g) reduction(+:harmonic)
 #endif
     for (id_type i = 0; i < g.get_num_nodes(); i++) {
-        for (adjacent_edges_iterator aeit = g.out_edges_begin(i); aeit != g.out_edges_end(i); aeit++) {
-            node_regularity[i] += 1/(1+abs(g.get_node_out_degree(i) - g.get_node_in_degree(aeit->first)));
+        for (auto aeit = g.out_edges_begin(i); aeit != g.out_edges_end(i); aeit++) {
+            node_regularity[i] += 1/(1+fabs((double) g.get_node_out_degree(i) - (double) g.get_node_in_degree(aeit->first)));
         }
         node_regularity[i] /= normalization;
         harmonic += node_regularity[i];
@@ -173,7 +183,8 @@ double CDLib::regularity(const graph& g, vector<double>& node_regularity) {
     return harmonic;
 }
 
-double CDLib::normalized_regularity(const graph& g, vector<double>& node_regularity) {
+template <typename G>
+double CDLib::normalized_regularity(const G& g, vector<double>& node_regularity) {
     double graph_reg = regularity(g,node_regularity);
     double configuration_model = regularity_configuration_model(g);
     for (id_type i=0; i<node_regularity.size(); i++)
@@ -181,7 +192,8 @@ double CDLib::normalized_regularity(const graph& g, vector<double>& node_regular
     return graph_reg/configuration_model;
 }
 
-double newman_assortativity_directed(const graph& g) {
+template <typename G>
+double newman_assortativity_directed(const G& g) {
     double edge_factor = g.get_num_edges();
     double assortaivity_coefficient = 0;
     vector<double> excess_degree_in, excess_degree_out;
@@ -208,7 +220,7 @@ double newman_assortativity_directed(const graph& g) {
     double std_excess_out = sqrt(second_moment_excess_out - (first_moment_excess_out * first_moment_excess_out));
     vector< vector<double> > joint_distt(excess_degree_out.size(), vector<double>(excess_degree_in.size(), 0));
     for (id_type i = 0; i < g.get_num_nodes(); i++) {
-        for (adjacent_edges_iterator aeit = g.out_edges_begin(i); aeit != g.out_edges_end(i); aeit++) {
+        for (auto aeit = g.out_edges_begin(i); aeit != g.out_edges_end(i); aeit++) {
             //This place will not be reached when g.get_node_out_degree(i) = 0 OR g.get_node_in_degree(aeit->first) = 0;
             joint_distt[g.get_node_out_degree(i) - 1][g.get_node_in_degree(aeit->first) - 1] += 1 / edge_factor;
         }
@@ -226,7 +238,8 @@ double newman_assortativity_directed(const graph& g) {
     return assortaivity_coefficient;
 }
 
-double newman_assortativity_undirected(const graph& g) {
+template <typename G>
+double newman_assortativity_undirected(const G& g) {
     /* The calculation is based on Assortative Mixing in Networks, 2002 paper by MEJ Newman */
     double edge_factor = 2 * g.get_num_edges();
     double assortaivity_coefficient = 0;
@@ -246,7 +259,7 @@ double newman_assortativity_undirected(const graph& g) {
         return 1;
     vector< vector<double> > joint_distt(excess_degree.size(), vector<double>(excess_degree.size(), 0));
     for (id_type i = 0; i < g.get_num_nodes(); i++) {
-        for (adjacent_edges_iterator aeit = g.out_edges_begin(i); aeit != g.out_edges_end(i); aeit++) {
+        for (auto aeit = g.out_edges_begin(i); aeit != g.out_edges_end(i); aeit++) {
             //This place will not be reached when g.get_node_out_degree(i) = 0 OR g.get_node_out_degree(aeit->first) = 0;
             joint_distt[g.get_node_out_degree(i) - 1][g.get_node_out_degree(aeit->first) - 1] += 1 / edge_factor;
         }
@@ -269,7 +282,8 @@ double newman_assortativity_undirected(const graph& g) {
     return assortaivity_coefficient;
 }
 
-double CDLib::get_degree_assortativity_coefficient(const graph& g) {
+template <typename G>
+double CDLib::get_degree_assortativity_coefficient(const G& g) {
     /* The calculation is based on Assortative Mixing in Networks, 2002 paper by MEJ Newman */
     if (g.get_num_nodes() <= 0)
         return 0;
@@ -279,7 +293,8 @@ double CDLib::get_degree_assortativity_coefficient(const graph& g) {
         return newman_assortativity_undirected(g);
 }
 
-double CDLib::get_rich_club_coefficient(const graph& g, id_type start_hub_degree_def) {
+template <typename G>
+double CDLib::get_rich_club_coefficient(const G& g, id_type start_hub_degree_def) {
     /* This implementation is accordance to The rich-club phenomenon in the Internet topology, 2004 paper by S. Zhou and R. J. Mondragon */
     id_type num_rich_nodes = 0, num_rich_edges = 0;
 #ifdef ENABLE_MULTITHREADING
@@ -288,7 +303,7 @@ double CDLib::get_rich_club_coefficient(const graph& g, id_type start_hub_degree
     for (id_type i = 0; i < g.get_num_nodes(); i++) {
         if (g.get_node_out_degree(i) >= start_hub_degree_def) {
             num_rich_nodes++;
-            for (adjacent_edges_iterator aeit = g.out_edges_begin(i); aeit != g.out_edges_end(i); aeit++) {
+            for (auto aeit = g.out_edges_begin(i); aeit != g.out_edges_end(i); aeit++) {
                 if (g.get_node_out_degree(aeit->first) >= start_hub_degree_def) num_rich_edges++;
             }
         }
@@ -296,7 +311,8 @@ double CDLib::get_rich_club_coefficient(const graph& g, id_type start_hub_degree
     return (double) (2 * num_rich_edges) / (num_rich_nodes * (num_rich_nodes - 1));
 }
 
-double CDLib::normalized_rich_club_coefficient(const graph& g, id_type start_hub_degree_def) {
+template <typename G>
+double CDLib::normalized_rich_club_coefficient(const G& g, id_type start_hub_degree_def) {
     /* This implementation is accordance to Detecting rich-club ordering in complex networks, 2006 paper by Colizza et al. */
     if (start_hub_degree_def <= 0) start_hub_degree_def = 1;
     id_type num_rich_nodes = 0, num_rich_edges = 0;
@@ -308,7 +324,7 @@ double CDLib::normalized_rich_club_coefficient(const graph& g, id_type start_hub
         rich_club_uncorrelated += g.get_node_out_degree(i);
         if (g.get_node_out_degree(i) >= start_hub_degree_def) {
             num_rich_nodes++;
-            for (adjacent_edges_iterator aeit = g.out_edges_begin(i); aeit != g.out_edges_end(i); aeit++) {
+            for (auto aeit = g.out_edges_begin(i); aeit != g.out_edges_end(i); aeit++) {
                 if (g.get_node_out_degree(aeit->first) >= start_hub_degree_def) num_rich_edges++;
             }
         }
@@ -318,7 +334,8 @@ double CDLib::normalized_rich_club_coefficient(const graph& g, id_type start_hub
     return rich_club / rich_club_uncorrelated;
 }
 
-double CDLib::get_poor_club_coefficient(const graph& g, id_type start_hub_degree_def) {
+template <typename G>
+double CDLib::get_poor_club_coefficient(const G& g, id_type start_hub_degree_def) {
     /* This implementation is accordance to Detecting rich-club ordering in complex networks, 2006 paper by Colizza et al. */
     id_type num_rich_nodes = 0, num_rich_edges = 0;
 #ifdef ENABLE_MULTITHREADING
@@ -327,7 +344,7 @@ double CDLib::get_poor_club_coefficient(const graph& g, id_type start_hub_degree
     for (id_type i = 0; i < g.get_num_nodes(); i++) {
         if (g.get_node_out_degree(i) < start_hub_degree_def) {
             num_rich_nodes++;
-            for (adjacent_edges_iterator aeit = g.out_edges_begin(i); aeit != g.out_edges_end(i); aeit++) {
+            for (auto aeit = g.out_edges_begin(i); aeit != g.out_edges_end(i); aeit++) {
                 if (g.get_node_out_degree(aeit->first) < start_hub_degree_def) num_rich_edges++;
             }
         }
@@ -335,7 +352,8 @@ double CDLib::get_poor_club_coefficient(const graph& g, id_type start_hub_degree
     return (double) (2 * num_rich_edges) / (num_rich_nodes * (num_rich_nodes - 1));
 }
 
-double CDLib::kl_divergence_from_random_graph(const graph& g) {
+template <typename G>
+double CDLib::kl_divergence_from_random_graph(const G& g) {
     //    Reports symmetric KL-Divergence of the Degree Distribution from Random graph of same size.
     graph er_graph(0, 0);
     generate_erdos_renyi_graph(er_graph, g.get_num_nodes(), g.get_num_edges());
@@ -345,7 +363,8 @@ double CDLib::kl_divergence_from_random_graph(const graph& g) {
     return kl_divergence_symmetric(distt1, distt2);
 }
 
-double CDLib::distance_from_random_graph(const graph& g, bool hellinger) {
+template <typename G>
+double CDLib::distance_from_random_graph(const G& g, bool hellinger) {
     //    If bool is set, it return Hellinger Distance of the Degree Distribution from Random Graph of same size,
     //    else it returns Bhattacharyya Distance of the Degree Distribution.
     vector<double> distt1, distt2;
@@ -366,7 +385,8 @@ double CDLib::distance_from_random_graph(const graph& g, bool hellinger) {
         return bhattacharyya_distance(distt1, distt2);
 }
 
-double CDLib::connectivity_entropy(const graph& g) {
+template <typename G>
+double CDLib::connectivity_entropy(const G& g) {
     // Connective Entropy of the Network or Information Entropy of the Network
     /* Ortiz-Arroyo, D. (2010). Discovering Sets of Key Players in Social Networks. Computational Social Network Analysis (pp. 27–47). Springer London. doi:10.1007/978-1-84882-229-0_2 */
     double entropy = 0, prob = 0;
@@ -382,7 +402,8 @@ double CDLib::connectivity_entropy(const graph& g) {
     return entropy;
 }
 
-double CDLib::graph_modularity(graph& g) {
+template <typename G>
+double CDLib::graph_modularity(const G& g) {
     /* Functions returns the modularity of the whole graph considering the whole graph as a single community */
     double denominator = 2 * g.get_num_edges();
     double sum = 0;
@@ -404,3 +425,26 @@ double CDLib::graph_modularity(graph& g) {
     }
     return sum;
 }
+
+#define GRAPH_PROPERTIES_INSTANTIATE(G) \
+    template void CDLib::get_degree_histogram<G>(const G&, vector<id_type>&, bool); \
+    template double CDLib::get_degree_distribution<G>(const G&, vector<double>&, bool); \
+    template double CDLib::get_excess_degree_distribution<G>(const G&, vector<double>&, bool); \
+    template double CDLib::get_degree_variance<G>(const G&, bool); \
+    template double CDLib::get_degree_assortativity_coefficient<G>(const G&, vector<double>&); \
+    template double CDLib::get_degree_assortativity_coefficient<G>(const G&); \
+    template double CDLib::unbiased_assortativity<G>(const G&); \
+    template double CDLib::regularity<G>(const G&); \
+    template double CDLib::regularity<G>(const G&, vector<double>&); \
+    template double CDLib::regularity_configuration_model<G>(const G&); \
+    template double CDLib::normalized_regularity<G>(const G&); \
+    template double CDLib::normalized_regularity<G>(const G&, vector<double>&); \
+    template double CDLib::get_rich_club_coefficient<G>(const G&, id_type); \
+    template double CDLib::normalized_rich_club_coefficient<G>(const G&, id_type); \
+    template double CDLib::get_poor_club_coefficient<G>(const G&, id_type); \
+    template double CDLib::kl_divergence_from_random_graph<G>(const G&); \
+    template double CDLib::distance_from_random_graph<G>(const G&, bool); \
+    template double CDLib::connectivity_entropy<G>(const G&); \
+    template double CDLib::graph_modularity<G>(const G&);
+
+CDLIB_FOR_EACH_GRAPH_BACKEND(GRAPH_PROPERTIES_INSTANTIATE)
@@ -16,34 +16,36 @@ using namespace std;
 
 namespace CDLib
 {
-    template <typename T>
-    void get_degree_sequence(const graph& g,vector<T>& degrees, bool in_degrees)
+    //    Routines taking a const G& are templated over the graph backend and are
+    //    instantiated in graph_properties.cpp for each CDLIB_FOR_EACH_GRAPH_BACKEND entry.
+    template <typename G, typename T>
+    void get_degree_sequence(const G& g,vector<T>& degrees, bool in_degrees)
     {
         degrees.clear();
         degrees.assign(g.get_num_nodes(),0);
         for(id_type i=0;i<g.get_num_nodes();i++)
             degrees[i] = (in_degrees)? g.get_node_in_degree(i) : g.get_node_out_degree(i);
     }
-    void get_degree_histogram(const graph& g,vector<id_type>& dist, bool in_degrees);
-    double get_degree_distribution(const graph& g,vector<double>& dist,bool in_degrees);
-    double get_excess_degree_distribution(const graph& g,vector<double>& dist, bool in_degrees);
-    double get_degree_variance(const graph& g,bool in_degrees);
-    double get_degree_assortativity_coefficient(const graph& g,vector<double>& assortativity);
-    double get_degree_assortativity_coefficient(const graph& g);
-    double unbiased_assortativity(const graph& g);
-    double regularity(const graph& g);
-    double regularity(const graph& g, vector<double>& node_regularity); // Based only on node degree
-    double regularity_configuration_model(const graph& g); // Regularity of the equivalent configuration model
-    double normalized_regularity(const graph& g);
-    double normalized_regularity(const graph& g, vector<double>& node_regularity);
-    double get_rich_club_coefficient(const graph& g,id_type start_hub_degree);
-    double normalized_rich_club_coefficient(const graph& g,id_type start_hub_degree_def);
-    double get_poor_club_coefficient(const graph& g,id_type start_hub_degree);
+    template <typename G> void get_degree_histogram(const G& g,vector<id_type>& dist, bool in_degrees);
+    template <typename G> double get_degree_distribution(const G& g,vector<double>& dist,bool in_degrees);
+    template <typename G> double get_excess_degree_distribution(const G& g,vector<double>& dist, bool in_degrees);
+    template <typename G> double get_degree_variance(const G& g,bool in_degrees);
+    template <typename G> double get_degree_assortativity_coefficient(const G& g,vector<double>& assortativity);
+    template <typename G> double get_degree_assortativity_coefficient(const G& g);
+    template <typename G> double unbiased_assortativity(const G& g);
+    template <typename G> double regularity(const G& g);
+    template <typename G> double regularity(const G& g, vector<double>& node_regularity); // Based only on node degree
+    template <typename G> double regularity_configuration_model(const G& g); // Regularity of the equivalent configuration model
+    template <typename G> double normalized_regularity(const G& g);
+    template <typename G> double normalized_regularity(const G& g, vector<double>& node_regularity);
+    template <typename G> double get_rich_club_coefficient(const G& g,id_type start_hub_degree);
+    template <typename G> double normalized_rich_club_coefficient(const G& g,id_type start_hub_degree_def);
+    template <typename G> double get_poor_club_coefficient(const G& g,id_type start_hub_degree);
 
-    double kl_divergence_from_random_graph(const graph& g);
-    double distance_from_random_graph(const graph& g, bool hellinger);  // Hellinger and Bhattacharyya Distance of Degree Distribution
-    double connectivity_entropy(const graph& g);
-    double graph_modularity(graph& g);
+    template <typename G> double kl_divergence_from_random_graph(const G& g);
+    template <typename G> double distance_from_random_graph(const G& g, bool hellinger);  // Hellinger and Bhattacharyya Distance of Degree Distribution
+    template <typename G> double connectivity_entropy(const G& g);
+    template <typename G> double graph_modularity(const G& g);
 };
 
 #endif	/* GRAPH_PROPERTIES_H */
@@ -7,101 +7,628 @@
 
 #include "graphio.h"
 #include "centrality.h"
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
 using namespace CDLib;
 
-bool CDLib::read_edgelist(graph& g, const string& filepath) {
-    g.clear();
-    ifstream ifs;
-    ifs.open(filepath.c_str());
-    if (ifs.is_open()) {
-        vector<string> units;
-        double weight;
-        while (!ifs.eof()) {
-            weight = 1;
-            string line;
-            getline(ifs, line);
-            if ((line.size() > 0) && (line[0] != '#')) {
-                split(line, units);
-                if (units.size() != 0) {
-                    if ((units.size() < 2) || (units.size() > 3)) return false;
-                    if (units.size() == 3) weight = str2T<double>(units[2]);
-                    g.add_node(units[0]);
-                    g.add_node(units[1]);
-                    g.add_edge(units[0], units[1], weight);
-                }
-            }
-        }
-        g.set_graph_name(filename(filepath));
+const char bcsr_magic[8] = {'G', 'R', 'A', 'F', 'F', 'Y', 'C', 'S'};
+const uint64_t bcsr_byte_order = 0x0102030405060708ULL;
+const uint64_t bcsr_alignment = 64;
+
+const size_t parser_min_chunk_bytes = 1 << 16;
+
+double parser_wall_seconds() {
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+struct file_unmapper {
+    //  Releases a mapping once the last object referring to it is gone.
+    size_t length;
+
+    file_unmapper(size_t l) : length(l) {
+    }
+
+    void operator()(const void* addr) const {
+        munmap(const_cast<void*> (addr), length);
+    }
+};
+
+bool read_input_stream(int fd, shared_ptr<const void>& owner, const char*& data, size_t& size) {
+    //  Reads what remains of fd into a buffer owned through owner, for inputs that cannot
+    //  be mapped such as pipes, FIFOs or /dev/stdin.
+    shared_ptr< vector<char> > buffer(new vector<char>());
+    char block[1 << 16];
+    ssize_t bytes;
+    while ((bytes = read(fd, block, sizeof (block))) != 0) {
+        if (bytes < 0) return false;
+        buffer->insert(buffer->end(), block, block + bytes);
+    }
+    size = buffer->size();
+    if (size) {
+        data = &(*buffer)[0];
+        owner = shared_ptr<const void>(buffer, data);
+    }
+    return true;
+}
+
+bool map_input_file(const string& filepath, shared_ptr<const void>& owner, const char*& data, size_t& size) {
+    //  Maps a whole regular file read-only, and reads anything else into memory. Empty
+    //  inputs succeed with a NULL data pointer.
+    owner.reset();
+    data = NULL;
+    size = 0;
+    int fd = open(filepath.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        bool read_ok = read_input_stream(fd, owner, data, size);
+        close(fd);
+        return read_ok;
+    }
+    size = st.st_size;
+    if (!size) {
+        close(fd);
         return true;
     }
-    return false;
+    void* addr = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        size = 0;
+        bool read_ok = read_input_stream(fd, owner, data, size);
+        close(fd);
+        return read_ok;
+    }
+    close(fd);
+    owner = shared_ptr<const void>(addr, file_unmapper(size));
+    data = (const char*) addr;
+    return true;
 }
 
-bool CDLib::read_adjacencylist(graph& g, const string& filepath) {
-    g.clear();
-    ifstream ifs;
-    ifs.open(filepath.c_str());
-    if (ifs.is_open()) {
-        int type = 0;
-        id_type nid = 0, estart = 0;
-        string line;
-        getline(ifs, line);
-        vector<id_type> units;
-        split(line, units);
-        if ((units.size() > 2) && (units[0] == 0) && (units[1] == units.size() - 2)) {
-            type = 0;
-            estart = 2;
-        } else if ((units.size() > 1) && (units[0] == 0)) {
-            type = 1;
-            estart = 1;
-        } else {
-            type = 2;
-            estart = 0;
+struct text_chunk {
+    const char* first;
+    const char* last;
+};
+
+void split_at_lines(const char* data, size_t size, vector<text_chunk>& chunks) {
+    //  Cuts [data,data+size) into about one chunk per 4 threads, every chunk ending just
+    //  after a newline (or at the end of the input).
+    id_type parts = 1;
+#ifdef ENABLE_MULTITHREADING
+    parts = 4 * omp_get_max_threads();
+#endif
+    parts = max<id_type > (1, min<id_type > (parts, size / parser_min_chunk_bytes));
+    chunks.clear();
+    const char* first = data, *end = data + size;
+    for (id_type i = 1; i <= parts && first < end; i++) {
+        const char* last = (i == parts) ? end : data + (size * i) / parts;
+        if (last < first) last = first;
+        if (last < end) {
+            const char* nl = (const char*) memchr(last, '\n', end - last);
+            last = (nl) ? nl + 1 : end;
         }
-        g.add_node(to_string(nid));
-        for (id_type i = estart; i < units.size(); i++) {
-            g.add_node(to_string(units[i]));
-            g.add_edge(to_string(nid), to_string(units[i]), 1);
+        text_chunk chunk = {first, last};
+        chunks.push_back(chunk);
+        first = last;
+    }
+}
+
+inline bool is_blank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+inline const char* end_of_line(const char* p, const char* last) {
+    const char* nl = (const char*) memchr(p, '\n', last - p);
+    return (nl) ? nl : last;
+}
+
+inline bool line_is_skipped(const char* p, const char* eol) {
+    //  Lines split() ignores: empty or starting with a blank.
+    return p == eol || *p == ' ' || *p == '\t';
+}
+
+inline const char* next_token(const char*& p, const char* eol, id_type& length) {
+    //  Returns the next whitespace separated token of the line, NULL when there is none.
+    while (p < eol && is_blank(*p)) p++;
+    if (p == eol) return NULL;
+    const char* token = p;
+    while (p < eol && !is_blank(*p)) p++;
+    length = p - token;
+    return token;
+}
+
+inline id_type scan_id(const char* token, id_type length) {
+    //  Leading decimal digits of the token, as istream extraction of an id_type reads them.
+    id_type value = 0;
+    for (id_type i = 0; i < length && token[i] >= '0' && token[i] <= '9'; i++) value = 10 * value + (token[i] - '0');
+    return value;
+}
+
+inline wt_t scan_weight(const char* token, id_type length) {
+    //  Plain integers are converted directly, anything else goes through strtod.
+    id_type i = 0;
+    while (i < length && token[i] >= '0' && token[i] <= '9') i++;
+    if (i == length && length < 16) return (wt_t) scan_id(token, length);
+    char buffer[64];
+    length = min<id_type > (length, sizeof (buffer) - 1);
+    memcpy(buffer, token, length);
+    buffer[length] = 0;
+    return strtod(buffer, NULL);
+}
+
+struct text_token {
+    const char* first;
+    id_type length;
+};
+
+struct text_token_hash {
+    inline size_t operator()(const text_token& token) const {
+        size_t h = 14695981039346656037ULL;
+        for (id_type i = 0; i < token.length; i++) h = (h ^ (unsigned char) token.first[i]) * 1099511628211ULL;
+        return h;
+    }
+};
+
+struct text_token_equal {
+    inline bool operator()(const text_token& left, const text_token& right) const {
+        return left.length == right.length && !memcmp(left.first, right.first, left.length);
+    }
+};
+
+inline id_type label_length(const text_token& token) {
+    return token.length;
+}
+
+inline void label_copy(const text_token& token, char* out) {
+    memcpy(out, token.first, token.length);
+}
+
+inline id_type label_length(id_type value) {
+    id_type length = 1;
+    while (value >= 10) {
+        value /= 10;
+        length++;
+    }
+    return length;
+}
+
+inline void label_copy(id_type value, char* out) {
+    for (id_type i = label_length(value); i > 0; i--) {
+        out[i - 1] = '0' + (value % 10);
+        value /= 10;
+    }
+}
+
+template <typename K, typename H, typename E>
+struct parsed_chunk {
+    //  Labels get chunk local ids in order of first appearance and the edges refer to those
+    //  until merge_chunk_labels rewrites them to global ids. weights stays empty when every
+    //  edge weighs 1.
+    typedef unordered_map<K, id_type, H, E> local_map;
+    local_map local_ids;
+    vector<K> labels;
+    vector<id_type> from;
+    vector<id_type> to;
+    vector<wt_t> weights;
+    bool valid;
+
+    parsed_chunk() : valid(true) {
+    }
+
+    inline id_type local_id(const K& key) {
+        pair<typename local_map::iterator, bool> ins = local_ids.insert(make_pair(key, (id_type) labels.size()));
+        if (ins.second) labels.push_back(key);
+        return ins.first->second;
+    }
+};
+
+template <typename K, typename H, typename E>
+id_type merge_chunk_labels(vector< parsed_chunk<K, H, E> >& chunks, vector<K>& global_labels) {
+    //  Numbers the labels in order of first appearance in the file, i.e. as serial add_node
+    //  calls would. The labels are partitioned into shards by hash and every shard walks the
+    //  chunks in file order, so the first chunk presenting a label owns it. The owners of a
+    //  chunk are numbered after those of the preceding chunks, then every edge is rewritten.
+    id_type num_chunks = chunks.size(), num_shards = max<id_type > (1, num_chunks);
+    vector< vector< vector<id_type> > > members(num_chunks, vector< vector<id_type> >(num_shards));
+    vector< vector< pair<id_type, id_type> > > owners(num_chunks);
+    vector< vector<id_type> > global_ids(num_chunks);
+    vector<id_type> base(num_chunks + 1, 0);
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel for schedule(dynamic,1) shared(chunks,members,owners)
+#endif
+    for (id_type c = 0; c < num_chunks; c++) {
+        owners[c].resize(chunks[c].labels.size());
+        for (id_type l = 0; l < chunks[c].labels.size(); l++) members[c][H()(chunks[c].labels[l]) % num_shards].push_back(l);
+        typename parsed_chunk<K, H, E>::local_map().swap(chunks[c].local_ids);
+    }
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel for schedule(dynamic,1) shared(chunks,members,owners)
+#endif
+    for (id_type s = 0; s < num_shards; s++) {
+        unordered_map<K, pair<id_type, id_type>, H, E> first_seen;
+        for (id_type c = 0; c < num_chunks; c++)
+            for (id_type i = 0; i < members[c][s].size(); i++) {
+                id_type l = members[c][s][i];
+                owners[c][l] = first_seen.insert(make_pair(chunks[c].labels[l], make_pair(c, l))).first->second;
+            }
+    }
+    for (id_type c = 0; c < num_chunks; c++) {
+        base[c + 1] = base[c];
+        for (id_type l = 0; l < owners[c].size(); l++) base[c + 1] += (owners[c][l].first == c);
+    }
+    global_labels.resize(base[num_chunks]);
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel for schedule(dynamic,1) shared(chunks,owners,global_ids,base,global_labels)
+#endif
+    for (id_type c = 0; c < num_chunks; c++) {
+        global_ids[c].assign(owners[c].size(), 0);
+        for (id_type l = 0, next = base[c]; l < owners[c].size(); l++) {
+            if (owners[c][l].first == c) {
+                global_labels[next] = chunks[c].labels[l];
+                global_ids[c][l] = next++;
+            }
+        }
+    }
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel for schedule(dynamic,1) shared(chunks,owners,global_ids)
+#endif
+    for (id_type c = 0; c < num_chunks; c++) {
+        for (id_type l = 0; l < owners[c].size(); l++)
+            if (owners[c][l].first != c) global_ids[c][l] = global_ids[owners[c][l].first][owners[c][l].second];
+        for (id_type k = 0; k < chunks[c].from.size(); k++) {
+            chunks[c].from[k] = global_ids[c][chunks[c].from[k]];
+            chunks[c].to[k] = global_ids[c][chunks[c].to[k]];
         }
-        while (!ifs.eof()) {
-            string line;
-            getline(ifs, line);
-            vector<id_type> units;
-            split(line, units);
-            if (units.size() > 0) {
-                if ((type == 0) || (type == 1)) nid = units[0];
-                else nid++;
-                g.add_node(to_string(nid));
-                for (id_type i = estart; i < units.size(); i++) {
-                    g.add_node(to_string(units[i]));
-                    g.add_edge(to_string(nid), to_string(units[i]), 1);
+    }
+    return base[num_chunks];
+}
+
+template <typename K, typename H, typename E>
+id_type gather_chunk_edges(vector< parsed_chunk<K, H, E> >& chunks, vector<id_type>& from, vector<id_type>& to, vector<wt_t>& weights) {
+    //  Concatenates the edges of the chunks in file order and releases the chunks.
+    id_type num_chunks = chunks.size();
+    vector<id_type> base(num_chunks + 1, 0);
+    bool has_weights = false;
+    for (id_type c = 0; c < num_chunks; c++) {
+        base[c + 1] = base[c] + chunks[c].from.size();
+        has_weights = has_weights || chunks[c].weights.size();
+    }
+    from.resize(base[num_chunks]);
+    to.resize(base[num_chunks]);
+    if (has_weights) weights.assign(base[num_chunks], 1);
+    else weights.clear();
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel for schedule(dynamic,1) shared(chunks,base,from,to,weights)
+#endif
+    for (id_type c = 0; c < num_chunks; c++) {
+        copy(chunks[c].from.begin(), chunks[c].from.end(), from.begin() + base[c]);
+        copy(chunks[c].to.begin(), chunks[c].to.end(), to.begin() + base[c]);
+        if (chunks[c].weights.size()) copy(chunks[c].weights.begin(), chunks[c].weights.end(), weights.begin() + base[c]);
+        chunks[c] = parsed_chunk<K, H, E > ();
+    }
+    return base[num_chunks];
+}
+
+template <typename K>
+void build_label_arrays(const vector<K>& labels, vector<id_type>& offsets, vector<char>& chars) {
+    id_type num_labels = labels.size();
+    offsets.assign(num_labels + 1, 0);
+    for (id_type i = 0; i < num_labels; i++) offsets[i + 1] = offsets[i] + label_length(labels[i]);
+    chars.resize(offsets[num_labels]);
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel for schedule(dynamic,4096) shared(labels,offsets,chars)
+#endif
+    for (id_type i = 0; i < num_labels; i++) label_copy(labels[i], chars.data() + offsets[i]);
+}
+
+void finish_parse_statistics(parse_statistics& stats, size_t bytes, id_type records, id_type chunks, double start, double parsed, double built) {
+    stats.bytes = bytes;
+    stats.records = records;
+    stats.chunks = chunks;
+    stats.parse_seconds = parsed - start;
+    stats.build_seconds = built - parsed;
+    stats.megabytes_per_second = (stats.parse_seconds > 0) ? (bytes / 1048576.0) / stats.parse_seconds : 0;
+}
+
+typedef parsed_chunk<text_token, text_token_hash, text_token_equal> edgelist_chunk;
+
+void parse_edgelist_chunk(const text_chunk& chunk, edgelist_chunk& out) {
+    //  One edge per line: two labels and an optional weight. '#' starts a comment line.
+    for (const char* p = chunk.first; p < chunk.last;) {
+        const char* eol = end_of_line(p, chunk.last);
+        if (!line_is_skipped(p, eol) && *p != '#') {
+            text_token units[3];
+            id_type num_units = 0, length;
+            const char* token;
+            while (num_units < 4 && (token = next_token(p, eol, length))) {
+                if (num_units < 3) {
+                    units[num_units].first = token;
+                    units[num_units].length = length;
                 }
+                num_units++;
+            }
+            if (num_units) {
+                if (num_units < 2 || num_units > 3) {
+                    out.valid = false;
+                    return;
+                }
+                out.from.push_back(out.local_id(units[0]));
+                out.to.push_back(out.local_id(units[1]));
+                out.weights.push_back((num_units == 3) ? scan_weight(units[2].first, units[2].length) : 1);
             }
         }
-        g.set_graph_name(filename(filepath));
-        return true;
+        p = eol + 1;
     }
-    return false;
 }
 
-bool CDLib::read_matlab_sp(graph& g, const string& filepath) {
+bool CDLib::read_edgelist(CSR& g, const string& filepath, bool directed, bool weighted, parse_statistics& stats) {
+    double start = parser_wall_seconds();
     g.clear();
-    ifstream ifs;
-    ifs.open(filepath.c_str());
-    if (ifs.is_open()) {
-        id_type from, to;
-        double weight = 1;
-        while (!ifs.eof()) {
-            ifs >> from >> to >> weight;
-            while (max(from, to) > g.get_num_nodes()) {
-                g.add_node();
+    shared_ptr<const void> owner;
+    const char* data;
+    size_t size;
+    if (!map_input_file(filepath, owner, data, size)) return false;
+    vector<text_chunk> chunks;
+    split_at_lines(data, size, chunks);
+    vector<edgelist_chunk> parsed(chunks.size());
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel for schedule(dynamic,1) shared(chunks,parsed)
+#endif
+    for (id_type c = 0; c < chunks.size(); c++) parse_edgelist_chunk(chunks[c], parsed[c]);
+    for (id_type c = 0; c < parsed.size(); c++) if (!parsed[c].valid) return false;
+    vector<text_token> labels;
+    vector<id_type> from, to, label_offsets;
+    vector<wt_t> weights;
+    vector<char> label_chars;
+    id_type num_nodes = merge_chunk_labels(parsed, labels);
+    gather_chunk_edges(parsed, from, to, weights);
+    build_label_arrays(labels, label_offsets, label_chars);
+    double parsed_at = parser_wall_seconds();
+    g.populate_from_edges(directed, weighted, num_nodes, from, to, weights);
+    g.set_node_labels(label_offsets, label_chars);
+    g.set_graph_name(filename(filepath));
+    finish_parse_statistics(stats, size, from.size(), chunks.size(), start, parsed_at, parser_wall_seconds());
+    return true;
+}
+
+bool CDLib::read_edgelist(CSR& g, const string& filepath, bool directed, bool weighted) {
+    parse_statistics stats;
+    return read_edgelist(g, filepath, directed, weighted, stats);
+}
+
+bool CDLib::read_edgelist(graph& g, const string& filepath, parse_statistics& stats) {
+    g.clear();
+    CSR csr;
+    if (!read_edgelist(csr, filepath, g.is_directed(), g.is_weighted(), stats)) return false;
+    double start = parser_wall_seconds();
+    g.assign(csr);
+    stats.build_seconds += parser_wall_seconds() - start;
+    return true;
+}
+
+bool CDLib::read_edgelist(graph& g, const string& filepath) {
+    parse_statistics stats;
+    return read_edgelist(g, filepath, stats);
+}
+
+struct id_hash {
+    inline size_t operator()(id_type id) const {
+        //  Mixes the bits so that consecutive ids spread over the label shards.
+        id = (id ^ (id >> 33)) * 0xff51afd7ed558ccdULL;
+        return id ^ (id >> 33);
+    }
+};
+
+typedef parsed_chunk<id_type, id_hash, equal_to<id_type> > adjacencylist_chunk;
+
+id_type count_adjacency_lines(const text_chunk& chunk) {
+    id_type lines = 0, length;
+    for (const char* p = chunk.first; p < chunk.last;) {
+        const char* eol = end_of_line(p, chunk.last);
+        if (!line_is_skipped(p, eol) && next_token(p, eol, length)) lines++;
+        p = eol + 1;
+    }
+    return lines;
+}
+
+void parse_adjacency_chunk(const text_chunk& chunk, bool implicit_ids, id_type first_id, id_type estart, adjacencylist_chunk& out) {
+    //  One node per line followed by its neighbors from the estart-th number on. With
+    //  implicit ids the node is the ordinal of the line, counted from first_id.
+    vector<id_type> units;
+    for (const char* p = chunk.first; p < chunk.last;) {
+        const char* eol = end_of_line(p, chunk.last);
+        units.clear();
+        if (!line_is_skipped(p, eol)) {
+            id_type length;
+            const char* token;
+            while ((token = next_token(p, eol, length))) units.push_back(scan_id(token, length));
+        }
+        if (units.size()) {
+            id_type nid = out.local_id((implicit_ids) ? first_id++ : units[0]);
+            for (id_type i = estart; i < units.size(); i++) {
+                out.from.push_back(nid);
+                out.to.push_back(out.local_id(units[i]));
             }
-            g.add_edge(from - 1, to - 1, weight);
         }
-        g.set_graph_name(filename(filepath));
-        return true;
+        p = eol + 1;
     }
-    return false;
+}
+
+bool CDLib::read_adjacencylist(CSR& g, const string& filepath, bool directed, bool weighted, parse_statistics& stats) {
+    //  The layout is detected from the first line, which always describes node 0:
+    //  "0 count n1 .. ncount" (type 0), "0 n1 n2 .." (type 1) or just the neighbors with
+    //  the nodes numbered by line (type 2).
+    double start = parser_wall_seconds();
+    g.clear();
+    shared_ptr<const void> owner;
+    const char* data;
+    size_t size;
+    if (!map_input_file(filepath, owner, data, size)) return false;
+    const char* eol = end_of_line(data, data + size);
+    vector<id_type> units;
+    if (!line_is_skipped(data, eol)) {
+        const char* p = data, *token;
+        id_type length;
+        while ((token = next_token(p, eol, length))) units.push_back(scan_id(token, length));
+    }
+    id_type estart = 0;
+    if ((units.size() > 2) && (units[0] == 0) && (units[1] == units.size() - 2)) estart = 2;
+    else if ((units.size() > 1) && (units[0] == 0)) estart = 1;
+    bool implicit_ids = !estart;
+    vector<text_chunk> chunks;
+    const char* rest = (eol < data + size) ? eol + 1 : eol;
+    split_at_lines(rest, data + size - rest, chunks);
+    id_type num_chunks = chunks.size() + 1;
+    vector<adjacencylist_chunk> parsed(num_chunks);
+    vector<id_type> first_ids(num_chunks, 1);
+    if (implicit_ids) {
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel for schedule(dynamic,1) shared(chunks,first_ids)
+#endif
+        for (id_type c = 1; c < num_chunks; c++) first_ids[c] = count_adjacency_lines(chunks[c - 1]);
+        first_ids[0] = 0;
+        for (id_type c = 1, next = 1; c < num_chunks; c++) {
+            id_type lines = first_ids[c];
+            first_ids[c] = next;
+            next += lines;
+        }
+    }
+    id_type root = parsed[0].local_id(0);
+    for (id_type i = estart; i < units.size(); i++) {
+        parsed[0].from.push_back(root);
+        parsed[0].to.push_back(parsed[0].local_id(units[i]));
+    }
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel for schedule(dynamic,1) shared(chunks,parsed,first_ids)
+#endif
+    for (id_type c = 1; c < num_chunks; c++) parse_adjacency_chunk(chunks[c - 1], implicit_ids, first_ids[c], estart, parsed[c]);
+    vector<id_type> labels, from, to, label_offsets;
+    vector<wt_t> weights;
+    vector<char> label_chars;
+    id_type num_nodes = merge_chunk_labels(parsed, labels);
+    gather_chunk_edges(parsed, from, to, weights);
+    build_label_arrays(labels, label_offsets, label_chars);
+    double parsed_at = parser_wall_seconds();
+    g.populate_from_edges(directed, weighted, num_nodes, from, to, weights);
+    g.set_node_labels(label_offsets, label_chars);
+    g.set_graph_name(filename(filepath));
+    finish_parse_statistics(stats, size, from.size(), num_chunks, start, parsed_at, parser_wall_seconds());
+    return true;
+}
+
+bool CDLib::read_adjacencylist(CSR& g, const string& filepath, bool directed, bool weighted) {
+    parse_statistics stats;
+    return read_adjacencylist(g, filepath, directed, weighted, stats);
+}
+
+bool CDLib::read_adjacencylist(graph& g, const string& filepath, parse_statistics& stats) {
+    g.clear();
+    CSR csr;
+    if (!read_adjacencylist(csr, filepath, g.is_directed(), g.is_weighted(), stats)) return false;
+    double start = parser_wall_seconds();
+    g.assign(csr);
+    stats.build_seconds += parser_wall_seconds() - start;
+    return true;
+}
+
+bool CDLib::read_adjacencylist(graph& g, const string& filepath) {
+    parse_statistics stats;
+    return read_adjacencylist(g, filepath, stats);
+}
+
+id_type count_tokens(const text_chunk& chunk) {
+    id_type tokens = 0, length;
+    for (const char* p = chunk.first; p < chunk.last;) {
+        const char* eol = end_of_line(p, chunk.last);
+        while (next_token(p, eol, length)) tokens++;
+        p = eol + 1;
+    }
+    return tokens;
+}
+
+void parse_matlab_chunk(const text_chunk& chunk, id_type position, vector<id_type>& from, vector<id_type>& to, vector<wt_t>& weights) {
+    //  The file is a flat sequence of "from to weight" triples, position is the index of the
+    //  first token of the chunk in that sequence. Tokens of an incomplete last triple are ignored.
+    id_type length, num_triples = from.size();
+    for (const char* p = chunk.first; p < chunk.last;) {
+        const char* eol = end_of_line(p, chunk.last);
+        const char* token;
+        while ((token = next_token(p, eol, length))) {
+            id_type triple = position / 3, field = position % 3;
+            position++;
+            if (triple >= num_triples) return;
+            if (field == 0) from[triple] = scan_id(token, length);
+            else if (field == 1) to[triple] = scan_id(token, length);
+            else weights[triple] = scan_weight(token, length);
+        }
+        p = eol + 1;
+    }
+}
+
+bool CDLib::read_matlab_sp(CSR& g, const string& filepath, bool directed, bool weighted, parse_statistics& stats) {
+    //  Ids are 1 based and the node count is the largest id seen; every node is labelled
+    //  by its 0 based id. Triples referring to id 0 are dropped.
+    double start = parser_wall_seconds();
+    g.clear();
+    shared_ptr<const void> owner;
+    const char* data;
+    size_t size;
+    if (!map_input_file(filepath, owner, data, size)) return false;
+    vector<text_chunk> chunks;
+    split_at_lines(data, size, chunks);
+    vector<id_type> positions(chunks.size() + 1, 0);
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel for schedule(dynamic,1) shared(chunks,positions)
+#endif
+    for (id_type c = 0; c < chunks.size(); c++) positions[c + 1] = count_tokens(chunks[c]);
+    for (id_type c = 0; c < chunks.size(); c++) positions[c + 1] += positions[c];
+    id_type num_triples = positions[chunks.size()] / 3, num_nodes = 0;
+    vector<id_type> from(num_triples, 0), to(num_triples, 0);
+    vector<wt_t> weights(num_triples, 0);
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel for schedule(dynamic,1) shared(chunks,positions,from,to,weights)
+#endif
+    for (id_type c = 0; c < chunks.size(); c++) parse_matlab_chunk(chunks[c], positions[c], from, to, weights);
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel for reduction(max:num_nodes) shared(from,to,weights)
+#endif
+    for (id_type k = 0; k < num_triples; k++) {
+        if (!from[k] || !to[k]) weights[k] = 0;
+        else {
+            num_nodes = max(num_nodes, max(from[k], to[k]));
+            from[k]--;
+            to[k]--;
+        }
+    }
+    double parsed_at = parser_wall_seconds();
+    g.populate_from_edges(directed, weighted, num_nodes, from, to, weights);
+    g.set_graph_name(filename(filepath));
+    finish_parse_statistics(stats, size, num_triples, chunks.size(), start, parsed_at, parser_wall_seconds());
+    return true;
+}
+
+bool CDLib::read_matlab_sp(CSR& g, const string& filepath, bool directed, bool weighted) {
+    parse_statistics stats;
+    return read_matlab_sp(g, filepath, directed, weighted, stats);
+}
+
+bool CDLib::read_matlab_sp(graph& g, const string& filepath, parse_statistics& stats) {
+    g.clear();
+    CSR csr;
+    if (!read_matlab_sp(csr, filepath, g.is_directed(), g.is_weighted(), stats)) return false;
+    double start = parser_wall_seconds();
+    g.assign(csr);
+    stats.build_seconds += parser_wall_seconds() - start;
+    return true;
+}
+
+bool CDLib::read_matlab_sp(graph& g, const string& filepath) {
+    parse_statistics stats;
+    return read_matlab_sp(g, filepath, stats);
 }
 
 bool CDLib::write_edgelist(const graph& g, const string& filepath, bool weights) {
@@ -304,3 +831,175 @@ bool CDLib::write_lcc_and_props(const graph& base, const string& filepath, bool
         return 1;
     } else return 0;
 }
+
+bool CDLib::write_binary_CSR(const graph& g, const string& filepath) {
+    CSR csr(g);
+    return write_binary_CSR(csr, filepath);
+}
+
+bool CDLib::write_binary_CSR(const CSR& g, const string& filepath) {
+    ofstream file;
+    string graphfilename = filepath + ".bcsr";
+    file.open(graphfilename.c_str(), ios::out | ios::binary | ios::trunc);
+    if (!file.is_open()) return 0;
+    const csr_arrays& arrays = g.arrays();
+    id_type n = arrays.num_nodes;
+    string gname = g.get_graph_name();
+    binary_csr_header header;
+    memset(&header, 0, sizeof (header));
+    memcpy(header.magic, bcsr_magic, sizeof (bcsr_magic));
+    header.version = BCSR_VERSION;
+    header.flags = (arrays.directed ? BCSR_FLAG_DIRECTED : 0) | (arrays.weighted ? BCSR_FLAG_WEIGHTED : 0) | (arrays.label_offsets ? BCSR_FLAG_LABELS : 0);
+    header.id_bytes = sizeof (id_type);
+    header.wt_bytes = sizeof (wt_t);
+    header.byte_order = bcsr_byte_order;
+    header.num_nodes = n;
+    header.num_arcs = arrays.num_arcs;
+    header.num_self_edges = arrays.num_self_edges;
+    header.total_arc_weight = arrays.total_arc_weight;
+    header.self_edges_weight = arrays.self_edges_weight;
+    const char* data[BCSR_NUM_SECTIONS];
+    memset(data, 0, sizeof (data));
+    data[BCSR_OUT_OFFSETS] = (const char*) arrays.out_offsets;
+    header.section_bytes[BCSR_OUT_OFFSETS] = (n + 1) * sizeof (id_type);
+    data[BCSR_OUT_NEIGHBORS] = (const char*) arrays.out_neighbors;
+    header.section_bytes[BCSR_OUT_NEIGHBORS] = arrays.num_arcs * sizeof (id_type);
+    data[BCSR_OUT_WEIGHTS] = (const char*) arrays.out_weights;
+    header.section_bytes[BCSR_OUT_WEIGHTS] = (arrays.out_weights) ? arrays.num_arcs * sizeof (wt_t) : 0;
+    data[BCSR_OUT_STRENGTH] = (const char*) arrays.out_strength;
+    header.section_bytes[BCSR_OUT_STRENGTH] = n * sizeof (wt_t);
+    if (arrays.directed) {
+        data[BCSR_IN_OFFSETS] = (const char*) arrays.in_offsets;
+        header.section_bytes[BCSR_IN_OFFSETS] = (n + 1) * sizeof (id_type);
+        data[BCSR_IN_NEIGHBORS] = (const char*) arrays.in_neighbors;
+        header.section_bytes[BCSR_IN_NEIGHBORS] = arrays.num_arcs * sizeof (id_type);
+        data[BCSR_IN_WEIGHTS] = (const char*) arrays.in_weights;
+        header.section_bytes[BCSR_IN_WEIGHTS] = (arrays.in_weights) ? arrays.num_arcs * sizeof (wt_t) : 0;
+        data[BCSR_IN_STRENGTH] = (const char*) arrays.in_strength;
+        header.section_bytes[BCSR_IN_STRENGTH] = n * sizeof (wt_t);
+    }
+    if (arrays.label_offsets) {
+        data[BCSR_LABEL_OFFSETS] = (const char*) arrays.label_offsets;
+        header.section_bytes[BCSR_LABEL_OFFSETS] = (n + 1) * sizeof (id_type);
+        data[BCSR_LABEL_CHARS] = arrays.label_chars;
+        header.section_bytes[BCSR_LABEL_CHARS] = arrays.label_offsets[n];
+        data[BCSR_LABEL_ORDER] = (const char*) arrays.label_order;
+        header.section_bytes[BCSR_LABEL_ORDER] = n * sizeof (id_type);
+    }
+    data[BCSR_GRAPH_NAME] = gname.data();
+    header.section_bytes[BCSR_GRAPH_NAME] = gname.size();
+    uint64_t offset = sizeof (header);
+    for (id_type i = 0; i < BCSR_NUM_SECTIONS; i++) {
+        offset = ((offset + bcsr_alignment - 1) / bcsr_alignment) * bcsr_alignment;
+        header.section_offset[i] = offset;
+        offset += header.section_bytes[i];
+    }
+    file.write((const char*) &header, sizeof (header));
+    uint64_t written = sizeof (header);
+    const char padding[bcsr_alignment] = {0};
+    for (id_type i = 0; i < BCSR_NUM_SECTIONS; i++) {
+        file.write(padding, header.section_offset[i] - written);
+        if (header.section_bytes[i]) file.write(data[i], header.section_bytes[i]);
+        written = header.section_offset[i] + header.section_bytes[i];
+    }
+    file.close();
+    return !file.fail();
+}
+
+bool bcsr_section_valid(const binary_csr_header& header, size_t file_size, id_type section, uint64_t expected_bytes) {
+    uint64_t offset = header.section_offset[section], bytes = header.section_bytes[section];
+    if (bytes != expected_bytes || offset % bcsr_alignment) return false;
+    return (offset <= file_size && bytes <= file_size - offset);
+}
+
+bool bcsr_adjacency_valid(const id_type* offsets, const id_type* neighbors, uint64_t n) {
+    //  Monotone offsets and, within every node, neighbors strictly increasing and below n, as
+    //  CSR::find_edge searches them with lower_bound.
+    for (uint64_t i = 0; i < n; i++) {
+        if (offsets[i] > offsets[i + 1]) return false;
+        for (uint64_t k = offsets[i]; k < offsets[i + 1]; k++)
+            if (neighbors[k] >= n || (k > offsets[i] && neighbors[k - 1] >= neighbors[k])) return false;
+    }
+    return true;
+}
+
+bool bcsr_labels_valid(const id_type* offsets, const char* chars, const id_type* order, uint64_t n) {
+    //  label_order must list every node once in strictly increasing label order, as
+    //  CSR::get_node_id searches it by bisection.
+    for (uint64_t i = 0; i < n; i++) if (offsets[i] > offsets[i + 1]) return false;
+    vector<char> seen(n, 0);
+    for (uint64_t i = 0; i < n; i++) {
+        if (order[i] >= n || seen[order[i]]) return false;
+        seen[order[i]] = 1;
+        if (i && !lexicographical_compare(chars + offsets[order[i - 1]], chars + offsets[order[i - 1] + 1], chars + offsets[order[i]], chars + offsets[order[i] + 1])) return false;
+    }
+    return true;
+}
+
+bool CDLib::read_binary_CSR(CSR& g, const string& filepath) {
+    return read_binary_CSR(g, filepath, false);
+}
+
+bool CDLib::read_binary_CSR(CSR& g, const string& filepath, bool verify) {
+    //  Maps the file read-only and points the CSR straight at its sections. Unless verify
+    //  is set, nothing is parsed or copied and only the header and the ends of the offset
+    //  arrays are read, so the cost is independent of the size of the graph.
+    g.clear();
+    shared_ptr<const void> owner;
+    const char* base;
+    size_t file_size;
+    if (!map_input_file(filepath, owner, base, file_size) || file_size < sizeof (binary_csr_header)) return false;
+    const binary_csr_header& header = *((const binary_csr_header*) base);
+    if (memcmp(header.magic, bcsr_magic, sizeof (bcsr_magic)) || header.version != BCSR_VERSION) return false;
+    if (header.id_bytes != sizeof (id_type) || header.wt_bytes != sizeof (wt_t) || header.byte_order != bcsr_byte_order) return false;
+    bool directed = header.flags & BCSR_FLAG_DIRECTED, weighted = header.flags & BCSR_FLAG_WEIGHTED, labels = header.flags & BCSR_FLAG_LABELS;
+    uint64_t n = header.num_nodes, arcs = header.num_arcs;
+    if (n >= file_size || arcs >= file_size) return false;
+    uint64_t id_bytes = sizeof (id_type), wt_bytes = sizeof (wt_t);
+    bool valid = bcsr_section_valid(header, file_size, BCSR_OUT_OFFSETS, (n + 1) * id_bytes)
+            && bcsr_section_valid(header, file_size, BCSR_OUT_NEIGHBORS, arcs * id_bytes)
+            && bcsr_section_valid(header, file_size, BCSR_OUT_WEIGHTS, (weighted) ? arcs * wt_bytes : 0)
+            && bcsr_section_valid(header, file_size, BCSR_OUT_STRENGTH, n * wt_bytes)
+            && bcsr_section_valid(header, file_size, BCSR_IN_OFFSETS, (directed) ? (n + 1) * id_bytes : 0)
+            && bcsr_section_valid(header, file_size, BCSR_IN_NEIGHBORS, (directed) ? arcs * id_bytes : 0)
+            && bcsr_section_valid(header, file_size, BCSR_IN_WEIGHTS, (directed && weighted) ? arcs * wt_bytes : 0)
+            && bcsr_section_valid(header, file_size, BCSR_IN_STRENGTH, (directed) ? n * wt_bytes : 0)
+            && bcsr_section_valid(header, file_size, BCSR_LABEL_OFFSETS, (labels) ? (n + 1) * id_bytes : 0)
+            && bcsr_section_valid(header, file_size, BCSR_LABEL_ORDER, (labels) ? n * id_bytes : 0)
+            && bcsr_section_valid(header, file_size, BCSR_GRAPH_NAME, header.section_bytes[BCSR_GRAPH_NAME]);
+    if (!valid) return false;
+    csr_arrays arrays;
+    arrays.directed = directed;
+    arrays.weighted = weighted;
+    arrays.num_nodes = n;
+    arrays.num_arcs = arcs;
+    arrays.num_self_edges = header.num_self_edges;
+    arrays.total_arc_weight = header.total_arc_weight;
+    arrays.self_edges_weight = header.self_edges_weight;
+    arrays.out_offsets = (const id_type*) (base + header.section_offset[BCSR_OUT_OFFSETS]);
+    arrays.out_neighbors = (const id_type*) (base + header.section_offset[BCSR_OUT_NEIGHBORS]);
+    arrays.out_weights = (weighted) ? (const wt_t*) (base + header.section_offset[BCSR_OUT_WEIGHTS]) : NULL;
+    arrays.out_strength = (const wt_t*) (base + header.section_offset[BCSR_OUT_STRENGTH]);
+    if (arrays.out_offsets[0] != 0 || arrays.out_offsets[n] != arcs) return false;
+    if (directed) {
+        arrays.in_offsets = (const id_type*) (base + header.section_offset[BCSR_IN_OFFSETS]);
+        arrays.in_neighbors = (const id_type*) (base + header.section_offset[BCSR_IN_NEIGHBORS]);
+        arrays.in_weights = (weighted) ? (const wt_t*) (base + header.section_offset[BCSR_IN_WEIGHTS]) : NULL;
+        arrays.in_strength = (const wt_t*) (base + header.section_offset[BCSR_IN_STRENGTH]);
+        if (arrays.in_offsets[0] != 0 || arrays.in_offsets[n] != arcs) return false;
+    }
+    if (labels) {
+        arrays.label_offsets = (const id_type*) (base + header.section_offset[BCSR_LABEL_OFFSETS]);
+        arrays.label_chars = base + header.section_offset[BCSR_LABEL_CHARS];
+        arrays.label_order = (const id_type*) (base + header.section_offset[BCSR_LABEL_ORDER]);
+        if (arrays.label_offsets[0] != 0 || !bcsr_section_valid(header, file_size, BCSR_LABEL_CHARS, arrays.label_offsets[n])) return false;
+    }
+    if (verify) {
+        if (!bcsr_adjacency_valid(arrays.out_offsets, arrays.out_neighbors, n)) return false;
+        if (directed && !bcsr_adjacency_valid(arrays.in_offsets, arrays.in_neighbors, n)) return false;
+        if (labels && !bcsr_labels_valid(arrays.label_offsets, arrays.label_chars, arrays.label_order, n)) return false;
+    }
+    string gname(base + header.section_offset[BCSR_GRAPH_NAME], header.section_bytes[BCSR_GRAPH_NAME]);
+    g.attach(arrays, owner, (gname.size()) ? gname : filename(filepath));
+    return true;
+}
@@ -11,6 +11,7 @@
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <stdint.h>
 #include "graph.h"
 #include "paths_and_components.h"
 #include "graph_operations.h"
@@ -19,9 +20,66 @@ using namespace std;
 
 namespace CDLib
 {
+        //  Binary CSR container. A fixed header is followed by 64 byte aligned sections
+        //  located through the section table, so the file can be memory mapped and used
+        //  in place. Absent sections (weights of unweighted graphs, in-edges of undirected
+        //  graphs, labels when every node is labelled by its id) have zero length.
+        enum binary_csr_section {
+            BCSR_OUT_OFFSETS, BCSR_OUT_NEIGHBORS, BCSR_OUT_WEIGHTS,
+            BCSR_IN_OFFSETS, BCSR_IN_NEIGHBORS, BCSR_IN_WEIGHTS,
+            BCSR_OUT_STRENGTH, BCSR_IN_STRENGTH,
+            BCSR_LABEL_OFFSETS, BCSR_LABEL_CHARS, BCSR_LABEL_ORDER,
+            BCSR_GRAPH_NAME, BCSR_NUM_SECTIONS
+        };
+
+        const uint32_t BCSR_VERSION = 1;
+        const uint32_t BCSR_FLAG_DIRECTED = 1;
+        const uint32_t BCSR_FLAG_WEIGHTED = 2;
+        const uint32_t BCSR_FLAG_LABELS = 4;
+
+        struct binary_csr_header {
+            char magic[8];
+            uint32_t version;
+            uint32_t flags;
+            uint32_t id_bytes;
+            uint32_t wt_bytes;
+            uint64_t byte_order;
+            uint64_t num_nodes;
+            uint64_t num_arcs;
+            uint64_t num_self_edges;
+            double total_arc_weight;
+            double self_edges_weight;
+            uint64_t section_offset[BCSR_NUM_SECTIONS];
+            uint64_t section_bytes[BCSR_NUM_SECTIONS];
+        };
+
+        //  Filled by the text readers, which split the file into chunks at line boundaries,
+        //  parse the chunks in parallel and build the adjacency in one bulk pass. parse_seconds
+        //  covers scanning and label deduplication, build_seconds the CSR (and graph) assembly.
+        struct parse_statistics {
+            id_type bytes;
+            id_type records;
+            id_type chunks;
+            double parse_seconds;
+            double build_seconds;
+            double megabytes_per_second;
+
+            parse_statistics() : bytes(0), records(0), chunks(0), parse_seconds(0), build_seconds(0), megabytes_per_second(0) {
+            }
+        };
+
         bool read_edgelist(graph& g,const string& filepath);
+        bool read_edgelist(graph& g,const string& filepath,parse_statistics& stats);
+        bool read_edgelist(CSR& g,const string& filepath,bool directed,bool weighted);
+        bool read_edgelist(CSR& g,const string& filepath,bool directed,bool weighted,parse_statistics& stats);
         bool read_adjacencylist(graph& g,const string& filepath);
+        bool read_adjacencylist(graph& g,const string& filepath,parse_statistics& stats);
+        bool read_adjacencylist(CSR& g,const string& filepath,bool directed,bool weighted);
+        bool read_adjacencylist(CSR& g,const string& filepath,bool directed,bool weighted,parse_statistics& stats);
         bool read_matlab_sp(graph& g,const string& filepath);
+        bool read_matlab_sp(graph& g,const string& filepath,parse_statistics& stats);
+        bool read_matlab_sp(CSR& g,const string& filepath,bool directed,bool weighted);
+        bool read_matlab_sp(CSR& g,const string& filepath,bool directed,bool weighted,parse_statistics& stats);
         bool write_edgelist(const graph& g,const string& filepath,bool weights);
         bool write_xml(const graph& g,const string& filepath,bool weights);
         bool write_METIS(const graph& g,const string& filepath,bool weights);
@@ -31,6 +89,14 @@ namespace CDLib
         bool write_matlab_sp(const graph& g,const string& filepath);
         bool write_dimacs_max_flow(const graph& g, const string& filepath);
         bool write_lcc_and_props(const graph& g,const string& filepath,bool start_with_one);
+        bool write_binary_CSR(const graph& g,const string& filepath);
+        bool write_binary_CSR(const CSR& g,const string& filepath);
+        //  Checks only the header and the section bounds, so loading does not touch the graph.
+        //  With verify, one pass over the file also checks that offsets are monotone, that
+        //  neighbor lists are sorted and in range and that the label index is a sorted
+        //  permutation; use it for files from an untrusted source.
+        bool read_binary_CSR(CSR& g,const string& filepath);
+        bool read_binary_CSR(CSR& g,const string& filepath,bool verify);
 };
 
 #endif	/* GRAPHIO_H */
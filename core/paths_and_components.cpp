@@ -7,225 +7,697 @@
 
 
 #include "paths_and_components.h"
+#include "random.h"
 
 using namespace CDLib;
 
-void CDLib::dfs_visitor(const graph& g, node_set& visited, id_type source) {
-    visited.insert(source);
-    for (adjacent_edges_iterator aeit = g.out_edges_begin(source); aeit != g.out_edges_end(source); aeit++)
-        if (visited.find(aeit->first) == visited.end()) dfs_visitor(g, visited, aeit->first);
+const id_type bfs_word_bits = 8 * sizeof (unsigned long);
+//  Direction switching thresholds of Beamer et al.: go bottom-up once the frontier
+//  holds more than 1/14 of the unexplored edge volume, and back top-down once it
+//  shrinks below 1/24 of the nodes.
+const id_type bfs_bottom_up_alpha = 14;
+const id_type bfs_top_down_beta = 24;
+const id_type bfs_parallel_grain = 4096;
+//  Average out-degree up to which dijkstra_engine prefers the lazy heap.
+const id_type dijkstra_sparse_degree = 4;
+//  Floyd Warshal tiles are fw_tile_size nodes square, 32KB of doubles. The 16 bit matrix
+//  marks unreachable pairs with fw_short_infinity, so that the sum of two entries never
+//  wraps; floats hold integer distances exactly below fw_float_exact.
+const id_type fw_tile_size = 64;
+const unsigned short fw_short_infinity = 0x7FFF;
+const double fw_float_exact = 16777216.0;
+//  Afforest links this many leading neighbors of every node before sampling the giant
+//  component from cc_giant_samples random nodes.
+const id_type cc_neighbor_rounds = 2;
+const id_type cc_giant_samples = 1024;
+
+template <typename G>
+const id_type CDLib::bfs_engine<G>::unreached = numeric_limits<id_type>::max();
+
+template <typename G>
+CDLib::bfs_engine<G>::bfs_engine(const G& graph_ref) : g(graph_ref), parallel(false) {
+    allocate();
+}
+
+template <typename G>
+CDLib::bfs_engine<G>::bfs_engine(const G& graph_ref, bool parallel_expansion) : g(graph_ref), parallel(parallel_expansion) {
+    allocate();
 }
 
-void CDLib::bfs_visitor(const graph& g, node_set& visited, id_type source) {
-    queue<id_type> q_bfs;
-    q_bfs.push(source);
-    while (!q_bfs.empty()) {
-        id_type current = q_bfs.front();
-        q_bfs.pop();
-        visited.insert(current);
-        for (adjacent_edges_iterator aeit = g.out_edges_begin(current); aeit != g.out_edges_end(current); aeit++) {
-            if (visited.find(aeit->first) == visited.end()) {
-                visited.insert(aeit->first);
-                q_bfs.push(aeit->first);
+template <typename G>
+void CDLib::bfs_engine<G>::allocate() {
+    id_type num_words = (g.get_num_nodes() + bfs_word_bits - 1) / bfs_word_bits;
+    levels.assign(g.get_num_nodes(), unreached);
+    visited.assign(num_words, 0);
+    frontier_bits.assign(num_words, 0);
+    next_bits.assign(num_words, 0);
+    order.reserve(g.get_num_nodes());
+    out_volume = 0;
+    in_volume = 0;
+    for (id_type i = 0; i < g.get_num_nodes(); i++) {
+        out_volume += g.get_node_out_degree(i);
+        in_volume += g.get_node_in_degree(i);
+    }
+}
+
+template <typename G>
+bool CDLib::bfs_engine<G>::use_threads(id_type work) const {
+#ifdef ENABLE_MULTITHREADING
+    return parallel && work >= bfs_parallel_grain && !omp_in_parallel() && omp_get_max_threads() > 1;
+#else
+    return false;
+#endif
+}
+
+template <typename G>
+bool CDLib::bfs_engine<G>::claim(id_type id, bool atomic) {
+    //  Sets the visited bit of id and reports whether this call was the one to set it.
+    unsigned long& word = visited[id / bfs_word_bits];
+    unsigned long mask = 1UL << (id % bfs_word_bits);
+    unsigned long old;
+    if (!atomic) {
+        old = word;
+        word |= mask;
+        return !(old & mask);
+    }
+#ifdef ENABLE_MULTITHREADING
+#pragma omp atomic read
+#endif
+    old = word;
+    if (old & mask) return false;
+#ifdef ENABLE_MULTITHREADING
+#pragma omp atomic capture
+#endif
+    {
+        old = word;
+        word |= mask;
+    }
+    return !(old & mask);
+}
+
+template <typename G>
+void CDLib::bfs_engine<G>::reset() {
+    for (id_type i = 0; i < order.size(); i++) {
+        levels[order[i]] = unreached;
+        visited[order[i] / bfs_word_bits] = 0;
+    }
+    order.clear();
+    level_offsets.clear();
+}
+
+template <typename G>
+void CDLib::bfs_engine<G>::start(id_type source) {
+    reset();
+    claim(source, false);
+    levels[source] = 0;
+    order.push_back(source);
+    level_offsets.push_back(0);
+    level_offsets.push_back(1);
+}
+
+template <typename G>
+bool CDLib::bfs_engine<G>::close_level() {
+    //  Returns false when the last step found nothing, leaving the offsets closed.
+    if (order.size() == level_offsets.back()) return false;
+    level_offsets.push_back(order.size());
+    return true;
+}
+
+template <typename G>
+void CDLib::bfs_engine<G>::expand_node(id_type curr, id_type next_level, bool weak, bool atomic, vector<id_type>& found) {
+    for (auto aeit = g.out_edges_begin(curr); aeit != g.out_edges_end(curr); aeit++) {
+        if (claim(aeit->first, atomic)) {
+            levels[aeit->first] = next_level;
+            found.push_back(aeit->first);
+        }
+    }
+    if (weak) {
+        for (auto aeit = g.in_edges_begin(curr); aeit != g.in_edges_end(curr); aeit++) {
+            if (claim(aeit->first, atomic)) {
+                levels[aeit->first] = next_level;
+                found.push_back(aeit->first);
             }
         }
     }
 }
 
-void bfs_visitor_comps(const graph& g, node_set& not_visited, node_set& visited, id_type source) {
-    queue<id_type> q_bfs;
-    q_bfs.push(source);
-    while (!q_bfs.empty()) {
-        id_type current = q_bfs.front();
-        q_bfs.pop();
-        visited.insert(current);
-        not_visited.erase(current);
-        for (adjacent_edges_iterator aeit = g.out_edges_begin(current); aeit != g.out_edges_end(current); aeit++) {
-            if (visited.find(aeit->first) == visited.end()) {
-                visited.insert(aeit->first);
-                not_visited.erase(aeit->first);
-                q_bfs.push(aeit->first);
+template <typename G>
+void CDLib::bfs_engine<G>::top_down_step(bool weak) {
+    id_type begin = level_offsets[level_offsets.size() - 2], end = level_offsets.back();
+    id_type next_level = levels[order[begin]] + 1;
+    if (!use_threads(end - begin)) {
+        for (id_type i = begin; i < end; i++) expand_node(order[i], next_level, weak, false, order);
+        return;
+    }
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel
+#endif
+    {
+        vector<id_type> found;
+#ifdef ENABLE_MULTITHREADING
+#pragma omp for schedule(dynamic,64)
+#endif
+        for (id_type i = begin; i < end; i++) expand_node(order[i], next_level, weak, true, found);
+#ifdef ENABLE_MULTITHREADING
+#pragma omp critical(bfs_engine_frontier)
+#endif
+        order.insert(order.end(), found.begin(), found.end());
+    }
+}
+
+template <typename G>
+void CDLib::bfs_engine<G>::bottom_up_step(bool weak) {
+    //  Every unvisited node scans its parents for one in the frontier and stops at the
+    //  first hit. Words of the visited bitmap are owned by one iteration, so the scan
+    //  needs no atomics; the new level is read back from next_bits in node order.
+    id_type begin = level_offsets[level_offsets.size() - 2], end = level_offsets.back();
+    id_type next_level = levels[order[begin]] + 1;
+    id_type num_nodes = g.get_num_nodes(), num_words = visited.size();
+    for (id_type i = begin; i < end; i++) frontier_bits[order[i] / bfs_word_bits] |= 1UL << (order[i] % bfs_word_bits);
+#ifdef ENABLE_MULTITHREADING
+    bool threads = use_threads(num_nodes);
+#pragma omp parallel for schedule(static) if(threads)
+#endif
+    for (id_type w = 0; w < num_words; w++) {
+        unsigned long pending = ~visited[w], found = 0;
+        if (w == num_words - 1 && num_nodes % bfs_word_bits) pending &= (1UL << (num_nodes % bfs_word_bits)) - 1;
+        while (pending) {
+            id_type bit = __builtin_ctzl(pending);
+            pending &= pending - 1;
+            id_type curr = w * bfs_word_bits + bit;
+            bool hit = false;
+            for (auto aeit = g.in_edges_begin(curr); !hit && aeit != g.in_edges_end(curr); aeit++)
+                hit = (frontier_bits[aeit->first / bfs_word_bits] >> (aeit->first % bfs_word_bits)) & 1UL;
+            if (weak)
+                for (auto aeit = g.out_edges_begin(curr); !hit && aeit != g.out_edges_end(curr); aeit++)
+                    hit = (frontier_bits[aeit->first / bfs_word_bits] >> (aeit->first % bfs_word_bits)) & 1UL;
+            if (hit) {
+                levels[curr] = next_level;
+                found |= 1UL << bit;
+            }
+        }
+        visited[w] |= found;
+        next_bits[w] = found;
+    }
+    for (id_type i = begin; i < end; i++) frontier_bits[order[i] / bfs_word_bits] = 0;
+    for (id_type w = 0; w < num_words; w++) {
+        while (next_bits[w]) {
+            order.push_back(w * bfs_word_bits + __builtin_ctzl(next_bits[w]));
+            next_bits[w] &= next_bits[w] - 1;
+        }
+    }
+}
+
+template <typename G>
+id_type CDLib::bfs_engine<G>::traverse(id_type source, bool weak, id_type max_level) {
+    start(source);
+    id_type unexplored = out_volume + ((weak) ? in_volume : 0);
+    bool bottom_up = false;
+    while (level_offsets.size() - 2 < max_level) {
+        id_type begin = level_offsets[level_offsets.size() - 2], end = level_offsets.back();
+        id_type frontier_volume = 0;
+        for (id_type i = begin; i < end; i++)
+            frontier_volume += g.get_node_out_degree(order[i]) + ((weak) ? g.get_node_in_degree(order[i]) : 0);
+        unexplored -= frontier_volume;
+        if (!bottom_up && frontier_volume > unexplored / bfs_bottom_up_alpha) bottom_up = true;
+        else if (bottom_up && (end - begin) < g.get_num_nodes() / bfs_top_down_beta) bottom_up = false;
+        if (bottom_up) bottom_up_step(weak);
+        else top_down_step(weak);
+        if (!close_level()) break;
+    }
+    return order.size();
+}
+
+template <typename G>
+id_type CDLib::bfs_engine<G>::run(id_type source) {
+    return traverse(source, false, unreached);
+}
+
+template <typename G>
+id_type CDLib::bfs_engine<G>::run(id_type source, id_type max_level) {
+    return traverse(source, false, max_level);
+}
+
+template <typename G>
+id_type CDLib::bfs_engine<G>::run_weak(id_type source) {
+    return traverse(source, true, unreached);
+}
+
+template <typename G>
+id_type CDLib::bfs_engine<G>::run_percolation(id_type source, double edge_probability) {
+    start(source);
+    RandomGenerator<double> p_gen(0, 1, 0);
+    do {
+        id_type begin = level_offsets[level_offsets.size() - 2], end = level_offsets.back();
+        id_type next_level = levels[order[begin]] + 1;
+        for (id_type i = begin; i < end; i++) {
+            for (auto aeit = g.out_edges_begin(order[i]); aeit != g.out_edges_end(order[i]); aeit++) {
+                if ((p_gen.next() <= edge_probability) && claim(aeit->first, false)) {
+                    levels[aeit->first] = next_level;
+                    order.push_back(aeit->first);
+                }
+            }
+        }
+    } while (close_level());
+    return order.size();
+}
+
+template <typename G>
+bool CDLib::bfs_engine<G>::is_visited(id_type id) const {
+    return (visited[id / bfs_word_bits] >> (id % bfs_word_bits)) & 1UL;
+}
+
+template <typename G>
+id_type CDLib::bfs_engine<G>::get_level(id_type id) const {
+    return levels[id];
+}
+
+template <typename G>
+id_type CDLib::bfs_engine<G>::get_num_levels() const {
+    return (level_offsets.empty()) ? 0 : level_offsets.size() - 1;
+}
+
+template <typename G>
+const vector<id_type>& CDLib::bfs_engine<G>::get_order() const {
+    return order;
+}
+
+template <typename G>
+const vector<id_type>& CDLib::bfs_engine<G>::get_level_offsets() const {
+    return level_offsets;
+}
+
+template <typename G>
+const id_type CDLib::multi_source_bfs<G>::width = bfs_word_bits;
+
+template <typename G>
+CDLib::multi_source_bfs<G>::multi_source_bfs(const G& graph_ref) : g(graph_ref), seen(graph_ref.get_num_nodes(), 0), visit(graph_ref.get_num_nodes(), 0), next(graph_ref.get_num_nodes(), 0), level(0) {
+}
+
+template <typename G>
+id_type CDLib::multi_source_bfs<G>::start(id_type first_source) {
+    for (id_type i = 0; i < discovered.size(); i++) visit[discovered[i]] = 0;
+    seen.assign(g.get_num_nodes(), 0);
+    discovered.clear();
+    level = 0;
+    for (id_type i = first_source; i < g.get_num_nodes() && i - first_source < bfs_word_bits; i++) {
+        seen[i] = visit[i] = 1UL << (i - first_source);
+        discovered.push_back(i);
+    }
+    return discovered.size();
+}
+
+template <typename G>
+bool CDLib::multi_source_bfs<G>::advance() {
+    //  Bits already seen by a neighbor are masked out, so each source claims a node once
+    //  and the new level of the node is the union of the sources that claimed it.
+    scratch.clear();
+    for (id_type i = 0; i < discovered.size(); i++) {
+        id_type curr = discovered[i];
+        unsigned long sources = visit[curr];
+        for (auto aeit = g.out_edges_begin(curr); aeit != g.out_edges_end(curr); aeit++) {
+            unsigned long fresh = sources & ~seen[aeit->first];
+            if (fresh) {
+                if (!next[aeit->first]) scratch.push_back(aeit->first);
+                next[aeit->first] |= fresh;
+                seen[aeit->first] |= fresh;
             }
         }
     }
+    for (id_type i = 0; i < discovered.size(); i++) visit[discovered[i]] = 0;
+    for (id_type i = 0; i < scratch.size(); i++) {
+        visit[scratch[i]] = next[scratch[i]];
+        next[scratch[i]] = 0;
+    }
+    discovered.swap(scratch);
+    level++;
+    return !discovered.empty();
+}
+
+template <typename G>
+id_type CDLib::multi_source_bfs<G>::get_level() const {
+    return level;
+}
+
+template <typename G>
+const vector<id_type>& CDLib::multi_source_bfs<G>::get_discovered() const {
+    return discovered;
+}
+
+template <typename G>
+unsigned long CDLib::multi_source_bfs<G>::get_mask(id_type id) const {
+    return visit[id];
+}
+
+template <typename G>
+CDLib::dijkstra_engine<G>::dijkstra_engine(const G& graph_ref) : g(graph_ref), distances(graph_ref.get_num_nodes(), numeric_limits<double>::infinity()), heap(graph_ref.get_num_nodes(), false), sparse_heap(), buckets(0), choice(use_indexed_heap) {
+    id_type max_weight = 1;
+    order.reserve(g.get_num_nodes());
+    if (!g.is_weighted() || (has_integer_edge_weights(g, max_weight) && max_weight <= bucket_queue::max_span)) {
+        choice = use_buckets;
+        buckets = bucket_queue(max_weight);
+    } else if (g.get_num_edges() <= dijkstra_sparse_degree * g.get_num_nodes()) choice = use_lazy_heap;
 }
 
-double CDLib::single_source_shortest_paths_bfs(const graph& g, id_type source, vector<double>& distances, vector< vector<id_type> >& preds) {
+template <typename G>
+template <typename Q>
+void CDLib::dijkstra_engine<G>::search(id_type source, Q& queue, vector<double>* path_counts) {
+    //  A popped entry with a key above the distance of its node is stale; the indexed
+    //  heap never yields one. Path counts are final when a node is settled since all its
+    //  shortest path predecessors were settled before it.
+    distances[source] = 0;
+    if (path_counts) (*path_counts)[source] = 1;
+    queue.push(source, 0);
+    while (!queue.empty()) {
+        pair<id_type, wt_type> top = queue.top();
+        queue.pop();
+        if (top.second > distances[top.first]) continue;
+        order.push_back(top.first);
+        for (auto aeit = g.out_edges_begin(top.first); aeit != g.out_edges_end(top.first); aeit++) {
+            double alt = top.second + ((g.is_weighted()) ? aeit->second : 1);
+            if (alt < distances[aeit->first]) {
+                distances[aeit->first] = alt;
+                queue.push(aeit->first, alt);
+                if (path_counts) (*path_counts)[aeit->first] = (*path_counts)[top.first];
+            } else if (path_counts && alt == distances[aeit->first]) (*path_counts)[aeit->first] += (*path_counts)[top.first];
+        }
+    }
+}
+
+template <typename G>
+id_type CDLib::dijkstra_engine<G>::run(id_type source) {
+    vector<double>* path_counts = 0;
+    for (id_type i = 0; i < order.size(); i++) distances[order[i]] = numeric_limits<double>::infinity();
+    order.clear();
+    if (source >= g.get_num_nodes()) return 0;
+    if (choice == use_buckets) search(source, buckets, path_counts);
+    else if (choice == use_lazy_heap) search(source, sparse_heap, path_counts);
+    else search(source, heap, path_counts);
+    return order.size();
+}
+
+template <typename G>
+id_type CDLib::dijkstra_engine<G>::run(id_type source, vector<double>& path_counts) {
+    for (id_type i = 0; i < order.size(); i++) distances[order[i]] = numeric_limits<double>::infinity();
+    order.clear();
+    if (source >= g.get_num_nodes()) return 0;
+    if (choice == use_buckets) search(source, buckets, &path_counts);
+    else if (choice == use_lazy_heap) search(source, sparse_heap, &path_counts);
+    else search(source, heap, &path_counts);
+    return order.size();
+}
+
+template <typename G>
+double CDLib::dijkstra_engine<G>::get_distance(id_type id) const {
+    return distances[id];
+}
+
+template <typename G>
+const vector<double>& CDLib::dijkstra_engine<G>::get_distances() const {
+    return distances;
+}
+
+template <typename G>
+const vector<id_type>& CDLib::dijkstra_engine<G>::get_order() const {
+    return order;
+}
+
+template <typename G>
+void CDLib::dfs_visitor(const G& g, node_set& visited, id_type source) {
+    visited.insert(source);
+    for (auto aeit = g.out_edges_begin(source); aeit != g.out_edges_end(source); aeit++)
+        if (visited.find(aeit->first) == visited.end()) dfs_visitor(g, visited, aeit->first);
+}
+
+template <typename G>
+void CDLib::bfs_visitor(const G& g, node_set& visited, id_type source) {
+    bfs_engine<G> engine(g);
+    engine.run(source);
+    visited.insert(engine.get_order().begin(), engine.get_order().end());
+}
+
+template <typename G>
+void bfs_visitor_comps(bfs_engine<G>& engine, node_set& not_visited, node_set& visited, id_type source, bool weak) {
+    //  With weak set, in-edges are followed as well which gives the weakly connected
+    //  component of a directed graph without building an undirected copy.
+    if (weak) engine.run_weak(source);
+    else engine.run(source);
+    const vector<id_type>& reached = engine.get_order();
+    visited.insert(reached.begin(), reached.end());
+    for (id_type i = 0; i < reached.size(); i++) not_visited.erase(reached[i]);
+}
+
+template <typename G>
+double CDLib::single_source_shortest_paths_bfs(const G& g, id_type source, vector<double>& distances, vector< vector<id_type> >& preds) {
     preds.clear();
     distances.assign(g.get_num_nodes(), numeric_limits<double>::infinity());
     preds.assign(g.get_num_nodes(), vector<id_type > ());
-    queue<id_type> q_bfs;
-    q_bfs.push(source);
-    distances[source] = 0;
-    id_type last_node = source;
-    while (!q_bfs.empty()) {
-        id_type current = q_bfs.front();
-        last_node = current;
-        q_bfs.pop();
-        for (adjacent_edges_iterator aeit = g.out_edges_begin(current); aeit != g.out_edges_end(current); aeit++) {
-            if (distances[aeit->first] == numeric_limits<double>::infinity()) {
-                distances[aeit->first] = distances[current] + 1;
-                q_bfs.push(aeit->first);
-            }
+    bfs_engine<G> engine(g);
+    engine.run(source);
+    const vector<id_type>& reached = engine.get_order();
+    for (id_type i = 0; i < reached.size(); i++) distances[reached[i]] = engine.get_level(reached[i]);
+    for (id_type i = 0; i < reached.size(); i++) {
+        id_type current = reached[i];
+        for (auto aeit = g.out_edges_begin(current); aeit != g.out_edges_end(current); aeit++)
             if (distances[aeit->first] == distances[current] + 1)
                 preds[aeit->first].push_back(current);
-        }
     }
-    return distances[last_node];
+    return engine.get_num_levels() - 1;
 }
 
-bool CDLib::is_path_present(const graph& g, id_type source, id_type dest) {
+template <typename G>
+bool CDLib::is_path_present(const G& g, id_type source, id_type dest) {
     node_set visited;
     bfs_visitor(g, visited, source);
     return (visited.find(dest) != visited.end());
 }
 
-id_type CDLib::get_component_around_node_undirected(const graph& g, id_type id, node_set& visited) {
+template <typename G>
+id_type CDLib::get_component_around_node_undirected(const G& g, id_type id, node_set& visited) {
     if (g.is_directed()) return 0;
     bfs_visitor(g, visited, id);
     return visited.size();
 }
 
-id_type CDLib::get_component_around_node_weak(const graph&g, id_type id, node_set& visited) {
+template <typename G>
+id_type CDLib::get_component_around_node_weak(const G& g, id_type id, node_set& visited) {
     if (g.is_directed()) {
-        graph g_temp(g);
-        g_temp.convert_to_undirected();
-        return get_component_around_node_undirected(g_temp, id, visited);
+        node_set not_visited;
+        bfs_engine<G> engine(g);
+        bfs_visitor_comps(engine, not_visited, visited, id, true);
+        return visited.size();
     }
     return get_component_around_node_undirected(g, id, visited);
 }
 
-void tarjan_strongconnect(const graph& g, id_type curr, node_set& visited, vector<id_type>& indices, vector<id_type>& lowlinks) {
-    static id_type index = 0;
-    indices[curr] = index;
-    lowlinks[curr] = index;
-    index++;
-    visited.insert(curr);
-    for (adjacent_edges_iterator aeit = g.out_edges_begin(curr); aeit != g.out_edges_end(curr); aeit++) {
-        if (!indices[aeit->first]) {
-            tarjan_strongconnect(g, aeit->first, visited, indices, lowlinks);
-            lowlinks[curr] = min(lowlinks[curr], lowlinks[aeit->first]);
-        } else if (visited.find(aeit->first) != visited.end())
-            lowlinks[curr] = min(lowlinks[curr], indices[aeit->first]);
+template <typename G>
+void component_link_neighbors(const G& g, concurrent_disjoint_set& sets, id_type id, id_type first_edge, bool with_in_edges) {
+    id_type position = 0;
+    for (auto aeit = g.out_edges_begin(id); aeit != g.out_edges_end(id); aeit++, position++)
+        if (position >= first_edge) sets.join(id, aeit->first);
+    if (with_in_edges)
+        for (auto aeit = g.in_edges_begin(id); aeit != g.in_edges_end(id); aeit++) sets.join(id, aeit->first);
+}
+
+id_type number_components(vector<id_type>& labels) {
+    //  Renames the labels 0, 1, ... in order of the smallest node of each component.
+    vector<id_type> names(labels.size(), numeric_limits<id_type>::max());
+    id_type num_components = 0;
+    for (id_type i = 0; i < labels.size(); i++) {
+        if (names[labels[i]] == numeric_limits<id_type>::max()) names[labels[i]] = num_components++;
+        labels[i] = names[labels[i]];
     }
-    if (indices[curr] != lowlinks[curr]) {
-        visited.clear();
-        visited.insert(curr);
+    return num_components;
+}
+
+template <typename G>
+id_type CDLib::get_connected_component_labels(const G& g, vector<id_type>& labels) {
+    //    Afforest (Sutton et al., 2018). Linking the first neighbors of every node already
+    //    joins most of the giant component; its label is then estimated from a sample and
+    //    the remaining edges are linked only for the nodes outside it. In a directed graph
+    //    the skipped nodes are reached through the in-edges of the others.
+    id_type num_nodes = g.get_num_nodes();
+    labels.resize(num_nodes);
+    if (!num_nodes) return 0;
+    concurrent_disjoint_set sets(num_nodes);
+    for (id_type round = 0; round < cc_neighbor_rounds; round++) {
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel for schedule(dynamic,1024) shared(g,sets,round)
+#endif
+        for (id_type i = 0; i < num_nodes; i++) {
+            id_type position = 0;
+            for (auto aeit = g.out_edges_begin(i); aeit != g.out_edges_end(i) && position <= round; aeit++, position++)
+                if (position == round) sets.join(i, aeit->first);
+        }
+    }
+    mt19937 sampler;
+    unordered_map<id_type, id_type> counts;
+    id_type giant = 0, giant_count = 0;
+    for (id_type i = 0; i < cc_giant_samples; i++) {
+        id_type root = sets.find(sampler() % num_nodes);
+        if (++counts[root] > giant_count) {
+            giant_count = counts[root];
+            giant = root;
+        }
+    }
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel for schedule(dynamic,1024) shared(g,sets,giant)
+#endif
+    for (id_type i = 0; i < num_nodes; i++)
+        if (sets.find(i) != giant) component_link_neighbors(g, sets, i, cc_neighbor_rounds, g.is_directed());
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel for schedule(static) shared(sets,labels)
+#endif
+    for (id_type i = 0; i < num_nodes; i++) labels[i] = sets.find(i);
+    return number_components(labels);
+}
+
+template <typename G>
+id_type CDLib::get_strongly_connected_component_labels(const G& g, vector<id_type>& labels) {
+    //    Iterative form of Tarjan's algorithm, so deep graphs do not exhaust the call stack.
+    //    Each frame keeps its node and the next out-edge to explore.
+    if (!g.is_directed()) return get_connected_component_labels(g, labels);
+    typedef decltype(g.out_edges_begin(0)) edge_iterator;
+    id_type num_nodes = g.get_num_nodes(), counter = 0, num_components = 0;
+    const id_type unvisited = numeric_limits<id_type>::max();
+    vector<id_type> indices(num_nodes, unvisited), lowlinks(num_nodes, 0), members;
+    vector<char> on_stack(num_nodes, 0);
+    vector< pair<id_type, edge_iterator> > frames;
+    labels.assign(num_nodes, 0);
+    for (id_type root = 0; root < num_nodes; root++) {
+        if (indices[root] != unvisited) continue;
+        indices[root] = lowlinks[root] = counter++;
+        members.push_back(root);
+        on_stack[root] = 1;
+        frames.push_back(make_pair(root, g.out_edges_begin(root)));
+        while (!frames.empty()) {
+            id_type curr = frames.back().first;
+            if (frames.back().second != g.out_edges_end(curr)) {
+                id_type next = frames.back().second->first;
+                frames.back().second++;
+                if (indices[next] == unvisited) {
+                    indices[next] = lowlinks[next] = counter++;
+                    members.push_back(next);
+                    on_stack[next] = 1;
+                    frames.push_back(make_pair(next, g.out_edges_begin(next)));
+                } else if (on_stack[next] && indices[next] < lowlinks[curr]) lowlinks[curr] = indices[next];
+                continue;
+            }
+            frames.pop_back();
+            if (!frames.empty() && lowlinks[curr] < lowlinks[frames.back().first]) lowlinks[frames.back().first] = lowlinks[curr];
+            if (lowlinks[curr] != indices[curr]) continue;
+            id_type member;
+            do {
+                member = members.back();
+                members.pop_back();
+                on_stack[member] = 0;
+                labels[member] = num_components;
+            } while (member != curr);
+            num_components++;
+        }
     }
+    return number_components(labels);
+}
+
+id_type labels_to_components(const vector<id_type>& labels, id_type num_components, vector<node_set>& components) {
+    id_type first = components.size();
+    components.resize(first + num_components);
+    for (id_type i = 0; i < labels.size(); i++) components[first + labels[i]].insert(i);
+    return components.size();
+}
+
+id_type largest_label(const vector<id_type>& labels, id_type num_components, id_type& size) {
+    //  Ties go to the component with the smallest node.
+    vector<id_type> sizes(num_components, 0);
+    for (id_type i = 0; i < labels.size(); i++) sizes[labels[i]]++;
+    id_type largest = 0;
+    size = 0;
+    for (id_type i = 0; i < num_components; i++)
+        if (sizes[i] > size) {
+            size = sizes[i];
+            largest = i;
+        }
+    return largest;
 }
 
-id_type CDLib::get_component_around_node_strong(const graph& g, id_type id, node_set& visited) {
+template <typename G>
+id_type CDLib::get_component_around_node_strong(const G& g, id_type id, node_set& visited) {
     if (g.is_directed()) {
-        vector<id_type> indices(g.get_num_nodes(), 0), lowlinks(g.get_num_nodes(), 0);
-        tarjan_strongconnect(g, id, visited, indices, lowlinks);
+        vector<id_type> labels;
+        get_strongly_connected_component_labels(g, labels);
+        for (id_type i = 0; i < labels.size(); i++)
+            if (labels[i] == labels[id]) visited.insert(i);
         return visited.size();
     }
     return get_component_around_node_undirected(g, id, visited);
 }
 
-bool CDLib::is_connected_undirected(const graph& g) {
+template <typename G>
+bool CDLib::is_connected_undirected(const G& g) {
     if (g.is_directed()) return false;
-    node_set visited;
-    return (get_component_around_node_undirected(g, 0, visited) == g.get_num_nodes());
+    bfs_engine<G> engine(g);
+    return (engine.run(0) == g.get_num_nodes());
 }
 
-bool CDLib::is_connected_weakly(const graph& g) {
+template <typename G>
+bool CDLib::is_connected_weakly(const G& g) {
     if (!g.is_directed()) return is_connected_undirected(g);
-    node_set visited;
-    return (get_component_around_node_weak(g, 0, visited) == g.get_num_nodes());
+    bfs_engine<G> engine(g);
+    return (engine.run_weak(0) == g.get_num_nodes());
 }
 
-bool CDLib::is_connected_strongly(const graph& g) {
+template <typename G>
+bool CDLib::is_connected_strongly(const G& g) {
     if (!g.is_directed()) return false;
-    node_set visited;
-    return (get_component_around_node_strong(g, 0, visited) == g.get_num_nodes());
+    vector<id_type> labels;
+    return (get_strongly_connected_component_labels(g, labels) == 1);
 }
 
-id_type CDLib::get_largest_connected_component(const graph& g, node_set &members) {
+template <typename G>
+id_type CDLib::get_largest_connected_component(const G& g, node_set &members) {
     //Return the size of the largest connected component in the graph. It also
     //populates the set 'members' with the members of the largest connected component.
     //Returns strongly connected components for a directed graph.
-    vector<node_set> components;
+    vector<id_type> labels;
+    id_type num_components = get_strongly_connected_component_labels(g, labels), max_size;
+    id_type largest = largest_label(labels, num_components, max_size);
     members.clear();
-    if (g.is_directed()) {
-        get_connected_components_undirected(g, components);
-    } else {
-        get_strongly_connected_components(g, components);
-    }
-    id_type max_size = 0, max_id = 0;
-    for (id_type i = 0; i < components.size(); i++) {
-        if (components[i].size() > max_size) {
-            max_size = components[i].size();
-            max_id = i;
-        }
-    }
-    if (components.size() > 0)
-        members.insert(components[max_id].begin(), components[max_id].end());
+    for (id_type i = 0; i < labels.size(); i++)
+        if (labels[i] == largest) members.insert(i);
     return max_size;
 }
 
-id_type CDLib::get_connected_components_undirected(const graph& g, vector<node_set>& components) {
-    //    if(g.is_directed()) return 0;
-    //    components.clear();
-    //    for(id_type i = 0; i<g.get_num_nodes(); i++)
-    //    {
-    //        bool is_found = false;
-    //        for(id_type j=0;j<components.size();j++)
-    //        {
-    //            //is_found = is_found || components[j].find(i) != components[j].end();
-    //            if(components[j].find(i) != components[j].end())
-    //            {
-    //                is_found = true;
-    //                break;
-    //            }
-    //        }
-    //        if(!is_found)
-    //        {
-    //            components.push_back(node_set());
-    //            get_component_around_node_undirected(g,i,components[components.size()-1]);
-    //        }
-    //    }
-    //    return components.size();
-    node_set not_visited;
-    for (id_type i = 0; i < g.get_num_nodes(); i++) not_visited.insert(i);
-    while (not_visited.size()) {
-        components.push_back(node_set());
-        bfs_visitor_comps(g, not_visited, components[components.size() - 1], *(not_visited.begin()));
-    }
-    return components.size();
+template <typename G>
+id_type CDLib::get_connected_components_undirected(const G& g, vector<node_set>& components) {
+    vector<id_type> labels;
+    id_type num_components = get_connected_component_labels(g, labels);
+    return labels_to_components(labels, num_components, components);
 }
 
-id_type CDLib::get_weakly_connected_components(const graph& g, vector<node_set>& components) {
-    if (g.is_directed()) {
-        graph g_temp(g);
-        g_temp.convert_to_undirected();
-        return get_connected_components_undirected(g_temp, components);
-    } else return get_connected_components_undirected(g, components);
+template <typename G>
+id_type CDLib::get_weakly_connected_components(const G& g, vector<node_set>& components) {
+    return get_connected_components_undirected(g, components);
 }
 
-id_type CDLib::get_strongly_connected_components(const graph& g, vector<node_set>& components) {
-    if (g.is_directed()) {
-        for (id_type i = 0; i < g.get_num_nodes(); i++) {
-            bool is_found = false;
-            for (id_type j = 0; j < components.size(); j++) is_found = is_found || (components[j].find(i) != components[j].end());
-            if (!is_found) {
-                components.push_back(node_set());
-                get_component_around_node_strong(g, i, components.back());
-            }
-        }
-        return components.size();
-    } else return get_connected_components_undirected(g, components);
+template <typename G>
+id_type CDLib::get_strongly_connected_components(const G& g, vector<node_set>& components) {
+    vector<id_type> labels;
+    id_type num_components = get_strongly_connected_component_labels(g, labels);
+    return labels_to_components(labels, num_components, components);
 }
 
-double CDLib::fraction_of_nodes_in_LCC(const graph& g) {
-    node_set members;
-    id_type large_size = get_largest_connected_component(g, members);
+template <typename G>
+double CDLib::fraction_of_nodes_in_LCC(const G& g) {
+    vector<id_type> labels;
+    id_type num_components = get_strongly_connected_component_labels(g, labels), large_size;
+    largest_label(labels, num_components, large_size);
     return (double) large_size / g.get_num_nodes();
 }
 
-bool visit_topsort(const graph& g, id_type id, vector<id_type>& ordering, node_set& visited) {
+template <typename G>
+bool visit_topsort(const G& g, id_type id, vector<id_type>& ordering, node_set& visited) {
     visited.insert(id);
-    for (adjacent_edges_iterator aeit = g.in_edges_begin(id); aeit != g.in_edges_end(id); aeit++) {
+    for (auto aeit = g.in_edges_begin(id); aeit != g.in_edges_end(id); aeit++) {
         if (visited.find(aeit->first) != visited.end()) return false;
         return visit_topsort(g, aeit->first, ordering, visited);
     }
@@ -233,7 +705,8 @@ bool visit_topsort(const graph& g, id_type id, vector<id_type>& ordering, node_s
     return true;
 }
 
-bool CDLib::get_topological_ordering(const graph& g, vector<id_type>& ordering) {
+template <typename G>
+bool CDLib::get_topological_ordering(const G& g, vector<id_type>& ordering) {
     node_set visited;
     for (id_type i = 0; i < g.get_num_nodes(); i++) {
         if (!g.get_node_out_degree(i) && !visit_topsort(g, i, ordering, visited)) return false;
@@ -241,47 +714,156 @@ bool CDLib::get_topological_ordering(const graph& g, vector<id_type>& ordering)
     return true;
 }
 
-double CDLib::single_source_shortest_paths_djikstra(const graph&g, id_type source, vector<double>& distances, vector< vector<id_type> >& preds) {
-    if (!g.is_weighted()) single_source_shortest_paths_bfs(g, source, distances, preds);
+template <typename G>
+double CDLib::single_source_shortest_paths_djikstra(const G& g, id_type source, vector<double>& distances, vector< vector<id_type> >& preds) {
+    if (!g.is_weighted()) return single_source_shortest_paths_bfs(g, source, distances, preds);
     else if (!has_negative_edge_weights(g)) {
         distances.assign(g.get_num_nodes(), numeric_limits<double>::infinity());
         preds.assign(g.get_num_nodes(), vector<id_type > ());
-        distances[source] = 0;
-        binary_heap p_queue(distances, false);
-        id_type last_node = source;
-        while (!p_queue.empty()) {
-            id_type curr = p_queue.top().first;
-            last_node = curr;
-            p_queue.pop();
-            if (distances[curr] == numeric_limits<double>::infinity()) break;
-            for (adjacent_edges_iterator aeit = g.out_edges_begin(curr); aeit != g.out_edges_end(curr); aeit++) {
-                double alt = distances[curr] + aeit->second;
-                if (alt <= distances[aeit->first]) {
-                    distances[aeit->first] = alt;
-                    p_queue.update_key(make_pair(aeit->first, alt));
-                    preds[aeit->first].push_back(curr);
+        dijkstra_engine<G> engine(g);
+        engine.run(source);
+        const vector<id_type>& reached = engine.get_order();
+        for (id_type i = 0; i < reached.size(); i++) distances[reached[i]] = engine.get_distance(reached[i]);
+        for (id_type i = 0; i < reached.size(); i++) {
+            id_type current = reached[i];
+            for (auto aeit = g.out_edges_begin(current); aeit != g.out_edges_end(current); aeit++)
+                if (distances[aeit->first] == distances[current] + aeit->second)
+                    preds[aeit->first].push_back(current);
+        }
+        return (reached.empty()) ? 0 : distances[reached.back()];
+    }
+    return 0;
+}
+
+bool relax_distance(atomic<double>& slot, double value) {
+    //  Atomic minimum on a double; a failed exchange reloads the current value.
+    double current = slot.load();
+    while (value < current)
+        if (slot.compare_exchange_weak(current, value)) return true;
+    return false;
+}
+
+template <typename G>
+double CDLib::single_source_shortest_paths_delta_stepping(const G& g, id_type source, double delta, vector<double>& distances) {
+    if (g.is_weighted() && has_negative_edge_weights(g)) return 0;
+    distances.assign(g.get_num_nodes(), numeric_limits<double>::infinity());
+    if (source >= g.get_num_nodes()) return 0;
+    if (delta <= 0) delta = (g.get_num_edges()) ? g.get_total_weight() / g.get_num_edges() : 1;
+    vector< atomic<double> > tentative(g.get_num_nodes());
+    for (id_type i = 0; i < g.get_num_nodes(); i++) tentative[i].store(numeric_limits<double>::infinity());
+    vector<id_type> frontier(1, source);
+    tentative[source].store(0);
+    id_type current_bucket = 0, next_bucket = numeric_limits<id_type>::max();
+    //    Every thread keeps its own buckets, keyed by index so that a small delta leaves no
+    //    run of empty buckets behind; the frontier of the next round is the union of the
+    //    smallest non-empty bucket across threads. A node whose distance dropped into an
+    //    earlier bucket since it was queued has already been relaxed and is skipped. Bucket
+    //    indices are always computed from a distance by the same division, so rounding
+    //    cannot place a node in one bucket and test it against another.
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel shared(g,tentative,frontier,current_bucket,next_bucket)
+#endif
+    {
+        map< id_type, vector<id_type> > buckets;
+        while (!frontier.empty()) {
+#ifdef ENABLE_MULTITHREADING
+#pragma omp for schedule(dynamic,64) nowait
+#endif
+            for (id_type i = 0; i < frontier.size(); i++) {
+                id_type curr = frontier[i];
+                double dist_curr = tentative[curr].load();
+                if ((id_type) (dist_curr / delta) != current_bucket) continue;
+                for (auto aeit = g.out_edges_begin(curr); aeit != g.out_edges_end(curr); aeit++) {
+                    double alt = dist_curr + ((g.is_weighted()) ? aeit->second : 1);
+                    if (relax_distance(tentative[aeit->first], alt))
+                        buckets[(id_type) (alt / delta)].push_back(aeit->first);
                 }
             }
+#ifdef ENABLE_MULTITHREADING
+#pragma omp critical(delta_stepping_next)
+#endif
+            if (!buckets.empty() && buckets.begin()->first < next_bucket) next_bucket = buckets.begin()->first;
+#ifdef ENABLE_MULTITHREADING
+#pragma omp barrier
+#pragma omp single
+#endif
+            {
+                frontier.clear();
+                current_bucket = next_bucket;
+                next_bucket = numeric_limits<id_type>::max();
+            }
+            if (!buckets.empty() && buckets.begin()->first == current_bucket) {
+#ifdef ENABLE_MULTITHREADING
+#pragma omp critical(delta_stepping_frontier)
+#endif
+                frontier.insert(frontier.end(), buckets.begin()->second.begin(), buckets.begin()->second.end());
+                buckets.erase(buckets.begin());
+            }
+#ifdef ENABLE_MULTITHREADING
+#pragma omp barrier
+#endif
         }
-        return distances[last_node];
     }
-    return 0;
+    double max_distance = 0;
+    for (id_type i = 0; i < distances.size(); i++) {
+        distances[i] = tentative[i].load();
+        if (distances[i] != numeric_limits<double>::infinity() && distances[i] > max_distance)
+            max_distance = distances[i];
+    }
+    return max_distance;
 }
 
-double CDLib::diameter(const graph& g) {
+template <typename G>
+double CDLib::single_source_shortest_paths_delta_stepping(const G& g, id_type source, double delta, vector<double>& distances, vector< vector<id_type> >& preds, vector<double>& path_counts) {
+    //    Predecessors are the in-neighbors lying exactly one edge length closer, so each
+    //    node collects its own list. Path counts then follow in order of distance.
+    double max_distance = single_source_shortest_paths_delta_stepping(g, source, delta, distances);
+    preds.assign(g.get_num_nodes(), vector<id_type>());
+    path_counts.assign(g.get_num_nodes(), 0);
+    if (source >= g.get_num_nodes() || distances[source] != 0) return max_distance;
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel for schedule(dynamic,256) shared(g,distances,preds)
+#endif
+    for (id_type i = 0; i < g.get_num_nodes(); i++) {
+        if (i == source || distances[i] == numeric_limits<double>::infinity()) continue;
+        for (auto aeit = g.in_edges_begin(i); aeit != g.in_edges_end(i); aeit++)
+            if (distances[aeit->first] + ((g.is_weighted()) ? aeit->second : 1) == distances[i])
+                preds[i].push_back(aeit->first);
+    }
+    vector< pair<double, id_type> > order;
+    for (id_type i = 0; i < g.get_num_nodes(); i++)
+        if (distances[i] != numeric_limits<double>::infinity())
+            order.push_back(make_pair(distances[i], i));
+    sort(order.begin(), order.end());
+    path_counts[source] = 1;
+    for (id_type i = 0; i < order.size(); i++) {
+        id_type curr = order[i].second;
+        for (id_type j = 0; j < preds[curr].size(); j++)
+            path_counts[curr] += path_counts[preds[curr][j]];
+    }
+    return max_distance;
+}
+
+template <typename G>
+double CDLib::diameter(const G& g) {
+    if (!g.is_weighted()) {
+        vector<id_type> reach;
+        vector<double> distance_sum;
+        double inverse_distance_sum;
+        return hop_distance_statistics(g, reach, distance_sum, inverse_distance_sum);
+    }
     double max = 0;
     for (id_type i = 0; i < g.get_num_nodes(); i++) {
         vector<double> distances;
         vector< vector<id_type> > preds;
-        double test_diameter;
-        if (!g.is_weighted()) test_diameter = single_source_shortest_paths_bfs(g, i, distances, preds);
-        else test_diameter = single_source_shortest_paths_djikstra(g, i, distances, preds);
+        double test_diameter = single_source_shortest_paths_djikstra(g, i, distances, preds);
         if (max < test_diameter) max = test_diameter;
     }
     return max;
 }
 
-void CDLib::all_pairs_shortest_paths(const graph& g, vector< vector<double> >& path_matrix) {
+template <typename G>
+void CDLib::all_pairs_shortest_paths(const G& g, vector< vector<double> >& path_matrix) {
     //    The node_control value is set to control the memory overload due to large number of nodes. This value can be
     //    set depending on the available memory of the system. The memory calculation is:
     //    memory = node_control x node_control x 8 x 2 + some small constant
@@ -302,7 +884,115 @@ void CDLib::all_pairs_shortest_paths(const graph& g, vector< vector<double> >& p
     }
 }
 
-void CDLib::all_pairs_shortest_paths_djikshtra(const graph& g, vector< vector<double> >& path_matrix) {
+template <typename G>
+void CDLib::all_pairs_shortest_paths_reduce(const G& g, distance_row_reducer& reducer) {
+    reducer.reset(g.get_num_nodes());
+    if (g.is_weighted() && has_negative_edge_weights(g)) {
+        vector< vector<double> > path_matrix;
+        all_pairs_shortest_paths_floyd_warshal(g, path_matrix);
+        for (id_type i = 0; i < g.get_num_nodes(); i++) reducer.reduce(i, path_matrix[i]);
+        return;
+    }
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel shared(g,reducer)
+#endif
+    {
+        vector<double> distances(g.get_num_nodes(), numeric_limits<double>::infinity());
+        bfs_engine<G> engine(g);
+        dijkstra_engine<G> weighted_engine(g);
+#ifdef ENABLE_MULTITHREADING
+#pragma omp for schedule(dynamic,16)
+#endif
+        for (id_type i = 0; i < g.get_num_nodes(); i++) {
+            if (g.is_weighted()) {
+                weighted_engine.run(i);
+                reducer.reduce(i, weighted_engine.get_distances());
+                continue;
+            }
+            engine.run(i);
+            const vector<id_type>& reached = engine.get_order();
+            for (id_type j = 0; j < reached.size(); j++) distances[reached[j]] = engine.get_level(reached[j]);
+            reducer.reduce(i, distances);
+            for (id_type j = 0; j < reached.size(); j++) distances[reached[j]] = numeric_limits<double>::infinity();
+        }
+    }
+}
+
+void distance_sum_reducer::reset(id_type num_nodes) {
+    sums.assign(num_nodes, 0);
+}
+
+void distance_sum_reducer::reduce(id_type source, const vector<double>& distances) {
+    double sum = 0;
+    for (id_type j = 0; j < distances.size(); j++)
+        sum += distances[j];
+    sums[source] = sum;
+}
+
+const vector<double>& distance_sum_reducer::get_sums() const {
+    return sums;
+}
+
+void harmonic_sum_reducer::reset(id_type num_nodes) {
+    sums.assign(num_nodes, 0);
+}
+
+void harmonic_sum_reducer::reduce(id_type source, const vector<double>& distances) {
+    double sum = 0;
+    for (id_type j = 0; j < distances.size(); j++)
+        if (source != j)
+            sum += 1 / distances[j];
+    sums[source] = sum;
+}
+
+const vector<double>& harmonic_sum_reducer::get_sums() const {
+    return sums;
+}
+
+void eccentricity_reducer::reset(id_type num_nodes) {
+    eccentricities.assign(num_nodes, 0);
+}
+
+void eccentricity_reducer::reduce(id_type source, const vector<double>& distances) {
+    double max = 0;
+    for (id_type j = 0; j < distances.size(); j++)
+        if (distances[j] != numeric_limits<double>::infinity() && distances[j] > max)
+            max = distances[j];
+    eccentricities[source] = max;
+}
+
+const vector<double>& eccentricity_reducer::get_eccentricities() const {
+    return eccentricities;
+}
+
+void distance_histogram_reducer::reset(id_type num_nodes) {
+#ifdef ENABLE_MULTITHREADING
+    thread_counts.assign(omp_get_max_threads(), map<double, id_type>());
+#else
+    thread_counts.assign(1, map<double, id_type>());
+#endif
+}
+
+void distance_histogram_reducer::reduce(id_type source, const vector<double>& distances) {
+#ifdef ENABLE_MULTITHREADING
+    map<double, id_type>& counts = thread_counts[omp_get_thread_num()];
+#else
+    map<double, id_type>& counts = thread_counts[0];
+#endif
+    for (id_type j = 0; j < distances.size(); j++)
+        if (source != j && distances[j] != numeric_limits<double>::infinity())
+            counts[distances[j]]++;
+}
+
+void distance_histogram_reducer::get_histogram(map<double, id_type>& histogram) const {
+    histogram.clear();
+    for (id_type i = 0; i < thread_counts.size(); i++)
+        for (map<double, id_type>::const_iterator it = thread_counts[i].begin(); it != thread_counts[i].end(); it++)
+            histogram[it->first] += it->second;
+}
+
+template <typename G>
+void CDLib::all_pairs_shortest_paths_djikshtra(const G& g, vector< vector<double> >& path_matrix) {
     path_matrix.assign(g.get_num_nodes(), vector<double>());
 #ifdef ENABLE_MULTITHREADING
 #pragma omp parallel for shared(g,path_matrix)
@@ -314,38 +1004,124 @@ void CDLib::all_pairs_shortest_paths_djikshtra(const graph& g, vector< vector<do
     }
 }
 
-void CDLib::all_pairs_shortest_paths_floyd_warshal(const graph& g, vector< vector<double> >& path_matrix) {
-    //    Should be used only when space is not a constraint.
-    path_matrix.clear();
-    vector< vector<double> > prev(g.get_num_nodes(), vector<double>(g.get_num_nodes(), numeric_limits<double>::infinity()));
-    vector< vector<double> > next(g.get_num_nodes(), vector<double>(g.get_num_nodes(), numeric_limits<double>::infinity()));
-
+template <typename T>
+void floyd_warshal_tile(vector<T>& dist, id_type stride, id_type row, id_type col, id_type mid) {
+    //  Relaxes tile (row, col) through the nodes of tile mid. The k loop stays outermost
+    //  so a tile may be relaxed through itself; the inner loop runs over contiguous rows
+    //  of both tiles and is left to the vectorizer.
+    for (id_type k = mid; k < mid + fw_tile_size; k++) {
+        const T* through = &dist[k * stride + col];
+        for (id_type i = row; i < row + fw_tile_size; i++) {
+            T to_k = dist[i * stride + k];
+            T* target = &dist[i * stride + col];
+            for (id_type j = 0; j < fw_tile_size; j++) {
+                T alt = to_k + through[j];
+                target[j] = (alt < target[j]) ? alt : target[j];
+            }
+        }
+    }
+}
 
+template <typename G, typename T>
+id_type floyd_warshal_tiled(const G& g, T infinity, vector<T>& dist) {
+    //  Blocked Floyd Warshal of Venkataraman et al. (2003) on one contiguous matrix padded to
+    //  whole tiles. For every diagonal tile, the tile itself is relaxed first, then the tiles
+    //  of its row and column, then all the others; the tiles of the last two phases are
+    //  independent and shared out among the threads. Returns the row stride.
+    id_type num_tiles = (g.get_num_nodes() + fw_tile_size - 1) / fw_tile_size;
+    id_type stride = num_tiles * fw_tile_size;
+    dist.assign(stride * stride, infinity);
     for (id_type i = 0; i < g.get_num_nodes(); i++) {
-        for (adjacent_edges_iterator aeit = g.out_edges_begin(i); aeit != g.out_edges_end(i); aeit++) {
-            prev[i][aeit->first] = aeit->second;
-        }
-        prev[i][i] = 0;
+        for (auto aeit = g.out_edges_begin(i); aeit != g.out_edges_end(i); aeit++)
+            dist[i * stride + aeit->first] = static_cast<T> (aeit->second);
+        dist[i * stride + i] = 0;
     }
-    for (id_type k = 0; k < g.get_num_nodes(); k++) {
+    for (id_type t = 0; t < num_tiles; t++) {
+        id_type mid = t * fw_tile_size;
+        floyd_warshal_tile(dist, stride, mid, mid, mid);
 #ifdef ENABLE_MULTITHREADING
-#pragma omp parallel for schedule(dynamic,10) shared(k,next,g)
+#pragma omp parallel for schedule(dynamic,1) shared(dist)
 #endif
-        for (id_type i = 0; i < g.get_num_nodes(); i++) {
-            for (id_type j = 0; j < g.get_num_nodes(); j++) {
-                next[i][j] = ((prev[i][j] < (prev[i][k] + prev[k][j])) ? prev[i][j] : (prev[i][k] + prev[k][j]));
-            }
+        for (id_type b = 0; b < num_tiles; b++) {
+            if (b == t) continue;
+            floyd_warshal_tile(dist, stride, mid, b * fw_tile_size, mid);
+            floyd_warshal_tile(dist, stride, b * fw_tile_size, mid, mid);
+        }
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel for schedule(dynamic,1) shared(dist)
+#endif
+        for (id_type b = 0; b < num_tiles * num_tiles; b++) {
+            id_type row = b / num_tiles, col = b % num_tiles;
+            if (row == t || col == t) continue;
+            floyd_warshal_tile(dist, stride, row * fw_tile_size, col * fw_tile_size, mid);
         }
-        prev.clear();
-        prev.assign(next.begin(), next.end());
-        next.clear();
-        if (k < (g.get_num_nodes() - 1))
-            next.assign(g.get_num_nodes(), vector<double>(g.get_num_nodes(), numeric_limits<double>::infinity()));
     }
-    path_matrix.assign(prev.begin(), prev.end());
+    return stride;
+}
+
+template <typename T>
+void floyd_warshal_compact(vector<T>& dist, id_type stride, id_type num_nodes, T infinity, T unreachable) {
+    //  Drops the padding in place, rows only ever move towards the front.
+    for (id_type i = 0; i < num_nodes; i++)
+        for (id_type j = 0; j < num_nodes; j++) {
+            T value = dist[i * stride + j];
+            dist[i * num_nodes + j] = (value < infinity) ? value : unreachable;
+        }
+    dist.resize(num_nodes * num_nodes);
+    dist.shrink_to_fit();
+}
+
+template <typename G, typename T>
+void floyd_warshal_rows(const G& g, T infinity, vector< vector<double> >& path_matrix) {
+    vector<T> dist;
+    id_type stride = floyd_warshal_tiled(g, infinity, dist);
+    path_matrix.assign(g.get_num_nodes(), vector<double>(g.get_num_nodes()));
+    for (id_type i = 0; i < g.get_num_nodes(); i++)
+        for (id_type j = 0; j < g.get_num_nodes(); j++) {
+            T value = dist[i * stride + j];
+            path_matrix[i][j] = (value < infinity) ? static_cast<double> (value) : numeric_limits<double>::infinity();
+        }
+}
+
+template <typename G>
+double longest_integer_distance(const G& g) {
+    //  Bound on any shortest path length for non-negative integer weights, infinite otherwise.
+    id_type max_weight;
+    if (!has_integer_edge_weights(g, max_weight)) return numeric_limits<double>::infinity();
+    return (g.get_num_nodes()) ? static_cast<double> (max_weight) * (g.get_num_nodes() - 1) : 0;
+}
+
+template <typename G>
+void CDLib::all_pairs_shortest_paths_floyd_warshal(const G& g, vector< vector<double> >& path_matrix) {
+    //    Should be used only when space is not a constraint.
+    path_matrix.clear();
+    if (!g.get_num_nodes()) return;
+    double longest = longest_integer_distance(g);
+    if (longest < fw_short_infinity) floyd_warshal_rows(g, fw_short_infinity, path_matrix);
+    else if (longest < fw_float_exact) floyd_warshal_rows(g, numeric_limits<float>::infinity(), path_matrix);
+    else floyd_warshal_rows(g, numeric_limits<double>::infinity(), path_matrix);
+}
+
+template <typename G>
+bool CDLib::all_pairs_shortest_paths_floyd_warshal(const G& g, vector<float>& path_matrix) {
+    path_matrix.clear();
+    if (!(longest_integer_distance(g) < fw_float_exact)) return false;
+    id_type stride = floyd_warshal_tiled(g, numeric_limits<float>::infinity(), path_matrix);
+    floyd_warshal_compact(path_matrix, stride, g.get_num_nodes(), numeric_limits<float>::infinity(), numeric_limits<float>::infinity());
+    return true;
 }
 
-void CDLib::single_source_shortest_paths_djikstra_with_paths(const graph&g, id_type source, vector<double>& distances, vector< vector<id_type> >& paths) {
+template <typename G>
+bool CDLib::all_pairs_shortest_paths_floyd_warshal(const G& g, vector<unsigned short>& path_matrix) {
+    path_matrix.clear();
+    if (!(longest_integer_distance(g) < fw_short_infinity)) return false;
+    id_type stride = floyd_warshal_tiled(g, fw_short_infinity, path_matrix);
+    floyd_warshal_compact(path_matrix, stride, g.get_num_nodes(), fw_short_infinity, numeric_limits<unsigned short>::max());
+    return true;
+}
+
+template <typename G>
+void CDLib::single_source_shortest_paths_djikstra_with_paths(const G& g, id_type source, vector<double>& distances, vector< vector<id_type> >& paths) {
     vector< vector<id_type> > preds;
     single_source_shortest_paths_djikstra(g, source, distances, preds);
     paths.assign(g.get_num_nodes(), vector<id_type > ());
@@ -367,15 +1143,28 @@ void CDLib::single_source_shortest_paths_djikstra_with_paths(const graph&g, id_t
     }
 }
 
-bool CDLib::has_negative_edge_weights(const graph& g) {
+template <typename G>
+bool CDLib::has_negative_edge_weights(const G& g) {
     for (id_type i = 0; i < g.get_num_nodes(); i++)
-        for (adjacent_edges_iterator aeit = g.out_edges_begin(i); aeit != g.out_edges_end(i); aeit++)
+        for (auto aeit = g.out_edges_begin(i); aeit != g.out_edges_end(i); aeit++)
             if (aeit->second < 0) return true;
     return false;
 }
 
-void do_count_paths(const graph& g, id_type source, id_type dest, unordered_set<id_type>& visited, vector<id_type>& paths) {
-    for (adjacent_edges_iterator aeit = g.out_edges_begin(source); aeit != g.out_edges_end(source); aeit++) {
+template <typename G>
+bool CDLib::has_integer_edge_weights(const G& g, id_type& max_weight) {
+    max_weight = 0;
+    for (id_type i = 0; i < g.get_num_nodes(); i++)
+        for (auto aeit = g.out_edges_begin(i); aeit != g.out_edges_end(i); aeit++) {
+            if (aeit->second < 0 || aeit->second != floor(aeit->second) || aeit->second >= numeric_limits<id_type>::max()) return false;
+            if (aeit->second > max_weight) max_weight = static_cast<id_type> (aeit->second);
+        }
+    return true;
+}
+
+template <typename G>
+void do_count_paths(const G& g, id_type source, id_type dest, unordered_set<id_type>& visited, vector<id_type>& paths) {
+    for (auto aeit = g.out_edges_begin(source); aeit != g.out_edges_end(source); aeit++) {
         if (aeit->first == dest) paths[visited.size()]++;
         else if (visited.find(aeit->first) == visited.end()) {
             unordered_set<id_type> visited2(visited);
@@ -385,7 +1174,8 @@ void do_count_paths(const graph& g, id_type source, id_type dest, unordered_set<
     }
 }
 
-void CDLib::get_all_paths(const graph& g, id_type source, id_type dest, vector<id_type>& paths) {
+template <typename G>
+void CDLib::get_all_paths(const G& g, id_type source, id_type dest, vector<id_type>& paths) {
     paths.clear();
     paths.assign(g.get_num_nodes(), 0);
     unordered_set<id_type> visited;
@@ -588,29 +1378,13 @@ void CDLib::get_all_paths(const graph& g, id_type source, id_type dest, vector<i
 //            return 0;
 //}
 
-double efficiency_undirected_unweighted(const graph& g) {
+template <typename G>
+double efficiency_unweighted(const G& g) {
     if (g.get_num_nodes() > 1) {
+        vector<id_type> reach;
+        vector<double> distance_sum;
         double efficiency = 0;
-#ifdef ENABLE_MULTITHREADING
-#pragma omp parallel for schedule(dynamic,20) shared(g) reduction(+:efficiency)
-#endif
-        for (id_type i = 0; i < g.get_num_nodes(); i++) {
-            vector<double> distances(g.get_num_nodes(), numeric_limits<double>::infinity());
-            queue<id_type> q_bfs;
-            q_bfs.push(i);
-            distances[i] = 0;
-            while (!q_bfs.empty()) {
-                id_type current = q_bfs.front();
-                q_bfs.pop();
-                for (adjacent_edges_iterator aeit = g.out_edges_begin(current); aeit != g.out_edges_end(current); aeit++) {
-                    if (distances[aeit->first] == numeric_limits<double>::infinity()) {
-                        distances[aeit->first] = distances[current] + 1;
-                        q_bfs.push(aeit->first);
-                        efficiency += (1 / distances[aeit->first]);
-                    }
-                }
-            }
-        }
+        hop_distance_statistics(g, reach, distance_sum, efficiency);
         efficiency /= g.get_num_nodes() * (g.get_num_nodes() - 1);
         return efficiency;
     } else if (g.get_num_nodes() == 1)
@@ -619,40 +1393,20 @@ double efficiency_undirected_unweighted(const graph& g) {
         return 0;
 }
 
-double CDLib::efficiency_sw_global(const graph& g) {
+template <typename G>
+double CDLib::efficiency_sw_global(const G& g) {
     /* Returning Global Efficiency of a Small World Network according to 2001 paper
      *  function in this library. The chunk size of dynamic scheduling in OpenMP is set to 10. */
-    if (!g.is_directed() && !g.is_weighted()) {
-        return efficiency_undirected_unweighted(g);
+    if (!g.is_weighted()) {
+        return efficiency_unweighted(g);
     } else {
         if (g.get_num_nodes() > 1) {
-            const id_type control = 70000; // This controls the memory requirement. 70000 x 70000 x 8 = 36.51GB
             double efficiency = 0;
             double ideal = 1 / g.minimum_weight();
-            if (g.get_num_nodes() < control) {
-                vector< vector<double> > path_matrix;
-                all_pairs_shortest_paths(g, path_matrix);
-#ifdef ENABLE_MULTITHREADING
-#pragma omp parallel for schedule(dynamic,20) shared(g,path_matrix) reduction(+:efficiency)
-#endif
-                for (unsigned long i = 0; i < g.get_num_nodes(); i++) {
-                    for (unsigned long j = 0; j < g.get_num_nodes(); j++)
-                        if (i != j)
-                            efficiency = efficiency + (1 / path_matrix[i][j]);
-                }
-            } else {
-#ifdef ENABLE_MULTITHREADING
-#pragma omp parallel for schedule(dynamic,20) shared(g) reduction(+:efficiency)
-#endif
-                for (unsigned long i = 0; i < g.get_num_nodes(); i++) {
-                    vector< vector<id_type> > preds;
-                    vector<double> distance;
-                    single_source_shortest_paths_djikstra(g, i, distance, preds);
-                    for (unsigned long j = 0; j < g.get_num_nodes(); j++)
-                        if (i != j)
-                            efficiency = efficiency + (1 / distance[j]);
-                }
-            }
+            harmonic_sum_reducer harmonic;
+            all_pairs_shortest_paths_reduce(g, harmonic);
+            for (id_type i = 0; i < g.get_num_nodes(); i++)
+                efficiency += harmonic.get_sums()[i];
 
             //        cout << "\nIdeal :" << ideal << "\tEfficiency :" << efficiency << endl;
             efficiency = efficiency / (g.get_num_nodes() * (g.get_num_nodes() - 1));
@@ -665,39 +1419,43 @@ double CDLib::efficiency_sw_global(const graph& g) {
     }
 }
 
-double CDLib::characteristics_path_length(const graph& g) {
+template <typename G>
+double CDLib::characteristics_path_length(const G& g) {
     if (g.get_num_nodes() < 2)
         return 0;
     double average_path_length = 0;
-    vector< vector<double> > path_matrix;
-    all_pairs_shortest_paths(g, path_matrix);
-#ifdef ENABLE_MULTITHREADING
-#pragma omp parallel for shared(g,path_matrix) reduction(+:average_path_length)
-#endif
-    for (unsigned long i = 0; i < g.get_num_nodes(); i++) {
-        for (unsigned long j = 0; j < g.get_num_nodes(); j++)
-            average_path_length += path_matrix[i][j];
+    if (!g.is_weighted()) {
+        //    An unreachable pair makes the average infinite, as with the path matrix.
+        vector<id_type> reach;
+        vector<double> distance_sum;
+        double inverse_distance_sum;
+        hop_distance_statistics(g, reach, distance_sum, inverse_distance_sum);
+        id_type pairs = 0;
+        for (id_type i = 0; i < g.get_num_nodes(); i++) {
+            pairs += reach[i];
+            average_path_length += distance_sum[i];
+        }
+        if (pairs < g.get_num_nodes() * (g.get_num_nodes() - 1))
+            return numeric_limits<double>::infinity();
+        return average_path_length / (g.get_num_nodes() * (g.get_num_nodes() - 1));
     }
+    distance_sum_reducer distance_sum;
+    all_pairs_shortest_paths_reduce(g, distance_sum);
+    for (id_type i = 0; i < g.get_num_nodes(); i++)
+        average_path_length += distance_sum.get_sums()[i];
     average_path_length /= g.get_num_nodes() * (g.get_num_nodes() - 1);
     return average_path_length;
 }
 
-double CDLib::path_entropy(const graph& g) {
+template <typename G>
+double CDLib::path_entropy(const G& g) {
     // Centrality Entropy of the Graph based on shortest path connectivity, as in Borgatti paper
     double entropy = 0;
-    vector<id_type> each_source(g.get_num_nodes(), 0);
-    id_type all_sources = 0;
-    for (id_type i = 0; i < g.get_num_nodes(); i++) {
-        vector<double> distances;
-        vector< vector<id_type> > preds;
-        single_source_shortest_paths_bfs(g, i, distances, preds);
-        for (id_type j = 0; j < g.get_num_nodes(); j++) {
-            if ((j != i) && (distances[j] != numeric_limits<double>::infinity()) && (distances[j] != 0)) {
-                each_source[i]++;
-                all_sources++;
-            }
-        }
-    }
+    vector<id_type> each_source;
+    vector<double> distance_sum;
+    double inverse_distance_sum;
+    hop_distance_statistics(g, each_source, distance_sum, inverse_distance_sum);
+    id_type all_sources = accumulate(each_source.begin(), each_source.end(), (id_type) 0);
     if (all_sources > 0) {
         for (id_type i = 0; i < g.get_num_nodes(); i++) {
             double prob = (double) each_source[i] / all_sources;
@@ -710,20 +1468,125 @@ double CDLib::path_entropy(const graph& g) {
     return entropy;
 }
 
-id_type CDLib::hop_distance_matrix(const graph& g, vector< vector<id_type> > & path_matrix) {
+template <typename G>
+id_type CDLib::hop_distance_matrix(const G& g, vector< vector<id_type> > & path_matrix) {
     id_type max_dist = 0;
     path_matrix.assign(g.get_num_nodes(), vector<id_type > (g.get_num_nodes(), numeric_limits<id_type>::max()));
-    for (id_type i = 0; i < g.get_num_nodes(); i++) {
-        path_matrix[i][i] = 0;
-        vector<double> dist;
-        vector< vector<id_type> > preds;
-        single_source_shortest_paths_bfs(g, i, dist, preds);
-        for (id_type j = 0; j < dist.size(); j++) {
-            path_matrix[i][j] = dist[j];
-            if (dist[j] > max_dist) max_dist = dist[j];
+    id_type num_batches = (g.get_num_nodes() + bfs_word_bits - 1) / bfs_word_bits;
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel shared(g,path_matrix)
+#endif
+    {
+        multi_source_bfs<G> ms_bfs(g);
+        id_type local_max = 0;
+#ifdef ENABLE_MULTITHREADING
+#pragma omp for schedule(dynamic,1)
+#endif
+        for (id_type b = 0; b < num_batches; b++) {
+            id_type first = b * bfs_word_bits, batch = ms_bfs.start(first);
+            for (id_type i = first; i < first + batch; i++) path_matrix[i][i] = 0;
+            while (ms_bfs.advance()) {
+                const vector<id_type>& found = ms_bfs.get_discovered();
+                for (id_type i = 0; i < found.size(); i++) {
+                    for (unsigned long mask = ms_bfs.get_mask(found[i]); mask; mask &= mask - 1)
+                        path_matrix[first + __builtin_ctzl(mask)][found[i]] = ms_bfs.get_level();
+                }
+                if (ms_bfs.get_level() > local_max) local_max = ms_bfs.get_level();
+            }
+        }
+#ifdef ENABLE_MULTITHREADING
+#pragma omp critical(hop_distance_max)
+#endif
+        if (local_max > max_dist) max_dist = local_max;
+    }
+    return max_dist;
+}
+
+template <typename G>
+id_type CDLib::hop_distance_statistics(const G& g, vector<id_type>& reach, vector<double>& distance_sum, double& inverse_distance_sum) {
+    //    Batches of sources are independent, so each thread runs its own kernel and the
+    //    per-source sums need no synchronization.
+    reach.assign(g.get_num_nodes(), 0);
+    distance_sum.assign(g.get_num_nodes(), 0);
+    double inverse_sum = 0;
+    id_type max_dist = 0;
+    id_type num_batches = (g.get_num_nodes() + bfs_word_bits - 1) / bfs_word_bits;
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel shared(g,reach,distance_sum)
+#endif
+    {
+        multi_source_bfs<G> ms_bfs(g);
+        id_type local_max = 0;
+#ifdef ENABLE_MULTITHREADING
+#pragma omp for schedule(dynamic,1) reduction(+:inverse_sum)
+#endif
+        for (id_type b = 0; b < num_batches; b++) {
+            id_type first = b * bfs_word_bits;
+            ms_bfs.start(first);
+            while (ms_bfs.advance()) {
+                double distance = ms_bfs.get_level();
+                const vector<id_type>& found = ms_bfs.get_discovered();
+                for (id_type i = 0; i < found.size(); i++) {
+                    unsigned long mask = ms_bfs.get_mask(found[i]);
+                    inverse_sum += __builtin_popcountl(mask) / distance;
+                    for (; mask; mask &= mask - 1) {
+                        id_type source = first + __builtin_ctzl(mask);
+                        reach[source]++;
+                        distance_sum[source] += distance;
+                    }
+                }
+                if (ms_bfs.get_level() > local_max) local_max = ms_bfs.get_level();
+            }
         }
+#ifdef ENABLE_MULTITHREADING
+#pragma omp critical(hop_distance_max)
+#endif
+        if (local_max > max_dist) max_dist = local_max;
     }
+    inverse_distance_sum = inverse_sum;
     return max_dist;
 }
 
+#define PATHS_AND_COMPONENTS_INSTANTIATE(G) \
+    template class CDLib::bfs_engine<G>; \
+    template class CDLib::multi_source_bfs<G>; \
+    template class CDLib::dijkstra_engine<G>; \
+    template void CDLib::dfs_visitor<G>(const G&, node_set&, id_type); \
+    template void CDLib::bfs_visitor<G>(const G&, node_set&, id_type); \
+    template bool CDLib::is_path_present<G>(const G&, id_type, id_type); \
+    template id_type CDLib::get_connected_component_labels<G>(const G&, vector<id_type>&); \
+    template id_type CDLib::get_strongly_connected_component_labels<G>(const G&, vector<id_type>&); \
+    template id_type CDLib::get_component_around_node_undirected<G>(const G&, id_type, node_set&); \
+    template id_type CDLib::get_component_around_node_weak<G>(const G&, id_type, node_set&); \
+    template id_type CDLib::get_component_around_node_strong<G>(const G&, id_type, node_set&); \
+    template bool CDLib::is_connected_undirected<G>(const G&); \
+    template bool CDLib::is_connected_weakly<G>(const G&); \
+    template bool CDLib::is_connected_strongly<G>(const G&); \
+    template id_type CDLib::get_connected_components_undirected<G>(const G&, vector<node_set>&); \
+    template id_type CDLib::get_weakly_connected_components<G>(const G&, vector<node_set>&); \
+    template id_type CDLib::get_strongly_connected_components<G>(const G&, vector<node_set>&); \
+    template id_type CDLib::get_largest_connected_component<G>(const G&, node_set&); \
+    template double CDLib::fraction_of_nodes_in_LCC<G>(const G&); \
+    template bool CDLib::has_negative_edge_weights<G>(const G&); \
+    template bool CDLib::has_integer_edge_weights<G>(const G&, id_type&); \
+    template double CDLib::single_source_shortest_paths_bfs<G>(const G&, id_type, vector<double>&, vector< vector<id_type> >&); \
+    template double CDLib::single_source_shortest_paths_djikstra<G>(const G&, id_type, vector<double>&, vector< vector<id_type> >&); \
+    template double CDLib::single_source_shortest_paths_delta_stepping<G>(const G&, id_type, double, vector<double>&); \
+    template double CDLib::single_source_shortest_paths_delta_stepping<G>(const G&, id_type, double, vector<double>&, vector< vector<id_type> >&, vector<double>&); \
+    template double CDLib::diameter<G>(const G&); \
+    template void CDLib::all_pairs_shortest_paths<G>(const G&, vector< vector<double> >&); \
+    template void CDLib::all_pairs_shortest_paths_reduce<G>(const G&, distance_row_reducer&); \
+    template void CDLib::all_pairs_shortest_paths_djikshtra<G>(const G&, vector< vector<double> >&); \
+    template void CDLib::all_pairs_shortest_paths_floyd_warshal<G>(const G&, vector< vector<double> >&); \
+    template bool CDLib::all_pairs_shortest_paths_floyd_warshal<G>(const G&, vector<float>&); \
+    template bool CDLib::all_pairs_shortest_paths_floyd_warshal<G>(const G&, vector<unsigned short>&); \
+    template void CDLib::single_source_shortest_paths_djikstra_with_paths<G>(const G&, id_type, vector<double>&, vector< vector<id_type> >&); \
+    template bool CDLib::get_topological_ordering<G>(const G&, vector<id_type>&); \
+    template void CDLib::get_all_paths<G>(const G&, id_type, id_type, vector<id_type>&); \
+    template double CDLib::efficiency_sw_global<G>(const G&); \
+    template double CDLib::characteristics_path_length<G>(const G&); \
+    template double CDLib::path_entropy<G>(const G&); \
+    template id_type CDLib::hop_distance_matrix<G>(const G&, vector< vector<id_type> >&); \
+    template id_type CDLib::hop_distance_statistics<G>(const G&, vector<id_type>&, vector<double>&, double&);
 
+CDLIB_FOR_EACH_GRAPH_BACKEND(PATHS_AND_COMPONENTS_INSTANTIATE)
@@ -14,48 +14,249 @@
 using namespace std;
 
 namespace CDLib {
-    void dfs_visitor(const graph& g, node_set& visited, id_type source);
-    void bfs_visitor(const graph& g, node_set& visited, id_type source);
-
-    bool is_path_present(const graph& g, id_type source, id_type dest);
-
-    id_type get_component_around_node_undirected(const graph& g, id_type id, node_set& visited);
-    id_type get_component_around_node_weak(const graph&g, id_type id, node_set& visited);
-    id_type get_component_around_node_strong(const graph& g, id_type id, node_set& visited);
-
-    bool is_connected_undirected(const graph& g);
-    bool is_connected_weakly(const graph& g);
-    bool is_connected_strongly(const graph& g);
-
-    id_type get_connected_components_undirected(const graph& g, vector<node_set>& components);
-    id_type get_weakly_connected_components(const graph& g, vector<node_set>& components);
-    id_type get_strongly_connected_components(const graph& g, vector<node_set>& components);
-    id_type get_largest_connected_component(const graph& g, node_set &members);
-    double fraction_of_nodes_in_LCC(const graph& g);
-
-    bool has_negative_edge_weights(const graph& g);
-
-    double single_source_shortest_paths_bfs(const graph& g, id_type source, vector<double>& distances, vector< vector<id_type> >& preds);
-    double single_source_shortest_paths_djikstra(const graph&g, id_type source, vector<double>& distances, vector< vector<id_type> >& preds);
-    double diameter(const graph& g);
-    void all_pairs_shortest_paths(const graph& g, vector< vector<double> >& path_matrix);
-    void all_pairs_shortest_paths_djikshtra(const graph& g, vector< vector<double> >& path_matrix);
-    //    Floyd Warshal should be used only when space is not a constraint.
-    void all_pairs_shortest_paths_floyd_warshal(const graph& g, vector< vector<double> >& path_matrix);
-    void single_source_shortest_paths_djikstra_with_paths(const graph&g, id_type source, vector<double>& distances, vector< vector<id_type> >& paths);
-    bool get_topological_ordering(const graph& g, vector<id_type>& ordering);
-
-    void get_all_paths(const graph& g, id_type source, id_type dest, vector<id_type>& paths);
+    //    The read-only routines below are templated over the graph backend. They are
+    //    instantiated in paths_and_components.cpp for each CDLIB_FOR_EACH_GRAPH_BACKEND entry.
+    template <typename G>
+    class bfs_engine {
+        //    Level synchronous BFS shared by the traversal routines of the library. The
+        //    workspace (levels, visited bitmap, frontiers) is sized once per graph and only
+        //    the entries reached by the last run are reset, so one engine can serve many
+        //    sources. Each level is expanded top-down from the frontier, or bottom-up by
+        //    letting every unvisited node look for a parent in the frontier once the
+        //    frontier touches a large share of the remaining edges (Beamer et al., 2012).
+        //    With parallel set, large levels are expanded by the OpenMP threads unless the
+        //    engine is already running inside a parallel region.
+    private:
+        const G& g;
+        bool parallel;
+        vector<id_type> levels;
+        vector<unsigned long> visited;
+        vector<unsigned long> frontier_bits;
+        vector<unsigned long> next_bits;
+        vector<id_type> order;
+        vector<id_type> level_offsets;
+        id_type out_volume;
+        id_type in_volume;
+        void allocate();
+        bool use_threads(id_type work) const;
+        bool claim(id_type id, bool atomic);
+        void reset();
+        void start(id_type source);
+        bool close_level();
+        void expand_node(id_type curr, id_type next_level, bool weak, bool atomic, vector<id_type>& found);
+        void top_down_step(bool weak);
+        void bottom_up_step(bool weak);
+        id_type traverse(id_type source, bool weak, id_type max_level);
+    public:
+        static const id_type unreached;
+        bfs_engine(const G& graph_ref);
+        bfs_engine(const G& graph_ref, bool parallel_expansion);
+        //    Nodes reachable from source along out-edges, or along both directions of the
+        //    edges for run_weak. max_level stops the search after that many hops. Return
+        //    the number of nodes reached.
+        id_type run(id_type source);
+        id_type run(id_type source, id_type max_level);
+        id_type run_weak(id_type source);
+        //    Each out-edge of a newly reached node is followed with the given probability,
+        //    the independent cascade of the epidemic routines. Always top-down and serial.
+        id_type run_percolation(id_type source, double edge_probability);
+        bool is_visited(id_type id) const;
+        id_type get_level(id_type id) const;
+        id_type get_num_levels() const;
+        //    Reached nodes grouped by level; level k spans [offsets[k], offsets[k + 1]).
+        const vector<id_type>& get_order() const;
+        const vector<id_type>& get_level_offsets() const;
+    };
+
+    template <typename G>
+    class multi_source_bfs {
+        //    Bit-parallel BFS of Then et al. (MS-BFS, 2014) for unweighted graphs. A batch
+        //    of up to width sources advances together: every node keeps one bit per source
+        //    in its seen, visit and next words, so an edge is scanned once per level for the
+        //    whole batch instead of once per source. Callers step through the levels and
+        //    read, for each node first reached at the current level, the mask of sources
+        //    that reached it. Bit k of a mask stands for source first_source + k.
+    private:
+        const G& g;
+        vector<unsigned long> seen;
+        vector<unsigned long> visit;
+        vector<unsigned long> next;
+        vector<id_type> discovered;
+        vector<id_type> scratch;
+        id_type level;
+    public:
+        static const id_type width;
+        multi_source_bfs(const G& graph_ref);
+        //    Seeds the sources first_source, first_source + 1, ... and returns the batch size.
+        id_type start(id_type first_source);
+        //    Expands one level; returns false once no source reaches a new node.
+        bool advance();
+        id_type get_level() const;
+        const vector<id_type>& get_discovered() const;
+        unsigned long get_mask(id_type id) const;
+    };
+
+    template <typename G>
+    class dijkstra_engine {
+        //    Dijkstra's search for graphs with non-negative edge weights. Like bfs_engine it
+        //    is sized once per graph and only the entries reached by the last run are reset.
+        //    The priority queue is picked from the edge weights at construction: a
+        //    bucket_queue when all of them are integers of at most bucket_queue::max_span,
+        //    else a lazy_heap on sparse graphs, where keys rarely improve twice, and an
+        //    indexed_dary_heap on dense ones. Unweighted graphs are searched with unit lengths.
+    private:
+        const G& g;
+        vector<double> distances;
+        vector<id_type> order;
+        indexed_dary_heap heap;
+        lazy_heap sparse_heap;
+        bucket_queue buckets;
+        enum queue_choice { use_buckets, use_lazy_heap, use_indexed_heap } choice;
+        template <typename Q> void search(id_type source, Q& queue, vector<double>* path_counts);
+    public:
+        dijkstra_engine(const G& graph_ref);
+        //    Returns the number of nodes reached from source. The second form also counts
+        //    the shortest paths to every reached node into path_counts, which must be sized
+        //    to the graph and zero on entry; the caller resets the reached entries.
+        id_type run(id_type source);
+        id_type run(id_type source, vector<double>& path_counts);
+        double get_distance(id_type id) const;
+        //    Distances of the last run, infinite for the nodes it did not reach.
+        const vector<double>& get_distances() const;
+        //    Reached nodes in the order they were settled, i.e. by distance.
+        const vector<id_type>& get_order() const;
+    };
+
+    class distance_row_reducer {
+        //    Receives the shortest path distances from each source, as streamed by
+        //    all_pairs_shortest_paths_reduce. Rows of different sources may arrive at the same
+        //    time from several threads, and a row is only valid during the call. Unreachable
+        //    nodes have infinite distance.
+    public:
+        virtual ~distance_row_reducer() {
+        }
+        virtual void reset(id_type num_nodes) = 0;
+        virtual void reduce(id_type source, const vector<double>& distances) = 0;
+    };
+
+    class distance_sum_reducer : public distance_row_reducer {
+        //    Sum of the distances from each source, infinite when a node is unreachable.
+    private:
+        vector<double> sums;
+    public:
+        void reset(id_type num_nodes);
+        void reduce(id_type source, const vector<double>& distances);
+        const vector<double>& get_sums() const;
+    };
+
+    class harmonic_sum_reducer : public distance_row_reducer {
+        //    Sum of the inverse distances from each source to the other nodes.
+    private:
+        vector<double> sums;
+    public:
+        void reset(id_type num_nodes);
+        void reduce(id_type source, const vector<double>& distances);
+        const vector<double>& get_sums() const;
+    };
+
+    class eccentricity_reducer : public distance_row_reducer {
+        //    Largest finite distance from each source.
+    private:
+        vector<double> eccentricities;
+    public:
+        void reset(id_type num_nodes);
+        void reduce(id_type source, const vector<double>& distances);
+        const vector<double>& get_eccentricities() const;
+    };
+
+    class distance_histogram_reducer : public distance_row_reducer {
+        //    Number of ordered pairs of distinct nodes at each finite distance. Every thread
+        //    counts into its own map and get_histogram merges them.
+    private:
+        vector< map<double, id_type> > thread_counts;
+    public:
+        void reset(id_type num_nodes);
+        void reduce(id_type source, const vector<double>& distances);
+        void get_histogram(map<double, id_type>& histogram) const;
+    };
+
+    template <typename G> void dfs_visitor(const G& g, node_set& visited, id_type source);
+    template <typename G> void bfs_visitor(const G& g, node_set& visited, id_type source);
+
+    template <typename G> bool is_path_present(const G& g, id_type source, id_type dest);
+
+    template <typename G> id_type get_component_around_node_undirected(const G& g, id_type id, node_set& visited);
+    template <typename G> id_type get_component_around_node_weak(const G& g, id_type id, node_set& visited);
+    template <typename G> id_type get_component_around_node_strong(const G& g, id_type id, node_set& visited);
+
+    template <typename G> bool is_connected_undirected(const G& g);
+    template <typename G> bool is_connected_weakly(const G& g);
+    template <typename G> bool is_connected_strongly(const G& g);
+
+    //    Component of every node as a label array: labels[i] is the component of node i and
+    //    components are numbered 0, 1, ... in order of their smallest node. Connected
+    //    components follow the edges in both directions, so they are the weak components of
+    //    a directed graph; strong components of undirected graphs are the connected ones.
+    //    Return the number of components.
+    template <typename G> id_type get_connected_component_labels(const G& g, vector<id_type>& labels);
+    template <typename G> id_type get_strongly_connected_component_labels(const G& g, vector<id_type>& labels);
+
+    template <typename G> id_type get_connected_components_undirected(const G& g, vector<node_set>& components);
+    template <typename G> id_type get_weakly_connected_components(const G& g, vector<node_set>& components);
+    template <typename G> id_type get_strongly_connected_components(const G& g, vector<node_set>& components);
+    template <typename G> id_type get_largest_connected_component(const G& g, node_set &members);
+    template <typename G> double fraction_of_nodes_in_LCC(const G& g);
+
+    template <typename G> bool has_negative_edge_weights(const G& g);
+    //    True when every edge weight is a non-negative integer; max_weight receives the largest.
+    template <typename G> bool has_integer_edge_weights(const G& g, id_type& max_weight);
+
+    template <typename G> double single_source_shortest_paths_bfs(const G& g, id_type source, vector<double>& distances, vector< vector<id_type> >& preds);
+    template <typename G> double single_source_shortest_paths_djikstra(const G& g, id_type source, vector<double>& distances, vector< vector<id_type> >& preds);
+    //    Parallel delta-stepping (Meyer and Sanders): nodes wait in buckets of width delta and
+    //    each bucket is relaxed by all threads until it stays empty. A small delta does less
+    //    redundant work, a large one exposes more parallelism; delta <= 0 uses the mean edge
+    //    weight. The second form also returns the shortest path predecessors and the number
+    //    of shortest paths to each node. Returns the largest finite distance; graphs with
+    //    negative edge weights are rejected with 0, as in the Dijkstra version.
+    template <typename G> double single_source_shortest_paths_delta_stepping(const G& g, id_type source, double delta, vector<double>& distances);
+    template <typename G> double single_source_shortest_paths_delta_stepping(const G& g, id_type source, double delta, vector<double>& distances, vector< vector<id_type> >& preds, vector<double>& path_counts);
+    template <typename G> double diameter(const G& g);
+    template <typename G> void all_pairs_shortest_paths(const G& g, vector< vector<double> >& path_matrix);
+    //    Runs one single source search per source in parallel and hands each distance row to
+    //    the reducer instead of storing it, using O(n) memory per thread. Graphs with negative
+    //    edge weights fall back to the Floyd Warshal matrix.
+    template <typename G> void all_pairs_shortest_paths_reduce(const G& g, distance_row_reducer& reducer);
+    template <typename G> void all_pairs_shortest_paths_djikshtra(const G& g, vector< vector<double> >& path_matrix);
+    //    Floyd Warshal should be used only when space is not a constraint. The matrix is
+    //    relaxed in cache sized tiles, on floats or 16 bit integers when the edge weights
+    //    are integers small enough for the distances to stay exact.
+    template <typename G> void all_pairs_shortest_paths_floyd_warshal(const G& g, vector< vector<double> >& path_matrix);
+    //    Compact forms on one row-major matrix, where entry i * n + j is the distance from i
+    //    to j. They need non-negative integer edge weights and distances below 2^24 for
+    //    float, or below 32767 for unsigned short, where unreachable pairs read as
+    //    numeric_limits<unsigned short>::max(). Otherwise they return false and leave the
+    //    matrix empty.
+    template <typename G> bool all_pairs_shortest_paths_floyd_warshal(const G& g, vector<float>& path_matrix);
+    template <typename G> bool all_pairs_shortest_paths_floyd_warshal(const G& g, vector<unsigned short>& path_matrix);
+    template <typename G> void single_source_shortest_paths_djikstra_with_paths(const G& g, id_type source, vector<double>& distances, vector< vector<id_type> >& paths);
+    template <typename G> bool get_topological_ordering(const G& g, vector<id_type>& ordering);
+
+    template <typename G> void get_all_paths(const G& g, id_type source, id_type dest, vector<id_type>& paths);
     //    void all_path_lenth_Monte_Carlo(const graph& g, vector< vector<double> >& paths, long monte_c);
     //    double blocking_probability(id_type number_of_nodes, id_type degree, id_type visited);
     //    void alternate_path_length_destabilization(graph&g,id_type source,vector<double>& alternate_distances);
     //    double efficiency_sw_global_monte_carlo(graph& g);
     //    double efficiency_sw_global(const graph& g, bool type);
-    double efficiency_sw_global(const graph& g);
-    double characteristics_path_length(const graph& g);
+    template <typename G> double efficiency_sw_global(const G& g);
+    template <typename G> double characteristics_path_length(const G& g);
 
-    double path_entropy(const graph& g);
-    id_type hop_distance_matrix(const graph& g, vector< vector<id_type> > & path_mat);
+    template <typename G> double path_entropy(const G& g);
+    template <typename G> id_type hop_distance_matrix(const G& g, vector< vector<id_type> > & path_mat);
+    //    All-pairs hop statistics of an unweighted graph from the multi-source BFS: for every
+    //    source the number of other nodes it reaches and the sum of their hop distances, and
+    //    the sum of inverse distances over all reachable pairs. Returns the largest distance.
+    template <typename G> id_type hop_distance_statistics(const G& g, vector<id_type>& reach, vector<double>& distance_sum, double& inverse_distance_sum);
 };
 
 #endif	/* COMMUNITY_TOOLS_H */
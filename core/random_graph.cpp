@@ -22,9 +22,11 @@ void CDLib::generate_erdos_renyi_graph(graph& g, id_type num_nodes, double p) {
     if (p >= 0 && p <= 1) {
         init_empty_graph(g, num_nodes);
         RandomGenerator<double> p_gen(0, 1, 1);
+        vector<edge> edges;
         for (id_type i = 0; i < num_nodes; i++)
             for (id_type j = 0; j < num_nodes; j++)
-                if ((!g.is_directed() && i < j) && p_gen.next() <= p) g.add_edge(i, j, 1);
+                if ((!g.is_directed() && i < j) && p_gen.next() <= p) edges.push_back(edge(i, j, 1));
+        g.add_edges(edges);
         g.set_graph_name("er_" + T2str<id_type > (num_nodes) + "_" + T2str<double>(p));
     }
 }
@@ -41,11 +43,13 @@ void CDLib::generate_scale_free_graph(graph& g, id_type num_nodes, id_type num_e
     vector<id_type> outdegrees(num_nodes, 0.0);
     for (id_type i = 0; i < num_nodes; i++)
         outdegrees[i] = (id_type) x_gen.exp_next(alpha, beta);
+    vector<edge> edges;
     for (id_type i = 0; i < num_edges; i++) {
         id_type from_id = from_gen.next(), to_id = to_gen.next();
-        if (outdegrees[from_id] && outdegrees[to_id] && from_id != to_id && !g.get_edge_weight(from_id, to_id))
-            g.add_edge(from_id, to_id, 1);
+        if (outdegrees[from_id] && outdegrees[to_id] && from_id != to_id)
+            edges.push_back(edge(from_id, to_id, 1));
     }
+    g.add_edges(edges);
     g.set_graph_name("sf_" + T2str<id_type > (num_nodes) + "_" + T2str<id_type > (num_edges) + "_" + T2str<double>(alpha) + "_" + T2str<double>(beta));
 }
 
@@ -57,38 +61,46 @@ void CDLib::generate_planted_partition_graph(graph& g, id_type num_comms, id_typ
         Uniform01RandomGeneratorMT p_gen;
         for (id_type i = 0; i < num_nodes; i++)
             if (i % comm_size) communities[i / comm_size].insert(i);
+        vector<edge> edges;
         for (id_type i = 0; i < g.get_num_nodes(); i++) {
             id_type comm_id_i = i / comm_size;
             for (id_type j = 0; j < g.get_num_nodes(); j++) {
                 id_type comm_id_j = j / comm_size;
                 double p = p_gen.next();
-                if (comm_id_i == comm_id_j && p > pin) g.add_edge(i, j, 1);
-                else if (p > pout) g.add_edge(i, j, 1);
+                if (comm_id_i == comm_id_j && p > pin) edges.push_back(edge(i, j, 1));
+                else if (p > pout) edges.push_back(edge(i, j, 1));
             }
         }
+        g.add_edges(edges);
         g.set_graph_name("pp_" + T2str<id_type > (num_comms) + "_" + T2str<id_type > (comm_size) + "_" + T2str<double>(pin) + "_" + T2str<double>(pout));
     }
 }
 
 void CDLib::generate_ring_graph(graph& g, id_type size) {
     init_empty_graph(g, size);
+    vector<edge> edges;
     for (id_type i = 0; i < g.get_num_nodes(); i++)
-        g.add_edge(i, (i + 1) % size, 1);
+        edges.push_back(edge(i, (i + 1) % size, 1));
+    g.add_edges(edges);
     g.set_graph_name("ring_" + T2str<id_type > (size));
 }
 
 void CDLib::generate_star_graph(graph& g, id_type size) {
     init_empty_graph(g, size);
+    vector<edge> edges;
     for (id_type i = 1; i < g.get_num_nodes(); i++)
-        g.add_edge(0, i, 1);
+        edges.push_back(edge(0, i, 1));
+    g.add_edges(edges);
     g.set_graph_name("star_" + T2str<id_type > (size));
 }
 
 void CDLib::generate_clique_graph(graph& g, id_type size) {
     init_empty_graph(g, size);
+    vector<edge> edges;
     for (id_type i = 0; i < g.get_num_nodes(); i++)
         for (id_type j = 0; j < i; j++)
-            if (i != j) g.add_edge(i, j, 1);
+            if (i != j) edges.push_back(edge(i, j, 1));
+    g.add_edges(edges);
     g.set_graph_name("clique_" + T2str<id_type > (size));
 }
 
@@ -96,9 +108,11 @@ void CDLib::generate_spoke_graph(graph& g, id_type size) {
     generate_star_graph(g, size);
     id_type last_id = g.get_num_nodes() - 1;
     if (last_id > 1) {
+        vector<edge> edges;
         for (id_type i = 1; i < last_id; i++)
-            g.add_edge(i, (i + 1), 1);
-        g.add_edge(last_id, 1, 1);
+            edges.push_back(edge(i, (i + 1), 1));
+        edges.push_back(edge(last_id, 1, 1));
+        g.add_edges(edges);
     }
     g.set_graph_name("spoke_" + T2str<id_type > (size));
 }
@@ -107,21 +121,25 @@ void CDLib::generate_de_bruijn_graph(graph& g, id_type num_symbols, id_type sequ
     if (num_symbols && sequence_length) {
         id_type size = (unsigned long) pow((double) num_symbols, (double) sequence_length);
         init_empty_graph(g, size);
+        vector<edge> edges;
         for (id_type i = 0; i < g.get_num_nodes(); i++) {
             id_type basis = (i * num_symbols) % g.get_num_nodes();
-            for (id_type j = 0; j < num_symbols; j++) g.add_edge(i, basis + j, 1);
+            for (id_type j = 0; j < num_symbols; j++) edges.push_back(edge(i, basis + j, 1));
         }
+        g.add_edges(edges);
         g.set_graph_name("db_" + T2str<id_type > (num_symbols) + "_" + T2str<id_type > (sequence_length));
     }
 }
 
 void CDLib::generate_chord_graph(graph& g, id_type num_nodes) {
     init_empty_graph(g, num_nodes);
+    vector<edge> edges;
     for (id_type i = 0; i < g.get_num_nodes(); i++) {
-        g.add_edge(i, (i - 1) % g.get_num_nodes(), 1);
+        edges.push_back(edge(i, (i - 1) % g.get_num_nodes(), 1));
         for (id_type j = 1; j <= g.get_num_nodes() / 2; j *= 2)
-            g.add_edge(i, (i + j) % g.get_num_nodes(), 1);
+            edges.push_back(edge(i, (i + j) % g.get_num_nodes(), 1));
     }
+    g.add_edges(edges);
     g.set_graph_name("chord_" + T2str<id_type > (num_nodes));
 }
 
@@ -138,20 +156,22 @@ void CDLib::generate_LEET_chord_graph(graph& g, id_type num_nodes) {
     init_empty_graph(g, num_nodes);
     id_type num_clusters = num_nodes / log2(num_nodes);
     id_type num_nodes_per_cluster = static_cast<id_type> (log2(num_nodes));
+    vector<edge> edges;
     for (id_type i = 0; i < num_clusters; i++) {
         id_type start_id = i*num_nodes_per_cluster;
         //Adding the individual Clusters
         for (id_type j = 0; j < num_nodes_per_cluster; j++) {
-            g.add_edge(start_id + j, start_id + ((j - 1) % num_nodes_per_cluster), 1);
+            edges.push_back(edge(start_id + j, start_id + ((j - 1) % num_nodes_per_cluster), 1));
             for (id_type k = 1; k <= num_nodes_per_cluster / 2; k *= 2)
-                g.add_edge(start_id + j, start_id + ((j + k) % num_nodes_per_cluster), 1);
+                edges.push_back(edge(start_id + j, start_id + ((j + k) % num_nodes_per_cluster), 1));
         }
         //Adding the long range links
         for (id_type j = log2(num_clusters) - 1, k = 0; j > 0; j--, k++) {
             id_type next_cluster_id = ((i + j) % num_clusters) * num_nodes_per_cluster;
-            g.add_edge(start_id + (k % num_nodes_per_cluster), next_cluster_id + (j % num_nodes_per_cluster), 1);
+            edges.push_back(edge(start_id + (k % num_nodes_per_cluster), next_cluster_id + (j % num_nodes_per_cluster), 1));
         }
     }
+    g.add_edges(edges);
     g.set_graph_name("leet_chord_" + T2str<id_type > (num_nodes));
     g.remove_isolates();
 }
@@ -163,9 +183,11 @@ bool cmp(const vector<id_type>& lhs, const vector<id_type>& rhs) {
 void CDLib::generate_kademlia_graph(graph& g, id_type num_nodes) {
     init_empty_graph(g, num_nodes);
     unsigned int num_bits = log2(num_nodes);
+    vector<edge> edges;
     for (unsigned int i = 0; i < num_nodes; i++)
         for (unsigned int j = 0; j < num_bits; j++)
-            g.add_edge(i, (i ^ ((1 << j))) % num_nodes, 1);
+            edges.push_back(edge(i, (i ^ ((1 << j))) % num_nodes, 1));
+    g.add_edges(edges);
     g.set_graph_name("kademlia_" + T2str<id_type > (num_nodes));
 }
 
@@ -280,6 +302,7 @@ void CDLib::generate_configuration_model(graph& g, vector<id_type>& degree_seque
         }
 
         UniformRandomGeneratorAkash<id_type> rand;
+        vector<edge> edges;
         for (id_type i = 0; i < degree_sequence.size(); i++) {
             id_type remaining_degree = degree_sequence[i];
             for (id_type j = 0; j < remaining_degree; j++) {
@@ -288,7 +311,7 @@ back:
                 if (degree_sequence[i] == 1 && i == nodes_with_non_0_degree[R])
                     goto back;
 
-                g.add_edge(i, nodes_with_non_0_degree[R], 1);
+                edges.push_back(edge(i, nodes_with_non_0_degree[R], 1));
 
                 degree_sequence[i]--;
                 degree_sequence[nodes_with_non_0_degree[R]]--;
@@ -305,6 +328,7 @@ back:
                 nodes_with_non_0_degree.erase(nodes_with_non_0_degree.begin());
             }
         }
+        g.add_edges(edges);
         g.set_graph_name("configuration_model");
     }
 }
@@ -427,12 +451,13 @@ bool CDLib::generate_small_world_model(graph& g, size_t num_nodes, size_t degree
 
         init_empty_graph(g, num_nodes);
 
+        vector<edge> edges;
         for (id_type i = 0; i < num_nodes; i++) {
             for (id_type j = 0; j < degree_of_each_vertex / 2; j++) {
-                g.add_edge(i, (i + j + 1) % num_nodes, 1);
+                edges.push_back(edge(i, (i + j + 1) % num_nodes, 1));
             }
             if (degree_of_each_vertex % 2 == 1) {
-                g.add_edge(i, (i + (degree_of_each_vertex / 2) + 1) % num_nodes, 1);
+                edges.push_back(edge(i, (i + (degree_of_each_vertex / 2) + 1) % num_nodes, 1));
             }
         }
         for (id_type i = 0; i < num_nodes; i++) {
@@ -444,11 +469,12 @@ back:
                     if (R2 == i)
                         goto back;
                     else {
-                        g.add_edge(i, R2, 1);
+                        edges.push_back(edge(i, R2, 1));
                     }
                 }
             }
         }
+        g.add_edges(edges);
         g.set_graph_name("sw_" + T2str<size_t > (num_nodes) + "_" + T2str<size_t > (degree_of_each_vertex) + "_" + T2str<double>(probability_to_replace_edge));
         return 1;
     } else {
@@ -728,10 +754,10 @@ id_type CDLib::rewire_with_degree_distribution(graph& g, id_type degree_lower, i
                 other_end2 = aeit->first;
                 if ((g.get_edge_weight(other_end1, other_end2) == 0) && (other_end1 != other_end2)) {
                     if (type != 0) {
-                        double diff1 = 1 / (1 + abs(g.get_node_out_degree(change1) - g.get_node_out_degree(other_end1)));
-                        double c_diff1 = 1 / (1 + abs(g.get_node_out_degree(change1) - g.get_node_out_degree(change2)));
-                        double diff2 = 1 / (1 + abs(g.get_node_out_degree(change2) - g.get_node_out_degree(other_end2)));
-                        double c_diff2 = 1 / (1 + abs(g.get_node_out_degree(other_end1) - g.get_node_out_degree(other_end2)));
+                        double diff1 = 1 / (1 + fabs((double) g.get_node_out_degree(change1) - (double) g.get_node_out_degree(other_end1)));
+                        double c_diff1 = 1 / (1 + fabs((double) g.get_node_out_degree(change1) - (double) g.get_node_out_degree(change2)));
+                        double diff2 = 1 / (1 + fabs((double) g.get_node_out_degree(change2) - (double) g.get_node_out_degree(other_end2)));
+                        double c_diff2 = 1 / (1 + fabs((double) g.get_node_out_degree(other_end1) - (double) g.get_node_out_degree(other_end2)));
                         double change = (c_diff1 - diff1) + (c_diff2 - diff2);
                         if ((type < 0) && (change < 0))
                             accept = true;
@@ -790,10 +816,10 @@ id_type CDLib::improved_rewire_with_degree_distribution(graph& g, id_type degree
                 other_end2 = aeit->first;
                 if ((g.get_edge_weight(other_end1, other_end2) == 0) && (other_end1 != other_end2)) {
                     if (type != 0) {
-                        double diff1 = 1 / (1 + abs(g.get_node_out_degree(change1) - g.get_node_out_degree(other_end1)));
-                        double c_diff1 = 1 / (1 + abs(g.get_node_out_degree(change1) - g.get_node_out_degree(change2)));
-                        double diff2 = 1 / (1 + abs(g.get_node_out_degree(change2) - g.get_node_out_degree(other_end2)));
-                        double c_diff2 = 1 / (1 + abs(g.get_node_out_degree(other_end1) - g.get_node_out_degree(other_end2)));
+                        double diff1 = 1 / (1 + fabs((double) g.get_node_out_degree(change1) - (double) g.get_node_out_degree(other_end1)));
+                        double c_diff1 = 1 / (1 + fabs((double) g.get_node_out_degree(change1) - (double) g.get_node_out_degree(change2)));
+                        double diff2 = 1 / (1 + fabs((double) g.get_node_out_degree(change2) - (double) g.get_node_out_degree(other_end2)));
+                        double c_diff2 = 1 / (1 + fabs((double) g.get_node_out_degree(other_end1) - (double) g.get_node_out_degree(other_end2)));
                         double change = (c_diff1 - diff1) + (c_diff2 - diff2);
                         if ((type < 0) && (change < 0))
                             accept = true;
@@ -1036,8 +1062,8 @@ id_type CDLib::random_rewire(graph& g, id_type degree_lower, id_type degree_high
                 present_other_end = aeit->first;
                 if ((present != present_other_end) && (g.get_node_out_degree(present_other_end) >= degree_lower) && (g.get_node_out_degree(present_other_end) <= degree_higher)) {
                     if (type != 0) {
-                        double p_diff = 1 / (1 + abs(g.get_node_out_degree(present) - g.get_node_out_degree(present_other_end)));
-                        double c_diff = 1 / (1 + abs(g.get_node_out_degree(change) - g.get_node_out_degree(change_other_end)));
+                        double p_diff = 1 / (1 + fabs((double) g.get_node_out_degree(present) - (double) g.get_node_out_degree(present_other_end)));
+                        double c_diff = 1 / (1 + fabs((double) g.get_node_out_degree(change) - (double) g.get_node_out_degree(change_other_end)));
                         double change = c_diff - p_diff;
                         if ((type < 0) && (change < 0))
                             accept = true;
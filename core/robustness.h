@@ -10,6 +10,7 @@
 
 #include "typedefs.h"
 #include "statistics.h"
+#include "centrality.h"
 
 namespace CDLib {
 
@@ -74,71 +75,49 @@ namespace CDLib {
 
         inline void evaluations(const graph & g) {
             /* The code works properly only for undirected graph. */
-            vector<double> reachability_distt(g.get_num_nodes(), 0);
-            vector<double> total_distance(g.get_num_nodes(), 0.0);
+            vector<double> reachability_distt;
+            vector<double> total_distance;
             vector<double> degree_distt(g.get_num_nodes(), 0);
             id_type all_sources = 0, number_of_isolates = 0;
             double loc_eff = 0, loc_cc = 0, loc_reg = 0;
             double excess_mean = 0, excess_variance = 0, loc_ass = 0, max_degree = 0, deg_mean = 0;
-            vector<bool> has_node_visited(g.get_num_nodes(), 0);
-            vector<node_set> components;
+            vector<id_type> component_labels;
             vector<double>avg_nei_deg(g.get_num_nodes(), 0);
+            vector<double> node_cc;
             double normalization = g.get_num_nodes() * (g.get_num_nodes() - 1);
             double norm_edges = 2 * g.get_num_edges();
-            #ifdef ENABLE_MULTITHREADING
-#pragma omp parallel for shared(g,total_distance,reachability_distt,has_node_visited,components,avg_nei_deg,degree_distt) reduction(+:all_sources,loc_eff,loc_cc, loc_reg, excess_mean, excess_variance,number_of_isolates,deg_mean)
+            /* The all-pairs BFS part, 64 sources at a time. */
+            vector<id_type> reach;
+            hop_distance_statistics(g, reach, total_distance, loc_eff);
+            reachability_distt.assign(reach.begin(), reach.end());
+            all_sources = accumulate(reach.begin(), reach.end(), (id_type) 0);
+            node_clustering_coefficient(g, node_cc);
+#ifdef ENABLE_MULTITHREADING
+#pragma omp parallel for shared(g,avg_nei_deg) reduction(+:loc_cc, loc_reg, number_of_isolates, deg_mean)
 #endif
             for (id_type i = 0; i < g.get_num_nodes(); i++) {
                 deg_mean += g.get_node_out_degree(i);
                 if (!g.get_node_out_degree(i))
                     number_of_isolates++;
-                /* This is the BFS part from each node. */
-                node_set current_comm;
-                current_comm.insert(i);
-                vector<double> distances(g.get_num_nodes(), numeric_limits<double>::infinity());
-                queue<id_type> q_bfs;
-                q_bfs.push(i);
-                distances[i] = 0;
-                while (!q_bfs.empty()) {
-                    id_type current = q_bfs.front();
-                    q_bfs.pop();
-                    for (adjacent_edges_iterator aeit = g.out_edges_begin(current); aeit != g.out_edges_end(current); aeit++) {
-                        if (distances[aeit->first] == numeric_limits<double>::infinity() && current != aeit->first) {
-                            distances[aeit->first] = distances[current] + 1;
-                            q_bfs.push(aeit->first);
-                            loc_eff += (1 / distances[aeit->first]);
-                            total_distance[i] += distances[aeit->first];
-                            reachability_distt[i]++;
-                            all_sources++;
-                            current_comm.insert(aeit->first);
-                            /* This will iterate over all edges. */
-                            if (distances[aeit->first] == 1) {
-                                loc_reg += 1 / (1 + abs(g.get_node_out_degree(i) - g.get_node_in_degree(aeit->first)));
-                                avg_nei_deg[i] += g.get_node_in_degree(aeit->first);
-                            }
-                        }
+                /* The nodes at distance 1 are the neighbours other than the node itself. */
+                for (adjacent_edges_iterator aeit = g.out_edges_begin(i); aeit != g.out_edges_end(i); aeit++) {
+                    if (aeit->first != i) {
+                        loc_reg += 1 / (1 + fabs((double) g.get_node_out_degree(i) - (double) g.get_node_in_degree(aeit->first)));
+                        avg_nei_deg[i] += g.get_node_in_degree(aeit->first);
                     }
                 }
-                /* The BFS part from each node ends here. */
-                loc_cc += node_clustering_coefficient(g, i);
+                loc_cc += node_cc[i];
                 if (g.get_node_out_degree(i) > 0)
                     avg_nei_deg[i] = (avg_nei_deg[i] / g.get_node_out_degree(i)) - 1;
-                #ifdef ENABLE_MULTITHREADING
-#pragma omp critical
-#endif
-                {
-                    max_degree = (max_degree < g.get_node_out_degree(i)) ? g.get_node_out_degree(i) : max_degree;
-                    degree_distt[g.get_node_out_degree(i)]++;
-                    if (!has_node_visited[i]) {
-                        components.push_back(current_comm);
-                        has_node_visited[i] = true;
-                        for (node_set::iterator it = current_comm.begin(); it != current_comm.end(); it++) {
-                            has_node_visited[*it] = true;
-                        }
-                    }
-                }
-
             }
+            for (id_type i = 0; i < g.get_num_nodes(); i++) {
+                max_degree = (max_degree < g.get_node_out_degree(i)) ? g.get_node_out_degree(i) : max_degree;
+                degree_distt[g.get_node_out_degree(i)]++;
+            }
+            /* Component sizes from the union-find labels. */
+            vector<id_type> component_sizes(get_connected_component_labels(g, component_labels), 0);
+            for (id_type i = 0; i < g.get_num_nodes(); i++)
+                component_sizes[component_labels[i]]++;
             /* Getting degree distribution and excess degree details */
             degree_distt.resize(max_degree + 1);
             if (degree_distt.size())
@@ -158,11 +137,11 @@ namespace CDLib {
                     if (reach_entropy != 0) {
                         path_entropy -= reach_entropy * (log(reach_entropy) / log(2));
                     }
-                    if (i < components.size()) {
-                        if (components[i].size() >= lcc) {
-                            if (components[i].size() > lcc) {
+                    if (i < component_sizes.size()) {
+                        if (component_sizes[i] >= lcc) {
+                            if (component_sizes[i] > lcc) {
                                 index_max.clear();
-                                lcc = components[i].size();
+                                lcc = component_sizes[i];
                                 index_max.push_back(i);
                             } else {
                                 index_max.push_back(i);
@@ -179,9 +158,9 @@ namespace CDLib {
                 }
                 connectivity_entropy *= -1;
                 /* Any measures for LCC can be calculated in the below loop */
-                for (id_type i = 0; i < index_max.size(); i++) {
-                    for (node_set::iterator it = components[index_max[i]].begin(); it != components[index_max[i]].end(); it++) {
-                        avg_path_length_lcc += total_distance[*it];
+                for (id_type i = 0; i < g.get_num_nodes(); i++) {
+                    if (component_sizes[component_labels[i]] == lcc) {
+                        avg_path_length_lcc += total_distance[i];
                     }
                 }
                 if (index_max.size() > 0) {
@@ -583,6 +562,31 @@ namespace CDLib {
         }
     };
 
+    struct betweenness_sampler {
+        //    Betweenness routines with the sampling parameters bound, so the attacks can take
+        //    them in place of a function. num_samples of 0 computes the exact values. Every call
+        //    samples with seed plus the number of calls before it, so the rounds of a current
+        //    attack draw different sources.
+        id_type num_samples;
+        unsigned long seed;
+        mutable unsigned long calls;
+
+        betweenness_sampler(id_type samples, unsigned long seed_value) : num_samples(samples), seed(seed_value), calls(0) {
+        }
+
+        void operator()(const graph& g, vector<double>& bc) const {
+            betweenness_centralities_sampled(g, bc, num_samples, seed + calls++);
+        }
+
+        pair<string, double> operator()(const graph& g) const {
+            return get_max_betweenness_node(g, num_samples, seed + calls++);
+        }
+
+        pair<string, double> operator()(const graph& g, const node_set_string& elements) const {
+            return get_max_betweenness_node(g, elements, num_samples, seed + calls++);
+        }
+    };
+
     struct node_attack_strategy {
         string graph_name;
         struct stable degree, current_degree, betweenness, current_betweenness;
@@ -590,16 +594,23 @@ namespace CDLib {
         struct stable reduced_degree, reduced_betweenness, reduced_efficiency_score, reduced_random;
         struct stable reduced_current_degree, reduced_current_betweenness, reduced_current_efficiency_score;
 
-        node_attack_strategy() {
+        node_attack_strategy() : betweenness_samples(0), betweenness_seed(0) {
 
             initialized = false;
         }
 
-        node_attack_strategy(graph & g) {
+        node_attack_strategy(graph & g) : betweenness_samples(0), betweenness_seed(0) {
 
             graph_init(g);
         }
 
+        void set_betweenness_sampling(id_type num_samples, unsigned long seed) {
+            //    The betweenness attacks estimate from num_samples seeded sources instead of
+            //    running exact Brandes after every removal. 0 restores the exact values.
+            betweenness_samples = num_samples;
+            betweenness_seed = seed;
+        }
+
         void perform_all_attacks(graph & g) {
 
             degree_attack(g);
@@ -652,6 +663,23 @@ namespace CDLib {
         }
 
         void perform_attack(const graph& g, void (*get_params)(const graph& g, vector<double>& params), struct stable & attack_type) {
+            perform_attack<void (*)(const graph&, vector<double>&)>(g, get_params, attack_type);
+        }
+
+        void perform_attack(const graph& g, void (*get_params)(const graph& g, vector<double>& params), id_type attack_size, struct stable& pre_calc, struct stable & attack_type) {
+            perform_attack<void (*)(const graph&, vector<double>&)>(g, get_params, attack_size, pre_calc, attack_type);
+        }
+
+        void perform_current_attack(const graph& g, pair<string, double> (*get_max_node)(const graph & g), id_type attack_size, struct stable & attack_type) {
+            perform_current_attack<pair<string, double> (*)(const graph&)>(g, get_max_node, attack_size, attack_type);
+        }
+
+        void perform_reduced_current_attack(const graph& g, pair<string, double> (*get_max_node)(const graph & g, const node_set_string & members), id_type attack_size, node_set_string& members, struct stable& pre_calc, struct stable & attack_type) {
+            perform_reduced_current_attack<pair<string, double> (*)(const graph&, const node_set_string&)>(g, get_max_node, attack_size, members, pre_calc, attack_type);
+        }
+
+        template <typename F>
+        void perform_attack(const graph& g, F get_params, struct stable & attack_type) {
             if (!initialized)
                 graph_init(g);
             attack_type.assign(g.get_num_nodes());
@@ -669,7 +697,8 @@ namespace CDLib {
             }
         }
 
-        void perform_attack(const graph& g, void (*get_params)(const graph& g, vector<double>& params), id_type attack_size, struct stable& pre_calc, struct stable & attack_type) {
+        template <typename F>
+        void perform_attack(const graph& g, F get_params, id_type attack_size, struct stable& pre_calc, struct stable & attack_type) {
             if (!initialized)
                 graph_init(g);
             attack_size = (attack_size > g.get_num_nodes()) ? g.get_num_nodes() : attack_size;
@@ -692,7 +721,8 @@ namespace CDLib {
             }
         }
 
-        void perform_current_attack(const graph& g, pair<string, double> (*get_max_node)(const graph & g), id_type attack_size, struct stable & attack_type) {
+        template <typename F>
+        void perform_current_attack(const graph& g, F get_max_node, id_type attack_size, struct stable & attack_type) {
             if (!initialized)
                 graph_init(g);
             attack_type.clear_non_init();
@@ -712,7 +742,8 @@ namespace CDLib {
             }
         }
 
-        void perform_reduced_current_attack(const graph& g, pair<string, double> (*get_max_node)(const graph & g, const node_set_string & members), id_type attack_size, node_set_string& members, struct stable& pre_calc, struct stable & attack_type) {
+        template <typename F>
+        void perform_reduced_current_attack(const graph& g, F get_max_node, id_type attack_size, node_set_string& members, struct stable& pre_calc, struct stable & attack_type) {
             if (!initialized)
                 graph_init(g);
             attack_type.clear_non_init();
@@ -792,19 +823,19 @@ namespace CDLib {
         }
 
         void betweenness_attack(graph & g) {
-            perform_attack(g, betweeness_centralities, betweenness);
+            perform_attack(g, betweenness_sampler(betweenness_samples, betweenness_seed), betweenness);
         }
 
         void reduced_betweenness_attack(graph & g, id_type attack_size) {
-            perform_attack(g, betweeness_centralities, attack_size, betweenness, reduced_betweenness);
+            perform_attack(g, betweenness_sampler(betweenness_samples, betweenness_seed), attack_size, betweenness, reduced_betweenness);
         }
 
         void current_betweenness_attack(const graph & g) {
-            perform_current_attack(g, get_max_betweenness_node, g.get_num_nodes(), current_betweenness);
+            perform_current_attack(g, betweenness_sampler(betweenness_samples, betweenness_seed), g.get_num_nodes(), current_betweenness);
         }
 
         void reduced_current_betweenness_attack(const graph & g, node_set_string & members) {
-            perform_reduced_current_attack(g, get_max_betweenness_node, members.size(), members, current_betweenness, reduced_current_betweenness);
+            perform_reduced_current_attack(g, betweenness_sampler(betweenness_samples, betweenness_seed), members.size(), members, current_betweenness, reduced_current_betweenness);
         }
 
         void efficiency_attack(graph & g) {
@@ -984,6 +1015,8 @@ namespace CDLib {
 
     private:
         bool initialized;
+        id_type betweenness_samples;
+        unsigned long betweenness_seed;
 
     };
 
@@ -9,14 +9,17 @@
 #define	TYPEDEFS_H
 
 #include <algorithm>
+#include <atomic>
 #include <deque>
 #include <cstdlib>
 #include <cassert>
 #include <cstdio>
+#include <cstring>
 #include <cmath>
 #include <ctime>
 #include <stack>
 #include <map>
+#include <memory>
 #include <iterator>
 #include <unordered_set>
 #include <unordered_map>
@@ -29,6 +32,7 @@
 #include <sstream>
 #include <string>
 #include <queue>
+#include <random>
 #include <vector>
 #include <omp.h>
 #include <sys/resource.h>